@@ -0,0 +1,100 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_AUTO_CYCLES_H
+#define DOSBOX_AUTO_CYCLES_H
+
+#include <cstdint>
+#include <optional>
+
+/*
+AutoCycles Class
+~~~~~~~~~~~~~~~~
+Feedback controller behind 'cycles = auto'. It measures how much host time
+one emulated millisecond takes (the usage, 1.0 meaning the emulation just
+keeps up with real time) and adjusts the cycles per millisecond until the
+usage settles just below the requested percentage.
+
+The controller is a PI controller working on the logarithm of the cycles,
+because the usage scales with the cycles: a step that is right for 3000
+cycles is way too small for 300000. The measured usage is smoothed with an
+exponential filter to ride out noisy windows, and the proportional gain is
+chosen so its zero cancels the filter's pole. The closed loop then behaves
+like a first-order system: each window closes a fixed share of the
+remaining error and the cycles approach their final value from one side,
+without overshooting.
+
+Hysteresis keeps the cycles steady once settled: adjusting stops when the
+usage is within the inner band and only resumes when it leaves the outer
+band.
+
+Usage:
+ 1. Collect a Sample over each pass of the run loop, summing the passes until
+    Update() returns new cycles.
+ 2. Call Reset() after anything that makes the measurements meaningless, like
+    pausing the emulation or changing the cycles by hand.
+*/
+
+class AutoCycles {
+public:
+	struct Sample {
+		// Milliseconds of emulated time run in the window
+		int64_t emulated_ms = 0;
+
+		// Host time the window took, and how much of it was spent waiting
+		// or presenting frames rather than emulating
+		int64_t elapsed_us = 0;
+		int64_t idle_us    = 0;
+
+		// Cycles the IO delay skipped instead of executing
+		int64_t io_delay_cycles = 0;
+	};
+
+	struct Settings {
+		// Share of the host time the emulation may use, 1.0 for 100%
+		double target_usage = 1.0;
+
+		int32_t min_cycles = 0;
+		int32_t max_cycles = 0;
+	};
+
+	// Returns the cycles to run at once the window is long enough to
+	// act on, after which the caller starts a new one. Returns nothing
+	// while the window needs more time.
+	std::optional<int32_t> Update(int32_t current_cycles,
+	                              const Settings& settings, const Sample& sample);
+
+	void Reset();
+
+	// The controller's state, for profiling
+	double GetSetpoint() const;
+	double GetMeasuredUsage() const;
+	bool IsAdjusting() const;
+
+private:
+	bool has_measurement = false;
+	bool adjusting       = true;
+
+	double setpoint       = 0.0;
+	double log_usage      = 0.0;
+	double previous_error = 0.0;
+};
+
+#endif
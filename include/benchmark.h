@@ -0,0 +1,67 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_BENCHMARK_H
+#define DOSBOX_BENCHMARK_H
+
+#include <cstdint>
+
+#include "cpu.h"
+
+// Headless benchmark mode
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// Started with '--headless'. Video and audio go to SDL's dummy drivers, the
+// emulated clock runs as fast as the host allows instead of following the
+// host clock, and the session ends once the emulated time or cycle budget is
+// used up. A single JSON line reporting the work done is then written to
+// stdout.
+//
+// DOSBox executes one instruction per cycle, so with a fixed 'cycles'
+// setting the cycle count and the emulated time are the same for every run
+// of the same program, and only the host time varies. Note that cycles burnt
+// in HLT and by the IO delay are counted as well.
+
+struct BenchmarkSettings {
+	// Emulated milliseconds to run for, 0 for no limit
+	int64_t max_emulated_ms = 0;
+
+	// Emulated cycles to run for, 0 for no limit
+	int64_t max_cycles = 0;
+};
+
+void BENCHMARK_Start(const BenchmarkSettings& settings);
+
+bool BENCHMARK_IsActive();
+
+// Called around each run of the CPU core. EndSlice returns true once the
+// cycle budget is used up and the session should end.
+void BENCHMARK_BeginSlice();
+bool BENCHMARK_EndSlice(CPU_Decoder* core);
+
+// Counts one emulated millisecond; returns true once the budget is used up
+// and the session should end.
+bool BENCHMARK_AddTick();
+
+void BENCHMARK_AddFrame(bool changed);
+
+// Writes the JSON report to stdout
+void BENCHMARK_Report();
+
+#endif
@@ -56,6 +56,7 @@ struct CommandLineArguments {
 	bool exit;
 	bool securemode;
 	bool noautoexec;
+	bool headless;
 	std::string working_dir;
 	std::string lang;
 	std::string machine;
@@ -63,6 +64,8 @@ struct CommandLineArguments {
 	std::vector<std::string> set;
 	std::optional<std::vector<std::string>> editconf;
 	std::optional<int> socket;
+	std::optional<int> benchmark_ms;
+	std::optional<int> benchmark_mcycles;
 };
 
 class Config {
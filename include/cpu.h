@@ -80,6 +80,11 @@ constexpr bool CPU_UseRwxMemProtect = true;
 
 Bits CPU_Core_Normal_Run() noexcept;
 Bits CPU_Core_Normal_Trap_Run() noexcept;
+// The normal core dispatching through its switch even in threaded builds, and
+// without the decoded instruction cache, as the reference for both
+Bits CPU_Core_Normal_Switch_Run() noexcept;
+void CPU_Core_Normal_Cache_Init(bool enable_cache);
+void CPU_Core_Normal_Cache_Close();
 Bits CPU_Core_Simple_Run() noexcept;
 Bits CPU_Core_Simple_Trap_Run() noexcept;
 Bits CPU_Core_Full_Run() noexcept;
@@ -90,6 +95,25 @@ Bits CPU_Core_Dynrec_Trap_Run() noexcept;
 Bits CPU_Core_Prefetch_Run() noexcept;
 Bits CPU_Core_Prefetch_Trap_Run() noexcept;
 
+#if (C_DYNAMIC_X86) || (C_DYNREC)
+// Code cache of the dynamic core; the maximum size has to be set before the
+// core is first initialised
+void DYNCACHE_SetMaxSize(int size_mb);
+void DYNCACHE_LogStats();
+#endif
+
+#if C_DYNREC
+// Superblocks the dynrec core formed from hot paths and dissolved again
+struct DynrecTraceStats {
+	int formed    = 0;
+	int dissolved = 0;
+};
+DynrecTraceStats CPU_Core_Dynrec_GetTraceStats();
+
+// Forming superblocks can be turned off to measure what they gain
+void CPU_Core_Dynrec_EnableTracing(bool enabled);
+#endif
+
 void CPU_Reset_AutoAdjust(void);
 
 
@@ -42,6 +42,9 @@ using DMA_ReservationCallback = std::function<void(Section*)>;
 class DmaChannel;
 using DMA_Callback = std::function<void(const DmaChannel* chan, DMAEvent event)>;
 
+// Receives a transfer's data as spans of guest memory, in order
+using DMA_SpanCallback = std::function<void(const uint8_t* data, size_t num_bytes)>;
+
 class DmaChannel {
 public:
 	// Defaults at the time of initialization
@@ -77,6 +80,11 @@ public:
 	size_t Read(size_t words, uint8_t* const dest_buffer);
 	size_t Write(size_t words, uint8_t* const src_buffer);
 
+	// Like Read(), but hands the data to the callback straight from guest
+	// memory instead of copying it into a buffer. The spans are only valid
+	// during the callback.
+	size_t ReadSpans(size_t words, const DMA_SpanCallback& on_span);
+
 	// Reset the channel back to defaults, without callbacks or reservations.
 	void Reset();
 
@@ -92,6 +100,12 @@ private:
 	size_t ReadOrWrite(DMA_DIRECTION direction, size_t words,
 	                   uint8_t* const buffer);
 
+	// Advances the channel by the words, calling the transfer function
+	// for each stretch of consecutive addresses. Auto-initialising
+	// channels start a new stretch each time they wrap around.
+	using transfer_fn = std::function<void(uint32_t address, size_t words)>;
+	size_t Transfer(size_t words, const transfer_fn& transfer);
+
 	DMA_ReservationCallback reservation_callback = {};
 	std::string reservation_owner                = {};
 };
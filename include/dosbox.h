@@ -55,6 +55,9 @@ void DOSBOX_RunMachine();
 void DOSBOX_SetLoop(LoopHandler * handler);
 void DOSBOX_SetNormalLoop();
 
+// Discards the measurements of the 'cycles = auto' controller
+void DOSBOX_ResetAutoCycles();
+
 void DOSBOX_Init(void);
 
 void DOSBOX_SetMachineTypeFromConfig(Section_prop* section);
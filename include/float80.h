@@ -0,0 +1,221 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_FLOAT80_H
+#define DOSBOX_FLOAT80_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// x87 80-bit extended precision values
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The portable FPU keeps its registers as doubles, so 80-bit values are
+// converted when loaded from and stored to memory (FLD/FSTP TBYTE, FSAVE,
+// FRSTOR). The conversions are done on the bit patterns, so they give the
+// same results on every host:
+//
+//  - Loads round the 64-bit significand to 53 bits, to nearest with ties to
+//    even, as an x87 does when it stores to a QWORD. Values beyond the range
+//    of a double become infinities or denormals, instead of wrapping around.
+//  - Denormals, pseudo-denormals and unnormals are normalized.
+//  - Infinities and NaNs keep their sign and, as far as it fits, their
+//    payload.
+//  - Stores are exact, as every double is representable in 80 bits.
+
+struct Float80 {
+	uint64_t mantissa      = 0; // explicit integer bit in bit 63
+	uint16_t sign_exponent = 0;
+};
+
+namespace float80 {
+
+constexpr int bias80 = 16383;
+constexpr int bias64 = 1023;
+
+constexpr uint64_t integer_bit   = uint64_t(1) << 63;
+constexpr uint64_t fraction_mask = (uint64_t(1) << 52) - 1;
+constexpr uint64_t quiet_nan_bit = uint64_t(1) << 51;
+
+// Shifts right, rounding to nearest with ties to even
+constexpr uint64_t round_shift_right(const uint64_t value, const int shift)
+{
+	if (shift <= 0) {
+		return value;
+	}
+	if (shift > 64) {
+		return 0;
+	}
+	const uint64_t kept      = (shift == 64) ? 0 : (value >> shift);
+	const uint64_t remainder = (shift == 64) ? value
+	                                         : (value & ((uint64_t(1) << shift) - 1));
+	const uint64_t half = uint64_t(1) << (shift - 1);
+
+	if (remainder > half || (remainder == half && (kept & 1))) {
+		return kept + 1;
+	}
+	return kept;
+}
+
+inline double bits_to_double(const uint64_t bits)
+{
+	double d = 0.0;
+	std::memcpy(&d, &bits, sizeof(d));
+	return d;
+}
+
+inline uint64_t double_to_bits(const double d)
+{
+	uint64_t bits = 0;
+	std::memcpy(&bits, &d, sizeof(bits));
+	return bits;
+}
+
+} // namespace float80
+
+inline double FLOAT80_ToDouble(const Float80 in)
+{
+	using namespace float80;
+
+	const uint64_t sign = static_cast<uint64_t>(in.sign_exponent >> 15) << 63;
+	const int exponent  = in.sign_exponent & 0x7fff;
+	uint64_t mantissa   = in.mantissa;
+
+	// Fast path for normal values within the range of a double. Rounding
+	// up carries from the fraction into the exponent, and from the largest
+	// exponent into infinity, as the bit patterns of doubles are ordered.
+	const auto biased_exponent = exponent - bias80 + bias64;
+	if ((mantissa & integer_bit) && biased_exponent > 0 && biased_exponent < 0x7ff) {
+		const auto truncated = (static_cast<uint64_t>(biased_exponent) << 52) |
+		                       ((mantissa >> 11) & fraction_mask);
+
+		// Adds one if the dropped bits are above half, or exactly half
+		// with an odd result
+		const auto round_up = ((mantissa & 0x7ff) + 0x3ff + (truncated & 1)) >> 11;
+
+		return bits_to_double(sign | (truncated + round_up));
+	}
+
+	if (exponent == 0x7fff) {
+		// Infinity, or a NaN keeping the upper bits of its payload
+		const auto fraction = (mantissa << 1) >> 12;
+		if ((mantissa << 1) == 0) {
+			return bits_to_double(sign | (uint64_t(0x7ff) << 52));
+		}
+		return bits_to_double(sign | (uint64_t(0x7ff) << 52) |
+		                      (fraction ? fraction : quiet_nan_bit));
+	}
+	if (mantissa == 0) {
+		return bits_to_double(sign);
+	}
+
+	// The exponent of bit 63; denormals share the smallest normal exponent
+	int e = (exponent ? exponent : 1) - bias80;
+
+	// Normal values take no iterations, only denormals and unnormals do
+	while ((mantissa & integer_bit) == 0) {
+		mantissa <<= 1;
+		--e;
+	}
+
+	const auto biased = e + bias64;
+	if (biased >= 0x7ff) {
+		return bits_to_double(sign | (uint64_t(0x7ff) << 52));
+	}
+	if (biased <= 0) {
+		// Denormal result; rounding up to the smallest normal carries
+		// into the exponent field by itself
+		return bits_to_double(sign | round_shift_right(mantissa, 11 + 1 - biased));
+	}
+
+	// Normalized denormal or unnormal, carrying as in the fast path
+	const auto result = (static_cast<uint64_t>(biased - 1) << 52) +
+	                    round_shift_right(mantissa, 11);
+	return bits_to_double(sign | result);
+}
+
+inline Float80 FLOAT80_FromDouble(const double d)
+{
+	using namespace float80;
+
+	const auto bits     = double_to_bits(d);
+	const auto sign     = static_cast<uint16_t>((bits >> 63) << 15);
+	const auto exponent = static_cast<int>((bits >> 52) & 0x7ff);
+	const auto fraction = bits & fraction_mask;
+
+	Float80 out = {};
+	if (exponent == 0x7ff) {
+		out.mantissa      = integer_bit | (fraction << 11);
+		out.sign_exponent = sign | 0x7fff;
+	} else if (exponent == 0) {
+		out.sign_exponent = sign;
+		if (fraction) {
+			// Double denormals are normal numbers in 80 bits
+			auto mantissa = fraction << 11;
+			int e         = 1 - bias64;
+			while ((mantissa & integer_bit) == 0) {
+				mantissa <<= 1;
+				--e;
+			}
+			out.mantissa = mantissa;
+			out.sign_exponent |= static_cast<uint16_t>(e + bias80);
+		}
+	} else {
+		out.mantissa      = integer_bit | (fraction << 11);
+		out.sign_exponent = sign |
+		                    static_cast<uint16_t>(exponent - bias64 + bias80);
+	}
+	return out;
+}
+
+// Rounds the significand to the given number of bits, as the x87 precision
+// control does with arithmetic results (24 bits in single and 53 in double
+// precision). Unlike converting to float, the exponent keeps its full
+// range. The rounding follows the control word's RC field: to nearest
+// even, down, up, or towards zero.
+inline double FLOAT80_RoundSignificand(const double value, const int bits,
+                                       const uint8_t rounding)
+{
+	if (bits >= 53 || value == 0.0 || !std::isfinite(value)) {
+		return value;
+	}
+	int exponent = 0;
+	const auto significand = std::ldexp(std::frexp(value, &exponent), bits);
+
+	auto rounded = std::floor(significand);
+	switch (rounding) {
+	case 0: {
+		// The remainder is exact, so ties are found without depending
+		// on the host's rounding mode
+		const auto remainder = significand - rounded;
+		if (remainder > 0.5 ||
+		    (remainder == 0.5 && std::fmod(rounded, 2.0) != 0.0)) {
+			rounded += 1.0;
+		}
+		break;
+	}
+	case 1: break;
+	case 2: rounded = std::ceil(significand); break;
+	default: rounded = std::trunc(significand); break;
+	}
+	return std::ldexp(rounded, exponent - bits);
+}
+
+#endif
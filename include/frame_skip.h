@@ -0,0 +1,169 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_FRAME_SKIP_H
+#define DOSBOX_FRAME_SKIP_H
+
+/*  Frame Skip
+ *  ----------
+ *  When the host can't present every DOS frame, the throttled presenter
+ *  drops the frames that end within one presentation period of the last
+ *  presented one. The renderer asks when a DOS frame starts whether it
+ *  will be presented, and skips drawing it if not.
+ *
+ *  The host time the recent DOS frames took predicts when the new one
+ *  ends, and the throttle's last presentation tells how far that is into
+ *  the presentation period. A frame wrongly skipped delays its changes until the next drawn
+ *  frame, so the verifier runs a second presenter on the frames the
+ *  prediction keeps and compares what the two present.
+ */
+
+#include <cassert>
+#include <cstdint>
+
+// Presents the new frames no sooner than one period after the last
+// presented frame. A throttled new frame is presented at the next chance.
+class FrameThrottle {
+public:
+	// Whether to present the frame finished at now_us
+	bool Present(const int64_t now_us, const int period_us, const bool frame_is_new)
+	{
+		assert(period_us > 0);
+
+		const auto elapsed = now_us - last_present_us;
+		if (elapsed < period_us) {
+			was_new_and_throttled = frame_is_new;
+			return false;
+		}
+		// If we waited beyond this frame's refresh period, then credit
+		// this extra wait back by deducting it from the recorded time.
+		const auto wait_overage = elapsed % period_us;
+		last_present_us = now_us - (9 * wait_overage / 10);
+
+		return frame_is_new || was_new_and_throttled;
+	}
+
+	int64_t last_present_us = 0;
+
+private:
+	bool was_new_and_throttled = false;
+};
+
+// Predicts whether a frame ends too soon after the last presented frame to
+// be presented. The frame is expected to take the average of the recent
+// frames' durations, and the margin follows how far the frames stray from
+// that average. Steady frames can end just short of the period and still be
+// skipped, while jittery ones are only skipped well within it.
+class FrameSkipPredictor {
+public:
+	// Whether the frame starting at now_us is predicted to be dropped
+	bool IsSkipPredicted(const int64_t now_us, const int64_t last_present_us,
+	                     const int period_us) const
+	{
+		if (frames_timed < min_frames_timed) {
+			return false;
+		}
+		const auto predicted_end = now_us + average_us + MarginUs();
+		return predicted_end - last_present_us < period_us;
+	}
+
+	// Times the frame that took frame_us to run
+	void FrameEnded(const int64_t frame_us)
+	{
+		assert(frame_us >= 0);
+
+		if (frames_timed == 0) {
+			// Start with the quarter-frame margin until the
+			// frames' jitter is known
+			average_us   = frame_us;
+			deviation_us = frame_us / 4;
+		} else {
+			const auto error_us = frame_us - average_us;
+			average_us += error_us / smoothing;
+			deviation_us += ((error_us < 0 ? -error_us : error_us) -
+			                 deviation_us) /
+			                smoothing;
+		}
+		if (frames_timed < min_frames_timed) {
+			++frames_timed;
+		}
+	}
+
+	int64_t MarginUs() const
+	{
+		// A floor for the host timer's resolution
+		return 2 * deviation_us + average_us / 64;
+	}
+
+private:
+	static constexpr int64_t smoothing     = 8; // frames averaged over
+	static constexpr int min_frames_timed = 2;
+
+	int64_t average_us   = 0;
+	int64_t deviation_us = 0;
+	int frames_timed     = 0;
+};
+
+// Presents the frames the prediction keeps as the skipping would, so that
+// a presenter drawing every frame can be checked against it
+class FrameSkipVerifier {
+public:
+	// Whether skipping the predicted frames would have changed the
+	// presentation of the frame finished at now_us
+	bool Check(const int64_t now_us, const int period_us,
+	           const bool frame_is_new, const bool skip_predicted,
+	           const bool presented)
+	{
+		++frames;
+
+		// A skipped frame's changes are carried by the next drawn one
+		auto skip_path_presented = false;
+		if (skip_predicted) {
+			++skips;
+			skipped_new = skipped_new || frame_is_new;
+		} else {
+			skip_path_presented = throttle.Present(now_us,
+			                                       period_us,
+			                                       frame_is_new || skipped_new);
+			skipped_new = false;
+		}
+		if (skip_path_presented == presented) {
+			return false;
+		}
+		++mismatches;
+		return true;
+	}
+
+	// The skipping's last presentation, to predict the skips from
+	int64_t LastPresentUs() const
+	{
+		return throttle.last_present_us;
+	}
+
+	int frames     = 0;
+	int skips      = 0;
+	int mismatches = 0;
+
+private:
+	FrameThrottle throttle = {};
+	bool skipped_new       = false;
+};
+
+#endif
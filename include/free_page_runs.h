@@ -0,0 +1,169 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_FREE_PAGE_RUNS_H
+#define DOSBOX_FREE_PAGE_RUNS_H
+
+/*  Free Page Runs
+ *  --------------
+ *  Tracks the free pages of a range as maximal runs of consecutive pages,
+ *  indexed both by their first page and by their length. This answers the
+ *  questions the XMS and EMS page allocator asks without scanning the pages:
+ *
+ *    - FindBestFit():    O(log n), the smallest run that fits, and the
+ *                        lowest one among equally small runs
+ *    - GetFreeTotal():   O(1)
+ *    - GetFreeLargest(): O(1)
+ *
+ *  Allocate() and Release() take a stretch of consecutive pages and are
+ *  O(log n); released stretches are merged with their free neighbours so the
+ *  runs always stay maximal.
+ *
+ *  Page 0 is never part of the range, so it doubles as "no run found".
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <set>
+#include <utility>
+
+class FreePageRuns {
+public:
+	// Frees every page in [first_page, end_page)
+	void Reset(const size_t first_page, const size_t end_page)
+	{
+		assert(first_page > 0 && first_page <= end_page);
+		by_start.clear();
+		by_length.clear();
+		free_total = 0;
+		if (end_page > first_page) {
+			Insert(first_page, end_page - first_page);
+		}
+	}
+
+	// The first page of the smallest free run with at least num_pages
+	// pages, or 0 if there's none
+	size_t FindBestFit(const size_t num_pages) const
+	{
+		const auto it = by_length.lower_bound({num_pages, 0});
+		return it == by_length.end() ? 0 : it->second;
+	}
+
+	// The number of free pages in the run starting at the given page, or 0
+	// if no free run starts there
+	size_t GetRunLength(const size_t page) const
+	{
+		const auto it = by_start.find(page);
+		return it == by_start.end() ? 0 : it->second;
+	}
+
+	// Whether every page in [page, page + num_pages) is free
+	bool IsFree(const size_t page, const size_t num_pages) const
+	{
+		auto it = by_start.upper_bound(page);
+		if (it == by_start.begin()) {
+			return false;
+		}
+		--it;
+		return page + num_pages <= it->first + it->second;
+	}
+
+	size_t GetFreeTotal() const
+	{
+		return free_total;
+	}
+
+	size_t GetFreeLargest() const
+	{
+		return by_length.empty() ? 0 : by_length.rbegin()->first;
+	}
+
+	// Marks the stretch as used; it must lie within a single free run
+	void Allocate(const size_t page, const size_t num_pages)
+	{
+		assert(num_pages > 0);
+		auto it = by_start.upper_bound(page);
+		assert(it != by_start.begin());
+		--it;
+
+		const auto run_start  = it->first;
+		const auto run_length = it->second;
+		assert(page + num_pages <= run_start + run_length);
+		Erase(it);
+
+		if (page > run_start) {
+			Insert(run_start, page - run_start);
+		}
+		const auto run_end = run_start + run_length;
+		if (page + num_pages < run_end) {
+			Insert(page + num_pages, run_end - (page + num_pages));
+		}
+	}
+
+	// Marks the stretch as free; none of it may be free already
+	void Release(size_t page, size_t num_pages)
+	{
+		assert(num_pages > 0);
+		const auto next = by_start.find(page + num_pages);
+		if (next != by_start.end()) {
+			num_pages += next->second;
+			Erase(next);
+		}
+		const auto after = by_start.lower_bound(page);
+		assert(after == by_start.end() || after->first >= page + num_pages);
+		if (after != by_start.begin()) {
+			const auto prev = std::prev(after);
+			assert(prev->first + prev->second <= page);
+			if (prev->first + prev->second == page) {
+				page = prev->first;
+				num_pages += prev->second;
+				Erase(prev);
+			}
+		}
+		Insert(page, num_pages);
+	}
+
+private:
+	using starts_t = std::map<size_t, size_t>;
+
+	void Insert(const size_t page, const size_t num_pages)
+	{
+		by_start.emplace(page, num_pages);
+		by_length.emplace(num_pages, page);
+		free_total += num_pages;
+	}
+
+	void Erase(const starts_t::const_iterator it)
+	{
+		by_length.erase({it->second, it->first});
+		free_total -= it->second;
+		by_start.erase(it);
+	}
+
+	// First page -> length, and (length, first page)
+	starts_t by_start = {};
+	std::set<std::pair<size_t, size_t>> by_length = {};
+
+	size_t free_total = 0;
+};
+
+#endif
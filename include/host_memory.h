@@ -0,0 +1,106 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_HOST_MEMORY_H
+#define DOSBOX_HOST_MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+enum class HugePages { Off, Transparent, Explicit };
+
+/*
+HostMemory Class
+~~~~~~~~~~~~~~~~
+HostMemory maps a block of zeroed memory directly from the operating system,
+for the emulated RAM. The block is reserved up front but only committed as
+it is touched, so a machine with a large 'memsize' costs only the memory the
+guest actually uses.
+
+The block can optionally be backed by huge pages, to reduce TLB misses when
+the guest's working set is large:
+
+  - Transparent: the block is aligned to 2 MB and the kernel is advised to
+    back it with transparent huge pages (Linux only). Pages are still
+    committed on first touch, but 2 MB at a time.
+
+  - Explicit: the block is mapped from the preallocated huge page pool (Linux
+    hugetlbfs, or Windows large pages with the "Lock pages in memory"
+    privilege). This commits the whole block up front.
+
+When the requested mode is not available, the block falls back to the next
+mode down and GetHugePages() reports what was obtained.
+
+Usage:
+ 1. Construct with the size in bytes and the huge page preference. For
+    example: HostMemory ram(64 * 1024 * 1024, HugePages::Off);
+ 2. Access the memory through Data(). It stays at the same address for the
+    lifetime of the object and is unmapped when the object is destroyed.
+ 3. GetResidentBytes() reports how much of the block is backed by physical
+    memory, where the host can tell.
+*/
+
+class HostMemory {
+public:
+	HostMemory() = default;
+	HostMemory(size_t num_bytes, HugePages huge_pages);
+	~HostMemory();
+
+	// Move-only
+	HostMemory(const HostMemory&)            = delete;
+	HostMemory& operator=(const HostMemory&) = delete;
+	HostMemory(HostMemory&& other) noexcept;
+	HostMemory& operator=(HostMemory&& other) noexcept;
+
+	uint8_t* Data() const
+	{
+		return data;
+	}
+
+	size_t Size() const
+	{
+		return size;
+	}
+
+	HugePages GetHugePages() const
+	{
+		return huge_pages;
+	}
+
+	std::optional<size_t> GetResidentBytes() const;
+
+private:
+	void Map(HugePages requested);
+	void Unmap();
+
+	uint8_t* data = nullptr;
+	size_t size   = 0;
+
+	// The mapping itself, which can be larger than the block when aligned
+	void* mapping       = nullptr;
+	size_t mapping_size = 0;
+
+	HugePages huge_pages = HugePages::Off;
+};
+
+const char* to_string(const HugePages huge_pages);
+
+#endif
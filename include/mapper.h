@@ -82,4 +82,7 @@ void MAPPER_AutoType(std::vector<std::string> &sequence,
                      const uint32_t pacing_ms);
 void MAPPER_CheckEvent(SDL_Event *event);
 
+// Takes the next event from the events polled by the SDL thread
+bool GFX_PollEvent(SDL_Event* event);
+
 #endif
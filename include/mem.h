@@ -24,6 +24,8 @@
 
 #include "dosbox.h"
 
+#include <optional>
+
 #include "mem_host.h"
 #include "mem_unaligned.h"
 #include "types.h"
@@ -41,6 +43,9 @@ HostPt GetMemBase();
 uint16_t MEM_GetMinMegabytes();
 uint16_t MEM_GetMaxMegabytes();
 
+// Host memory backing the guest's RAM, if the host can tell
+std::optional<size_t> MEM_GetResidentBytes();
+
 bool MEM_A20_Enabled();
 void MEM_A20_Enable(bool enable);
 
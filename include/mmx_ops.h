@@ -0,0 +1,148 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_MMX_OPS_H
+#define DOSBOX_MMX_OPS_H
+
+#include <cstdint>
+
+// Needed for std::isnan in simde
+#include <cmath>
+
+#include "simde/x86/mmx.h"
+
+// Packed MMX operations
+// ~~~~~~~~~~~~~~~~~~~~~
+// The interpreter cores and the dynrec core evaluate the packed MMX
+// instructions with these functions. They take the 64-bit destination and
+// source operands and return the result. simde maps them onto SSE2 on x86
+// hosts and onto NEON on ARM hosts, where each is a handful of instructions
+// with the operands passed in general purpose registers.
+//
+// The shifts take the count from a register or an immediate. Logical
+// shifts by the lane width or more clear the lanes and arithmetic shifts
+// fill them with their sign bits. simde only gets the x86 results for such
+// counts from the native x86 instructions: its NEON and portable code
+// truncate the count or shift past the lane width, so out-of-range counts
+// are settled here before simde sees them.
+//
+// The boolean operations and the quadword shifts work on a single 64-bit
+// lane and are plain integer operations.
+
+namespace mmx_ops {
+
+inline simde__m64 to_m64(const uint64_t value)
+{
+	return simde_m_from_int64(static_cast<int64_t>(value));
+}
+
+inline uint64_t from_m64(const simde__m64 value)
+{
+	return static_cast<uint64_t>(simde_m_to_int64(value));
+}
+
+} // namespace mmx_ops
+
+#define MMX_BINARY_OP(NAME, SIMDE_FUNC) \
+	inline uint64_t NAME(const uint64_t dest, const uint64_t src) \
+	{ \
+		return mmx_ops::from_m64( \
+		        SIMDE_FUNC(mmx_ops::to_m64(dest), mmx_ops::to_m64(src))); \
+	}
+
+#define MMX_LOGICAL_SHIFT_OP(NAME, SIMDE_FUNC, LANE_BITS) \
+	inline uint64_t NAME(const uint64_t dest, const uint64_t count) \
+	{ \
+		if (count >= LANE_BITS) { \
+			return 0; \
+		} \
+		return mmx_ops::from_m64(SIMDE_FUNC(mmx_ops::to_m64(dest), \
+		                                    static_cast<int>(count))); \
+	}
+
+#define MMX_ARITHMETIC_SHIFT_OP(NAME, SIMDE_FUNC, LANE_BITS) \
+	inline uint64_t NAME(const uint64_t dest, const uint64_t count) \
+	{ \
+		const auto shift = count >= LANE_BITS ? LANE_BITS - 1 \
+		                                      : static_cast<int>(count); \
+		return mmx_ops::from_m64(SIMDE_FUNC(mmx_ops::to_m64(dest), shift)); \
+	}
+
+// Shifts
+MMX_LOGICAL_SHIFT_OP(MMX_PSLLW, simde_m_psllwi, 16)
+MMX_LOGICAL_SHIFT_OP(MMX_PSRLW, simde_m_psrlwi, 16)
+MMX_ARITHMETIC_SHIFT_OP(MMX_PSRAW, simde_m_psrawi, 16)
+MMX_LOGICAL_SHIFT_OP(MMX_PSLLD, simde_m_pslldi, 32)
+MMX_LOGICAL_SHIFT_OP(MMX_PSRLD, simde_m_psrldi, 32)
+MMX_ARITHMETIC_SHIFT_OP(MMX_PSRAD, simde_m_psradi, 32)
+
+inline uint64_t MMX_PSLLQ(const uint64_t dest, const uint64_t count)
+{
+	return count > 63 ? 0 : dest << count;
+}
+
+inline uint64_t MMX_PSRLQ(const uint64_t dest, const uint64_t count)
+{
+	return count > 63 ? 0 : dest >> count;
+}
+
+// Math
+MMX_BINARY_OP(MMX_PADDB, simde_m_paddb)
+MMX_BINARY_OP(MMX_PADDW, simde_m_paddw)
+MMX_BINARY_OP(MMX_PADDD, simde_m_paddd)
+MMX_BINARY_OP(MMX_PADDSB, simde_m_paddsb)
+MMX_BINARY_OP(MMX_PADDSW, simde_m_paddsw)
+MMX_BINARY_OP(MMX_PADDUSB, simde_m_paddusb)
+MMX_BINARY_OP(MMX_PADDUSW, simde_m_paddusw)
+MMX_BINARY_OP(MMX_PSUBB, simde_m_psubb)
+MMX_BINARY_OP(MMX_PSUBW, simde_m_psubw)
+MMX_BINARY_OP(MMX_PSUBD, simde_m_psubd)
+MMX_BINARY_OP(MMX_PSUBSB, simde_m_psubsb)
+MMX_BINARY_OP(MMX_PSUBSW, simde_m_psubsw)
+MMX_BINARY_OP(MMX_PSUBUSB, simde_m_psubusb)
+MMX_BINARY_OP(MMX_PSUBUSW, simde_m_psubusw)
+MMX_BINARY_OP(MMX_PMULHW, simde_m_pmulhw)
+MMX_BINARY_OP(MMX_PMULLW, simde_m_pmullw)
+MMX_BINARY_OP(MMX_PMADDWD, simde_m_pmaddwd)
+
+// Comparison
+MMX_BINARY_OP(MMX_PCMPEQB, simde_m_pcmpeqb)
+MMX_BINARY_OP(MMX_PCMPEQW, simde_m_pcmpeqw)
+MMX_BINARY_OP(MMX_PCMPEQD, simde_m_pcmpeqd)
+MMX_BINARY_OP(MMX_PCMPGTB, simde_m_pcmpgtb)
+MMX_BINARY_OP(MMX_PCMPGTW, simde_m_pcmpgtw)
+MMX_BINARY_OP(MMX_PCMPGTD, simde_m_pcmpgtd)
+
+// Data Reordering
+MMX_BINARY_OP(MMX_PACKSSWB, simde_m_packsswb)
+MMX_BINARY_OP(MMX_PACKSSDW, simde_m_packssdw)
+MMX_BINARY_OP(MMX_PACKUSWB, simde_m_packuswb)
+MMX_BINARY_OP(MMX_PUNPCKHBW, simde_m_punpckhbw)
+MMX_BINARY_OP(MMX_PUNPCKHWD, simde_m_punpckhwd)
+MMX_BINARY_OP(MMX_PUNPCKHDQ, simde_m_punpckhdq)
+MMX_BINARY_OP(MMX_PUNPCKLBW, simde_m_punpcklbw)
+MMX_BINARY_OP(MMX_PUNPCKLWD, simde_m_punpcklwd)
+MMX_BINARY_OP(MMX_PUNPCKLDQ, simde_m_punpckldq)
+
+#undef MMX_BINARY_OP
+#undef MMX_LOGICAL_SHIFT_OP
+#undef MMX_ARITHMETIC_SHIFT_OP
+
+#endif
@@ -50,6 +50,7 @@ class PageDirectory;
 #define PFLAG_NOCODE		0x10			//No dynamic code can be generated here
 #define PFLAG_INIT			0x20			//No dynamic code can be generated here
 #define PFLAG_HASCODE16		0x40			//Page contains 16-bit dynamic code
+#define PFLAG_BLOCKWRITE	0x80			//Handler has its own writeblock
 #define PFLAG_HASCODE		(PFLAG_HASCODE32|PFLAG_HASCODE16)
 
 #define LINK_START	((1024+64)/4)			//Start right after the HMA
@@ -69,6 +70,15 @@ public:
 	virtual void writew(PhysPt addr, uint16_t val);
 	virtual void writed(PhysPt addr, uint32_t val);
 	virtual void writeq(PhysPt addr, uint64_t val);
+
+	// Writes num_values values of the given width (1, 2, or 4 bytes),
+	// packed little-endian in data, to consecutive addresses within the
+	// page. It has the effect of as many writeb, writew, or writed calls;
+	// handlers that can do it in one go override it and set
+	// PFLAG_BLOCKWRITE.
+	virtual void writeblock(PhysPt addr, const uint8_t* data,
+	                        size_t num_values, size_t width);
+
 	virtual HostPt GetHostReadPt(Bitu phys_page);
 	virtual HostPt GetHostWritePt(Bitu phys_page);
 	virtual bool readb_checked(PhysPt addr,uint8_t * val);
@@ -91,6 +101,7 @@ Bitu PAGING_GetDirBase();
 void PAGING_SetDirBase(Bitu cr3);
 void PAGING_InitTLB();
 void PAGING_ClearTLB();
+void PAGING_LogStats();
 
 void PAGING_LinkPage(uint32_t lin_page,uint32_t phys_page);
 void PAGING_LinkPage_ReadOnly(uint32_t lin_page,uint32_t phys_page);
@@ -81,7 +81,6 @@ struct RenderPal_t {
 
 struct Render_t {
 	ImageInfo src = {};
-	uint32_t src_start   = 0;
 
 	// Frames per second
 	double fps = 0;
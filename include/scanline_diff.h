@@ -0,0 +1,183 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_SCANLINE_DIFF_H
+#define DOSBOX_SCANLINE_DIFF_H
+
+/*  Scanline Diff
+ *  -------------
+ *  The renderer keeps a copy of every source scanline it has scaled and
+ *  only scales the lines, and the parts of lines, that differ from it.
+ *  These functions find those differences in 16-byte chunks, four at a time
+ *  while the lines match: with SSE2 on x86 hosts, with NEON on 64-bit ARM
+ *  hosts, and with pairs of 64-bit integers elsewhere. Only the chunk holding
+ *  a difference is searched byte by byte.
+ *
+ *  The lines are plain bytes without any alignment requirements; the
+ *  caller converts the byte offsets to pixels.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP == 2)
+#define SCANLINE_DIFF_SSE2 1
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#define SCANLINE_DIFF_NEON 1
+#include <arm_neon.h>
+#endif
+
+// The bytes [first, last) of a line that differ from its cached copy. The
+// span is empty if the line is unchanged.
+struct ScanlineSpan {
+	size_t first = 0;
+	size_t last  = 0;
+
+	bool IsEmpty() const
+	{
+		return first == last;
+	}
+};
+
+constexpr size_t scanline_chunk_bytes = 16;
+
+inline bool scanline_chunks_equal(const uint8_t* a, const uint8_t* b)
+{
+#if defined(SCANLINE_DIFF_SSE2)
+	const auto va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+	const auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) == 0xffff;
+#elif defined(SCANLINE_DIFF_NEON)
+	return vminvq_u8(vceqq_u8(vld1q_u8(a), vld1q_u8(b))) == 0xff;
+#else
+	uint64_t a_lo, a_hi, b_lo, b_hi;
+	memcpy(&a_lo, a, sizeof(a_lo));
+	memcpy(&a_hi, a + sizeof(a_lo), sizeof(a_hi));
+	memcpy(&b_lo, b, sizeof(b_lo));
+	memcpy(&b_hi, b + sizeof(b_lo), sizeof(b_hi));
+	return ((a_lo ^ b_lo) | (a_hi ^ b_hi)) == 0;
+#endif
+}
+
+// Compares four chunks at once, as unchanged lines are the common case
+inline bool scanline_blocks_equal(const uint8_t* a, const uint8_t* b)
+{
+#if defined(SCANLINE_DIFF_SSE2)
+	auto load = [](const uint8_t* p) {
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	};
+	const auto eq_01 = _mm_and_si128(_mm_cmpeq_epi8(load(a), load(b)),
+	                                 _mm_cmpeq_epi8(load(a + 16), load(b + 16)));
+	const auto eq_23 = _mm_and_si128(_mm_cmpeq_epi8(load(a + 32), load(b + 32)),
+	                                 _mm_cmpeq_epi8(load(a + 48), load(b + 48)));
+	return _mm_movemask_epi8(_mm_and_si128(eq_01, eq_23)) == 0xffff;
+#elif defined(SCANLINE_DIFF_NEON)
+	const auto eq_01 = vandq_u8(vceqq_u8(vld1q_u8(a), vld1q_u8(b)),
+	                            vceqq_u8(vld1q_u8(a + 16), vld1q_u8(b + 16)));
+	const auto eq_23 = vandq_u8(vceqq_u8(vld1q_u8(a + 32), vld1q_u8(b + 32)),
+	                            vceqq_u8(vld1q_u8(a + 48), vld1q_u8(b + 48)));
+	return vminvq_u8(vandq_u8(eq_01, eq_23)) == 0xff;
+#else
+	return scanline_chunks_equal(a, b) && scanline_chunks_equal(a + 16, b + 16) &&
+	       scanline_chunks_equal(a + 32, b + 32) &&
+	       scanline_chunks_equal(a + 48, b + 48);
+#endif
+}
+
+constexpr size_t scanline_block_bytes = 4 * scanline_chunk_bytes;
+
+// The offset of the first byte that differs, or num_bytes if none does
+inline size_t find_first_change(const uint8_t* line, const uint8_t* cache,
+                                const size_t num_bytes)
+{
+	size_t i = 0;
+	while (i + scanline_block_bytes <= num_bytes &&
+	       scanline_blocks_equal(line + i, cache + i)) {
+		i += scanline_block_bytes;
+	}
+	while (i + scanline_chunk_bytes <= num_bytes &&
+	       scanline_chunks_equal(line + i, cache + i)) {
+		i += scanline_chunk_bytes;
+	}
+	while (i < num_bytes && line[i] == cache[i]) {
+		++i;
+	}
+	return i;
+}
+
+// The offset just past the last byte that differs, or 0 if none does
+inline size_t find_last_change(const uint8_t* line, const uint8_t* cache,
+                               const size_t num_bytes)
+{
+	auto end = num_bytes;
+	while (end >= scanline_block_bytes &&
+	       scanline_blocks_equal(line + end - scanline_block_bytes,
+	                             cache + end - scanline_block_bytes)) {
+		end -= scanline_block_bytes;
+	}
+	while (end >= scanline_chunk_bytes &&
+	       scanline_chunks_equal(line + end - scanline_chunk_bytes,
+	                             cache + end - scanline_chunk_bytes)) {
+		end -= scanline_chunk_bytes;
+	}
+	while (end > 0 && line[end - 1] == cache[end - 1]) {
+		--end;
+	}
+	return end;
+}
+
+inline ScanlineSpan find_changed_span(const uint8_t* line, const uint8_t* cache,
+                                      const size_t num_bytes)
+{
+	const auto first = find_first_change(line, cache, num_bytes);
+	if (first == num_bytes) {
+		return {num_bytes, num_bytes};
+	}
+	const auto last = first + find_last_change(line + first,
+	                                           cache + first,
+	                                           num_bytes - first);
+	return {first, last};
+}
+
+// Fills the cache with the inverted line, so every byte of the line will
+// compare as changed
+inline void copy_inverted(uint8_t* cache, const uint8_t* line, const size_t num_bytes)
+{
+	size_t i = 0;
+#if defined(SCANLINE_DIFF_SSE2)
+	const auto ones = _mm_set1_epi8(-1);
+	for (; i + scanline_chunk_bytes <= num_bytes; i += scanline_chunk_bytes) {
+		const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(cache + i),
+		                 _mm_xor_si128(v, ones));
+	}
+#elif defined(SCANLINE_DIFF_NEON)
+	for (; i + scanline_chunk_bytes <= num_bytes; i += scanline_chunk_bytes) {
+		vst1q_u8(cache + i, vmvnq_u8(vld1q_u8(line + i)));
+	}
+#endif
+	for (; i < num_bytes; ++i) {
+		cache[i] = static_cast<uint8_t>(~line[i]);
+	}
+}
+
+#endif
@@ -33,9 +33,11 @@
 #endif
 
 #include "fraction.h"
+#include "frame_skip.h"
 #include "rect.h"
 #include "render.h"
 #include "shader_manager.h"
+#include "thread_handoff.h"
 #include "video.h"
 
 // The image rendered in the emulated computer's raw framebuffer as raw pixels
@@ -103,10 +105,11 @@
 #define SDL_NOFRAME 0x00000020
 
 // Texture buffer and presentation functions and type-defines
-using update_frame_buffer_f = void(const uint16_t*);
+using update_frame_buffer_f = void(const uint16_t*, const ChangedColumns*);
 using present_frame_f       = bool();
 
-constexpr void update_frame_noop([[maybe_unused]] const uint16_t*)
+constexpr void update_frame_noop([[maybe_unused]] const uint16_t*,
+                                 [[maybe_unused]] const ChangedColumns*)
 {
 	// no-op
 }
@@ -129,6 +132,16 @@ enum class FrameMode {
 	ThrottledVfr,
 };
 
+// Whether to draw the DOS frames the throttled presenter would drop
+enum class FrameSkipping {
+	Off,
+	On,
+
+	// Draw every frame, and log the frames whose presentation the
+	// skipping would have changed
+	Verify,
+};
+
 enum class HostRateMode {
 	Auto,
 
@@ -324,10 +337,29 @@ struct SDL_Block {
 		int period_us       = 0;
 		int period_us_early = 0;
 		int period_us_late  = 0;
+
+		FrameSkipping skipping = FrameSkipping::Off;
+
+		FrameThrottle throttle            = {};
+		FrameSkipPredictor skip_predictor = {};
+		FrameSkipVerifier skip_check      = {};
+
+		// Host time of the start of the current DOS frame, in us
+		int64_t start_us = 0;
+
+		bool skip_predicted = false;
+
+		// Makes the texture backend upload the whole frame even without
+		// a drawn DOS frame, so the presentation benchmark includes it
+		bool force_full_upload = false;
 	} frame = {};
 
 	bool use_exact_window_resolution = false;
 
+	// Polled events wait here for their handlers, so that the handlers
+	// can later move to the emulation thread
+	SpscQueue<SDL_Event, 256> input_events = {};
+
 #if defined(WIN32)
 	// Time when sdl regains focus (Alt+Tab) in windowed mode
 	int64_t focus_ticks = 0;
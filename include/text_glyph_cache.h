@@ -0,0 +1,119 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_TEXT_GLYPH_CACHE_H
+#define DOSBOX_TEXT_GLYPH_CACHE_H
+
+/*  Text Glyph Cache
+ *  ----------------
+ *  Text mode lines are drawn one character cell at a time: the cell's font
+ *  row picks the foreground or background colour of each of its 8 or 9
+ *  pixels. A text screen only shows a few hundred distinct combinations of
+ *  font row and colours, so the cache keeps each combination's pixels
+ *  and the line drawing copies them.
+ *
+ *  The rows are keyed by the font row's bit pattern rather than by the
+ *  character code and scanline, so writes to the font or switches between
+ *  fonts never leave stale rows behind. The colours are keyed by their
+ *  palette indexes, and the cache flushes itself when any of the 16 text
+ *  colours change.
+ */
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class TextGlyphCache {
+public:
+	static constexpr size_t num_colours     = 16;
+	static constexpr size_t max_glyph_width = 9;
+
+	using Colours = std::array<uint32_t, num_colours>;
+
+	// Flushes the cached rows if any of the colours changed
+	void SetColours(const Colours& colours)
+	{
+		if (colours != colours_) {
+			colours_ = colours;
+			Flush();
+		}
+	}
+
+	// The pixels of a font row that is 8 or 9 pixels wide, leftmost pixel
+	// in the highest bit. Valid until the next call.
+	const uint32_t* GetRow(const uint16_t pattern, const uint8_t width,
+	                       const uint8_t fg_index, const uint8_t bg_index)
+	{
+		assert(width == 8 || width == 9);
+		assert(pattern < (1 << width));
+		assert(fg_index < num_colours && bg_index < num_colours);
+
+		const uint32_t key = pattern | ((width - 8u) << 9) |
+		                     (static_cast<uint32_t>(fg_index) << 10) |
+		                     (static_cast<uint32_t>(bg_index) << 14);
+
+		auto& entry = entries[(key * 0x9e3779b1u) >> (32 - index_bits)];
+		if (entry.key == key) {
+			++hits;
+			return entry.pixels.data();
+		}
+		++misses;
+		entry.key = key;
+
+		const auto fg = colours_[fg_index];
+		const auto bg = colours_[bg_index];
+		for (uint8_t n = 0; n < width; ++n) {
+			const auto is_set = (pattern >> (width - 1 - n)) & 1;
+			entry.pixels[n] = is_set ? fg : bg;
+		}
+		return entry.pixels.data();
+	}
+
+	uint64_t hits    = 0;
+	uint64_t misses  = 0;
+	uint64_t flushes = 0;
+
+private:
+	void Flush()
+	{
+		for (auto& entry : entries) {
+			entry.key = invalid_key;
+		}
+		++flushes;
+	}
+
+	// 4096 rows cover a screen of 256 glyphs in several colours
+	static constexpr int index_bits = 12;
+
+	// Keys use 18 bits, so this never matches one
+	static constexpr uint32_t invalid_key = UINT32_MAX;
+
+	struct Entry {
+		uint32_t key = invalid_key;
+		std::array<uint32_t, max_glyph_width> pixels = {};
+	};
+	std::array<Entry, 1 << index_bits> entries = {};
+
+	Colours colours_ = {};
+};
+
+#endif
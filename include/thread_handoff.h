@@ -0,0 +1,149 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_THREAD_HANDOFF_H
+#define DOSBOX_THREAD_HANDOFF_H
+
+/*  Thread Hand-off
+ *  ---------------
+ *  Lock-free hand-offs between one producer and one consumer thread, for
+ *  the emulation loop and the SDL thread that presents its frames and
+ *  polls its input. Neither side ever waits for the other:
+ *
+ *  - The triple buffer hands over finished frames. The producer always has
+ *    a buffer to draw into, and the consumer always gets the latest
+ *    finished frame. Frames the consumer doesn't get to are overwritten.
+ *
+ *  - The queue hands over events in order. A full queue refuses new
+ *    events, so the producer can leave them where they came from until
+ *    there's room.
+ *
+ *  Unlike the RWQueue, neither blocks, so a stalled side can't stall the
+ *  other.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+template <typename T>
+class TripleBuffer {
+public:
+	TripleBuffer() = default;
+
+	TripleBuffer(const TripleBuffer&)            = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	// Producer: the buffer to fill with the next frame
+	T& Back()
+	{
+		return buffers[back];
+	}
+
+	// Producer: hands over the filled buffer, replacing a frame the
+	// consumer hasn't taken yet
+	void Publish()
+	{
+		const auto previous = middle.exchange(static_cast<uint8_t>(back | fresh_flag),
+		                                      std::memory_order_acq_rel);
+		back = previous & index_mask;
+	}
+
+	// Consumer: takes the latest published frame, if there's a new one
+	bool Acquire()
+	{
+		if (!(middle.load(std::memory_order_acquire) & fresh_flag)) {
+			return false;
+		}
+		const auto previous = middle.exchange(front, std::memory_order_acq_rel);
+		front = previous & index_mask;
+		return true;
+	}
+
+	// Consumer: the frame taken last
+	const T& Front() const
+	{
+		return buffers[front];
+	}
+
+private:
+	static constexpr uint8_t index_mask = 0x3;
+	static constexpr uint8_t fresh_flag = 0x4;
+
+	std::array<T, 3> buffers = {};
+
+	uint8_t back                = 0; // owned by the producer
+	std::atomic<uint8_t> middle = 1; // index of the spare, and the flag
+	uint8_t front               = 2; // owned by the consumer
+};
+
+template <typename T, size_t capacity>
+class SpscQueue {
+public:
+	static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0,
+	              "the capacity must be a power of two");
+
+	SpscQueue() = default;
+
+	SpscQueue(const SpscQueue&)            = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// Producer: queues the item, unless the queue is full
+	bool Push(const T& item)
+	{
+		const auto tail = write_index.load(std::memory_order_relaxed);
+		if (tail - read_index.load(std::memory_order_acquire) == capacity) {
+			return false;
+		}
+		items[tail & (capacity - 1)] = item;
+		write_index.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Producer: whether the next push would be refused
+	bool IsFull() const
+	{
+		return write_index.load(std::memory_order_relaxed) -
+		               read_index.load(std::memory_order_acquire) ==
+		       capacity;
+	}
+
+	// Consumer: takes the oldest item, if there is one
+	bool Pop(T& item)
+	{
+		const auto head = read_index.load(std::memory_order_relaxed);
+		if (head == write_index.load(std::memory_order_acquire)) {
+			return false;
+		}
+		item = items[head & (capacity - 1)];
+		read_index.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::array<T, capacity> items = {};
+
+	// Free-running counters; their difference is the number of items
+	alignas(64) std::atomic<size_t> write_index = 0;
+	alignas(64) std::atomic<size_t> read_index  = 0;
+};
+
+#endif
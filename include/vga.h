@@ -1160,6 +1160,7 @@ void VGA_DACSetEntirePalette(void);
 void VGA_StartRetrace(void);
 void VGA_StartUpdateLFB(void);
 void VGA_SetBlinking(uint8_t enabled);
+void VGA_LogTextCacheStats();
 void VGA_SetCGA2Table(uint8_t val0, uint8_t val1);
 void VGA_SetCGA4Table(uint8_t val0, uint8_t val1, uint8_t val2, uint8_t val3);
 PixelFormat VGA_ActivateHardwareCursor();
@@ -1245,7 +1246,6 @@ extern int CGA_Composite_Table[1024];
 extern uint32_t TXT_Font_Table[16];
 extern uint32_t TXT_FG_Table[16];
 extern uint32_t TXT_BG_Table[16];
-extern uint32_t Expand16Table[4][16];
 extern uint32_t Expand16BigTable[0x10000];
 
 #endif
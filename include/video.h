@@ -396,8 +396,23 @@ void GFX_RequestExit(const bool requested);
 void GFX_Start(void);
 void GFX_Stop(void);
 void GFX_SwitchFullScreen(void);
+// Called as each DOS frame starts; false if the frame won't be presented,
+// so it needn't be drawn
+bool GFX_IsFrameWanted();
 bool GFX_StartUpdate(uint8_t * &pixels, int &pitch);
-void GFX_EndUpdate( const uint16_t *changedLines );
+
+// The output columns [first, last) that changed within a run of changed lines
+struct ChangedColumns {
+	uint16_t first = 0;
+	uint16_t last  = 0;
+};
+
+// 'changedLines' alternates the heights of runs of unchanged and changed
+// output lines, starting with an unchanged run. If 'changedColumns' is given,
+// its entries at the indexes of the changed runs narrow them down to the
+// columns that changed.
+void GFX_EndUpdate(const uint16_t* changedLines,
+                   const ChangedColumns* changedColumns = nullptr);
 void GFX_LosingFocus();
 void GFX_RegenerateWindow(Section *sec);
 
@@ -51,7 +51,7 @@
 #include "tracy.h"
 
 #define CACHE_MAXSIZE	(4096*3)
-#define CACHE_TOTAL		(1024*1024*8)
+#define CACHE_TOTAL		(1024*1024*4)	// initial size, see DYNCACHE_SetMaxSize
 #define CACHE_PAGES		(512)
 #define CACHE_BLOCKS	(64*1024)
 #define CACHE_ALIGN		(16)
@@ -337,11 +337,20 @@ restart_core:
 	if (!chandler) {
 		return sync_dh_fpu_and_run_normal_core();
 	}
+	/* Leave code that keeps being rewritten to the normal core */
+	if (chandler->IsDemoted()) {
+		return sync_dh_fpu_and_run_normal_core();
+	}
+	/* Translate the blocks known from earlier sessions */
+	if (chandler->restore_blocks) {
+		cache_restore_blocks(chandler, ip_point);
+	}
 	/* Find correct Dynamic Block to run */
 	CacheBlock * block=chandler->FindCacheBlock(ip_point&4095);
+	cache_note_block_found(block);
 	if (!block) {
 		if (!chandler->invalidation_map || (chandler->invalidation_map[ip_point&4095]<4)) {
-			block=CreateCacheBlock(chandler,ip_point,32);
+			block=cache_translate_block(chandler,ip_point);
 		} else {
 			int32_t old_cycles=CPU_Cycles;
 			CPU_Cycles=1;
@@ -358,6 +367,7 @@ restart_core:
 	}
 run_block:
 	cache.block.running=nullptr;
+	cache_mark_referenced(block);
 	const auto ret = sync_normal_fpu_and_run_dyn_code(block->cache.start);
 #	if C_DEBUG
 	cycle_count += 32;
@@ -416,6 +426,7 @@ run_block:
 			if (temp_handler->flags & (cpu.code.big ? PFLAG_HASCODE32:PFLAG_HASCODE16)) {
 				block=temp_handler->FindCacheBlock(temp_ip & 4095);
 				if (!block || !cache.block.running) goto restart_core;
+				cache_note_block_found(block);
 				cache.block.running->LinkTo(ret==BR_Link2,block);
 				goto run_block;
 			}
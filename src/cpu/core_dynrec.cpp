@@ -21,14 +21,14 @@
 #if (C_DYNREC)
 
 #include <cassert>
-// simde needs std::isnan
-#include <cmath>
 #include <cstdarg>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
+#include <iterator>
 #include <type_traits>
 
 #if defined (WIN32)
@@ -59,13 +59,19 @@
 #include "tracy.h"
 
 #define CACHE_MAXSIZE	(4096*2)
-#define CACHE_TOTAL		(1024*1024*8)
+#define CACHE_TOTAL		(1024*1024*4)	// initial size, see DYNCACHE_SetMaxSize
 #define CACHE_PAGES		(512)
 #define CACHE_BLOCKS	(128*1024)
 #define CACHE_ALIGN		(16)
 #define DYN_HASH_SHIFT	(4)
 #define DYN_PAGE_HASH	(4096>>DYN_HASH_SHIFT)
 #define DYN_LINKS		(16)
+#define DYN_TRACE_THRESHOLD	(256)	// exits of a block before it's recompiled as a superblock
+#define DYN_TRACE_SEGMENTS	(4)	// maximum number of blocks joined into a superblock
+#define DYN_TRACE_DISSOLVES	(3)	// dissolved superblocks before a block is left as it is
+#define DYN_TRACE_OPCODE_BYTES	(CACHE_MAXSIZE/32)	// code an opcode can take, as in a block of 32 opcodes
+#define DYN_TRACE_OPCODE_INFOS	(16)	// save_info entries an opcode can take, as in a block of 32 opcodes
+#define DYN_SAVE_INFO_BYTES	(128)	// rarely executed code emitted for a save_info entry at the block's end
 
 
 //#define DYN_LOG 1 //Turn Logging on.
@@ -180,8 +186,6 @@ static_assert(offsetof(core_dynrec_t, readdata) % sizeof(uint32_t) == 0,
 #include "core_dynrec/risc_ppc64le.h"
 #endif
 
-#include "simde/x86/mmx.h"
-
 #if !defined(WORDS_BIGENDIAN)
 #define gen_add_LE gen_add
 #define gen_mov_LE_word_to_reg gen_mov_word_to_reg
@@ -189,6 +193,9 @@ static_assert(offsetof(core_dynrec_t, readdata) % sizeof(uint32_t) == 0,
 
 #include "core_dynrec/decoder.h"
 
+// cleared to measure what superblocks gain
+static bool trace_enabled = true;
+
 CacheBlock *LinkBlocks(BlockReturn ret)
 {
 	// the last instruction was a control flow modifying instruction
@@ -215,6 +222,7 @@ CacheBlock *LinkBlocks(BlockReturn ret)
 	if (!cache_block) {
 		return nullptr;
 	}
+	cache_note_block_found(cache_block);
 
 	// found it, link the current block to
 	cache.block.running->LinkTo(ret == BR_Link2, cache_block);
@@ -257,14 +265,25 @@ Bits CPU_Core_Dynrec_Run() noexcept
 			return CPU_Core_Normal_Run();
 		}
 
+		// page with code that keeps being rewritten
+		if (chandler->IsDemoted()) {
+			return CPU_Core_Normal_Run();
+		}
+
+		// translate the blocks known from earlier sessions
+		if (chandler->restore_blocks) {
+			cache_restore_blocks(chandler, ip_point);
+		}
+
 		// find correct Dynamic Block to run
 		CacheBlock *block = chandler->FindCacheBlock(ip_point & 4095);
+		cache_note_block_found(block);
 		if (!block) {
 			// no block found, thus translate the instruction stream
 			// unless the instruction is known to be modified
 			if (!chandler->invalidation_map || (chandler->invalidation_map[ip_point&4095]<4)) {
 				// translate up to 32 instructions
-				block=CreateCacheBlock(chandler,ip_point,32);
+				block=cache_translate_block(chandler,ip_point);
 			} else {
 				// let the normal core handle this instruction to avoid zero-sized blocks
 				Bitu old_cycles=CPU_Cycles;
@@ -277,10 +296,21 @@ Bits CPU_Core_Dynrec_Run() noexcept
 				CPU_CycleLeft+=old_cycles;
 				return nc_retcode;
 			}
+		} else if (!block->trace.is_superblock) {
+			// hot block, recompile it along with its most frequent successors;
+			// each dissolved superblock doubles the samples needed to try again
+			const uint32_t threshold=DYN_TRACE_THRESHOLD<<block->trace.dissolves;
+			if (trace_enabled && block->trace.dissolves<DYN_TRACE_DISSOLVES &&
+			    block->trace.exits[0]+block->trace.exits[1]>=threshold)
+				block=CreateSuperblock(chandler,block,ip_point);
+		} else if (block->trace.side_exits>=DYN_TRACE_THRESHOLD &&
+		           block->trace.side_exits>block->trace.exits[0]+block->trace.exits[1]) {
+			block=DissolveSuperblock(chandler,block,ip_point);
 		}
 
 run_block:
 		cache.block.running=nullptr;
+		cache_mark_referenced(block);
 		// now we're ready to run the dynamic code block
 //		BlockReturn ret=((BlockReturn (*)(void))(block->cache.start))();
 		BlockReturn ret=core_dynrec.runcode(block->cache.start);
@@ -389,7 +419,21 @@ void CPU_Core_Dynrec_Cache_Init(bool enable_cache) {
 	cache_init(enable_cache);
 }
 
+DynrecTraceStats CPU_Core_Dynrec_GetTraceStats()
+{
+	return trace_stats;
+}
+
+void CPU_Core_Dynrec_EnableTracing(const bool enabled)
+{
+	trace_enabled = enabled;
+}
+
 void CPU_Core_Dynrec_Cache_Close(void) {
+	if (trace_stats.formed) {
+		LOG_MSG("DYNREC: Formed %d superblocks, dissolved %d",
+		        trace_stats.formed, trace_stats.dissolved);
+	}
 	cache_close();
 }
 
@@ -42,8 +42,13 @@ static CacheBlock *CreateCacheBlock(CodePageHandler *codepage, PhysPt start, Bit
 	decode.page.first=start >> 12;
 	decode.active_block=decode.block=cache_openblock();
 	decode.block->page.start=(uint16_t)decode.page.index;
+	decode.block->trace={};
+	decode.block->trace.is_superblock=(decode.trace.num_branches>0);
 	codepage->AddCacheBlock(decode.block);
 
+	// superblocks decode a full block's worth of opcodes after each branch
+	const Bitu segment_opcodes=max_opcodes;
+
 	auto cache_addr = static_cast<void *>(
 	        const_cast<uint8_t *>(decode.block->cache.start));
 	constexpr size_t cache_bytes = CACHE_MAXSIZE;
@@ -204,9 +209,16 @@ static CacheBlock *CreateCacheBlock(CodePageHandler *codepage, PhysPt start, Bit
 				// short conditional jumps
 				case 0x80:case 0x81:case 0x82:case 0x83:case 0x84:case 0x85:case 0x86:case 0x87:	
 				case 0x88:case 0x89:case 0x8a:case 0x8b:case 0x8c:case 0x8d:case 0x8e:case 0x8f:	
-					dyn_branched_exit((BranchTypes)(dual_code&0xf),
-						decode.big_op ? (int32_t)decode_fetchd() : (int16_t)decode_fetchw());
+				{
+					const auto btype=(BranchTypes)(dual_code&0xf);
+					const int32_t eip_add=decode.big_op ? (int32_t)decode_fetchd() : (int16_t)decode_fetchw();
+					if (dyn_trace_branch(btype,eip_add)) {
+						max_opcodes=std::min(segment_opcodes,decode.trace.segment_opcodes);
+						break;
+					}
+					dyn_branched_exit(btype,eip_add);
 					goto finish_block;
+				}
 
 				// conditional byte set instructions
 /*				case 0x90:case 0x91:case 0x92:case 0x93:case 0x94:case 0x95:case 0x96:case 0x97:	
@@ -676,8 +688,16 @@ static CacheBlock *CreateCacheBlock(CodePageHandler *codepage, PhysPt start, Bit
 		// short conditional jumps
 		case 0x70:case 0x71:case 0x72:case 0x73:case 0x74:case 0x75:case 0x76:case 0x77:	
 		case 0x78:case 0x79:case 0x7a:case 0x7b:case 0x7c:case 0x7d:case 0x7e:case 0x7f:	
-			dyn_branched_exit((BranchTypes)(opcode&0xf),(int8_t)decode_fetchb());	
+		{
+			const auto btype=(BranchTypes)(opcode&0xf);
+			const int32_t eip_add=(int8_t)decode_fetchb();
+			if (dyn_trace_branch(btype,eip_add)) {
+				max_opcodes=std::min(segment_opcodes,decode.trace.segment_opcodes);
+				break;
+			}
+			dyn_branched_exit(btype,eip_add);
 			goto finish_block;
+		}
 
 		// 'op []/reg8,imm8'
 		case 0x80:
@@ -905,16 +925,30 @@ static CacheBlock *CreateCacheBlock(CodePageHandler *codepage, PhysPt start, Bit
 			goto finish_block;
 		// 'jmp near imm16/32'
 		case 0xe9:
-			dyn_exit_link(decode.big_op ? (int32_t)decode_fetchd() : (int16_t)decode_fetchw());
+		{
+			const int32_t eip_add=decode.big_op ? (int32_t)decode_fetchd() : (int16_t)decode_fetchw();
+			if (dyn_trace_jump(eip_add)) {
+				max_opcodes=std::min(segment_opcodes,decode.trace.segment_opcodes);
+				break;
+			}
+			dyn_exit_link(eip_add);
 			goto finish_block;
+		}
 		// 'jmp far'
 		case 0xea:
 			dyn_jmp_far_imm();
 			goto finish_block;
 		// 'jmp short imm8'
 		case 0xeb:
-			dyn_exit_link((int8_t)decode_fetchb());
+		{
+			const int32_t eip_add=(int8_t)decode_fetchb();
+			if (dyn_trace_jump(eip_add)) {
+				max_opcodes=std::min(segment_opcodes,decode.trace.segment_opcodes);
+				break;
+			}
+			dyn_exit_link(eip_add);
 			goto finish_block;
+		}
 
 
 		// repeat prefixes
@@ -981,6 +1015,7 @@ static CacheBlock *CreateCacheBlock(CodePageHandler *codepage, PhysPt start, Bit
 	// link to next block because the maximum number of opcodes has been reached
 	dyn_set_eip_end();
 	dyn_reduce_cycles();
+	dyn_count_exit(0);
 	gen_jmp_ptr(&decode.block->link[0].to, offsetof(CacheBlock, cache.start));
 	dyn_closeblock();
     goto finish_block;
@@ -1009,3 +1044,70 @@ finish_block:
 	//%d",decode.block->cache.size,decode.block->page.start,decode.block->page.end);
 	return decode.block;
 }
+
+static DynrecTraceStats trace_stats = {};
+
+/*
+	The function CreateSuperblock recompiles a block that has been
+	executed often together with the blocks it continues into most of
+	the time. The profile is taken from the exit counters of the blocks,
+	following the links as long as one path clearly dominates and the
+	next block starts further down the same page. The superblock replaces
+	the original block; the branches in-between are kept as side exits.
+*/
+
+static CacheBlock *CreateSuperblock(CodePageHandler *codepage, CacheBlock *head, PhysPt start)
+{
+	TraceBranch branches[DYN_TRACE_SEGMENTS];
+	Bitu num_branches=0;
+
+	CacheBlock *block=head;
+	while (num_branches<DYN_TRACE_SEGMENTS) {
+		const uint32_t taken=block->trace.exits[1];
+		const uint32_t not_taken=block->trace.exits[0];
+		const uint32_t total=taken+not_taken;
+		const uint8_t hot=(taken>not_taken) ? 1 : 0;
+		// require enough samples and a path taken at least 7 out of 8 times
+		if (total<16 || (hot ? taken : not_taken)<total-total/8) break;
+
+		branches[num_branches].end=block->page.end;
+		branches[num_branches].link=hot;
+		num_branches++;
+
+		CacheBlock *next=block->link[hot].to;
+		if (next==&link_blocks[hot] || next->page.handler!=codepage ||
+		    next->crossblock || next->page.start<=block->page.end) break;
+		block=next;
+	}
+
+	if (!num_branches) {
+		// no dominant path, check again after another round of samples
+		head->trace.exits[0]=0;
+		head->trace.exits[1]=0;
+		return head;
+	}
+
+	const uint8_t dissolves=head->trace.dissolves;
+	head->Clear();
+	decode.trace.branches=branches;
+	decode.trace.num_branches=num_branches;
+	CacheBlock *superblock=CreateCacheBlock(codepage,start,32);
+	superblock->trace.dissolves=dissolves;
+	decode.trace.branches=nullptr;
+	decode.trace.num_branches=0;
+	trace_stats.formed++;
+	return superblock;
+}
+
+// a superblock that leaves through its side exits more often than it
+// runs to its end is translated as a regular block again; the block keeps
+// count, so one whose path keeps changing isn't formed again and again
+static CacheBlock *DissolveSuperblock(CodePageHandler *codepage, CacheBlock *superblock, PhysPt start)
+{
+	const uint8_t dissolves=superblock->trace.dissolves+1;
+	superblock->Clear();
+	trace_stats.dissolved++;
+	CacheBlock *block=CreateCacheBlock(codepage,start,32);
+	block->trace.dissolves=dissolves;
+	return block;
+}
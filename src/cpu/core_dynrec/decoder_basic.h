@@ -81,6 +81,12 @@ static DualOps grp1_table[8]={
 };
 
 
+// a branch that ended one of the blocks a superblock is formed from
+struct TraceBranch {
+	uint16_t end;	// page index of the last byte of the branch instruction
+	uint8_t link;	// the link path that is taken most of the time
+};
+
 // decoding information used during translation of a code block
 static struct DynDecode {
 	PhysPt code;			// pointer to next byte in the instruction stream
@@ -107,6 +113,13 @@ static struct DynDecode {
 		Bitu first;		// page number 
 	} page;
 
+	// branches the hot path continues past when forming a superblock
+	struct {
+		const TraceBranch *branches;
+		Bitu num_branches;
+		Bitu segment_opcodes;	// opcodes the segment after a followed branch has room for
+	} trace;
+
 	// modrm state of the current instruction (if used)
 	struct {
 		uint_fast8_t val;
@@ -563,7 +576,7 @@ static inline const uint8_t* gen_call_function_mm(void * func,Bitu op1,Bitu op2)
 
 
 
-enum save_info_type {db_exception, cycle_check, string_break};
+enum save_info_type {db_exception, cycle_check, string_break, trace_exit};
 
 
 // function that is called on exceptions
@@ -623,6 +636,14 @@ static void dyn_fill_blocks(void) {
 				gen_add_direct_word(&reg_eip,save_info_dynrec[sct].eip_change,decode.big_op);
 				dyn_return(BR_Cycles);
 				break;
+			case trace_exit:
+				// a superblock leaves its hot path, let the core find the
+				// block to continue with
+				gen_add_direct_word(&reg_eip,save_info_dynrec[sct].eip_change,cpu.code.big);
+				gen_sub_direct_word(&CPU_Cycles,save_info_dynrec[sct].cycles,true);
+				gen_add_direct_word(&decode.block->trace.side_exits,1,true);
+				dyn_return(BR_Normal);
+				break;
 		}
 	}
 	used_save_info_dynrec=0;
@@ -1150,71 +1171,151 @@ static void gen_restore_reg(HostReg reg,HostReg dest_reg) {
 // they try to find out if a function can be replaced by another
 // one that does not generate any flags at all
 
+// Every queued function remembers which of the flags it generated can still
+// be read. Instructions overwriting flags take them out of these masks, and
+// a function is replaced once none of its flags are left. Reading flags only
+// keeps the functions that generated the flags being read, so for example an
+// inc between an add and an adc doesn't keep the inc's flags alive.
+
+#define MF_FUNCTIONS_MAX 64
+
 static Bitu mf_functions_num=0;
 static struct {
 	const uint8_t* pos;
 	void* fct_ptr;
 	Bitu ftype;
-} mf_functions[64];
+	Bitu live_flags;
+} mf_functions[MF_FUNCTIONS_MAX];
+
+// the flags the full variant of an operation generates
+static Bitu MF_GeneratedFlags(Bitu flags_type) {
+	switch (flags_type) {
+		case t_INCb: case t_INCw: case t_INCd:
+		case t_DECb: case t_DECw: case t_DECd:
+			return FMASK_TEST & ~FLAG_CF;
+		case t_ROLb: case t_ROLw: case t_ROLd:
+		case t_RORb: case t_RORw: case t_RORd:
+			return FLAG_CF|FLAG_OF;
+		default:
+			return FMASK_TEST;
+	}
+}
+
+// the flags an operation is certain to overwrite, shifts and rotates
+// leave all flags alone for a count of zero
+static Bitu MF_OverwrittenFlags(Bitu flags_type) {
+	switch (flags_type) {
+		case t_INCb: case t_INCw: case t_INCd:
+		case t_DECb: case t_DECw: case t_DECd:
+			return FMASK_TEST & ~FLAG_CF;
+		case t_SHLb: case t_SHLw: case t_SHLd:
+		case t_SHRb: case t_SHRw: case t_SHRd:
+		case t_SARb: case t_SARw: case t_SARd:
+		case t_ROLb: case t_ROLw: case t_ROLd:
+		case t_RORb: case t_RORw: case t_RORd:
+		case t_DSHLw: case t_DSHLd:
+		case t_DSHRw: case t_DSHRd:
+			return 0;
+		default:
+			return FMASK_TEST;
+	}
+}
 
 static void InitFlagsOptimization(void) {
 	mf_functions_num=0;
 }
 
+#ifdef DRC_FLAGS_INVALIDATION
+// remove queued functions for which keep() returns false, the others
+// stay in the queue in their order
+template <typename Pred>
+static void MF_Filter(Pred keep) {
+	Bitu kept=0;
+	for (Bitu ct=0; ct<mf_functions_num; ct++) {
+		if (keep(mf_functions[ct])) mf_functions[kept++]=mf_functions[ct];
+	}
+	mf_functions_num=kept;
+}
+
+// the current instruction overwrites these flags, replace the functions
+// that have no flags left which could be read
+static void MF_OverwriteFlags(Bitu flags_mask) {
+	if (!flags_mask) return;
+	MF_Filter([flags_mask](auto &mf) {
+		mf.live_flags&=~flags_mask;
+		if (mf.live_flags) return true;
+		gen_fill_function_ptr(mf.pos,mf.fct_ptr,mf.ftype);
+		return false;
+	});
+}
+
+static void MF_Enqueue(void* current_simple_function,const uint8_t* cpos,Bitu flags_type) {
+	// when full, the oldest function stays as it is
+	if (mf_functions_num==MF_FUNCTIONS_MAX) {
+		for (Bitu ct=1; ct<mf_functions_num; ct++) mf_functions[ct-1]=mf_functions[ct];
+		--mf_functions_num;
+	}
+	mf_functions[mf_functions_num].pos=cpos;
+	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
+	mf_functions[mf_functions_num].ftype=flags_type;
+	mf_functions[mf_functions_num].live_flags=MF_GeneratedFlags(flags_type);
+	++mf_functions_num;
+}
+#endif
+
 // replace all queued functions with their simpler variants
 // because the current instruction destroys all condition flags and
 // the flags are not required before
 static void InvalidateFlags(void) {
 #ifdef DRC_FLAGS_INVALIDATION
-	for (Bitu ct=0; ct<mf_functions_num; ct++) {
-		gen_fill_function_ptr(mf_functions[ct].pos,mf_functions[ct].fct_ptr,mf_functions[ct].ftype);
-	}
-	mf_functions_num=0;
+	MF_OverwriteFlags(FMASK_TEST);
+#endif
+}
+
+// replace the queued functions whose flags are all overwritten by
+// the current instruction
+static void InvalidateFlags([[maybe_unused]] Bitu flags_mask) {
+#ifdef DRC_FLAGS_INVALIDATION
+	MF_OverwriteFlags(flags_mask);
 #endif
 }
 
 // replace all queued functions with their simpler variants
 // because the current instruction destroys all condition flags and
 // the flags are not required before
-static void InvalidateFlags(void* current_simple_function,Bitu flags_type) {
+static void InvalidateFlags([[maybe_unused]] void* current_simple_function,[[maybe_unused]] Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
-	for (Bitu ct=0; ct<mf_functions_num; ct++) {
-		gen_fill_function_ptr(mf_functions[ct].pos,mf_functions[ct].fct_ptr,mf_functions[ct].ftype);
-	}
-	mf_functions_num=1;
-	mf_functions[0].pos=cache.pos;
-	mf_functions[0].fct_ptr=current_simple_function;
-	mf_functions[0].ftype=flags_type;
+	MF_OverwriteFlags(FMASK_TEST);
+	MF_Enqueue(current_simple_function,cache.pos,flags_type);
 #endif
 }
 
-// enqueue this instruction, if later an instruction is encountered that
-// destroys all condition flags and the flags weren't needed in-between
-// this function can be replaced by a simpler one as well
-static void InvalidateFlagsPartially(void* current_simple_function,Bitu flags_type) {
+// enqueue this instruction, if later instructions overwrite all
+// the flags it generates before they are read this function can
+// be replaced by a simpler one as well
+static void InvalidateFlagsPartially([[maybe_unused]] void* current_simple_function,[[maybe_unused]] Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions[mf_functions_num].pos=cache.pos;
-	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
-	mf_functions[mf_functions_num].ftype=flags_type;
-	++mf_functions_num;
+	MF_OverwriteFlags(MF_OverwrittenFlags(flags_type));
+	MF_Enqueue(current_simple_function,cache.pos,flags_type);
 #endif
 }
 
-// enqueue this instruction, if later an instruction is encountered that
-// destroys all condition flags and the flags weren't needed in-between
-// this function can be replaced by a simpler one as well
-static void InvalidateFlagsPartially(void* current_simple_function,const uint8_t* cpos,Bitu flags_type) {
+// enqueue this instruction, if later instructions overwrite all
+// the flags it generates before they are read this function can
+// be replaced by a simpler one as well
+static void InvalidateFlagsPartially([[maybe_unused]] void* current_simple_function,[[maybe_unused]] const uint8_t* cpos,[[maybe_unused]] Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions[mf_functions_num].pos=cpos;
-	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
-	mf_functions[mf_functions_num].ftype=flags_type;
-	++mf_functions_num;
+	MF_OverwriteFlags(MF_OverwrittenFlags(flags_type));
+	MF_Enqueue(current_simple_function,cpos,flags_type);
 #endif
 }
 
-// the current function needs the condition flags thus reset the queue
+// the current function needs these condition flags, keep the functions
+// generating any of them
 static void AcquireFlags([[maybe_unused]] Bitu flags_mask) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions_num=0;
+	MF_Filter([flags_mask](const auto &mf) {
+		return (mf.live_flags & flags_mask)==0;
+	});
 #endif
 }
@@ -1094,13 +1094,22 @@ static void dyn_cwd(void) {
 static void dyn_sahf(void) {
 	MOV_REG_WORD16_TO_HOST_REG(FC_OP1,DRC_REG_EAX);
 	gen_call_function_raw((void *)&dynrec_sahf);
-	InvalidateFlags();
+	// OF is kept from the previous operation
+	AcquireFlags(FLAG_OF);
+	InvalidateFlags(FMASK_TEST & ~FLAG_OF);
 }
 
 
+// count how often a link path is taken, superblocks are formed along
+// the paths that are taken most of the time
+static void dyn_count_exit(Bitu link_index) {
+	gen_add_direct_word(&decode.block->trace.exits[link_index],1,true);
+}
+
 static void dyn_exit_link(Bits eip_change) {
 	gen_add_direct_word(&reg_eip,(decode.code-decode.code_start)+eip_change,decode.big_op);
 	dyn_reduce_cycles();
+	dyn_count_exit(0);
 	gen_jmp_ptr(&decode.block->link[0].to, offsetof(CacheBlock, cache.start));
 	dyn_closeblock();
 }
@@ -1115,15 +1124,97 @@ static void dyn_branched_exit(BranchTypes btype,int32_t eip_add) {
 
  	// Branch not taken
 	gen_add_direct_word(&reg_eip,eip_base,decode.big_op);
+	dyn_count_exit(0);
 	gen_jmp_ptr(&decode.block->link[0].to, offsetof(CacheBlock, cache.start));
 	gen_fill_branch(data);
 
  	// Branch taken
 	gen_add_direct_word(&reg_eip,eip_base+eip_add,decode.big_op);
+	dyn_count_exit(1);
 	gen_jmp_ptr(&decode.block->link[1].to, offsetof(CacheBlock, cache.start));
 	dyn_closeblock();
 }
 
+
+// superblocks: the blocks a hot block most often continues into are
+// translated along with it, the other paths leave through side exits
+
+// the link path the hot path takes at the branch that was just decoded,
+// or -1 if the superblock ends with this branch
+static int dyn_trace_link(void) {
+	// only the page the superblock starts in is traced
+	if (decode.active_block!=decode.block) return -1;
+	for (Bitu i=0; i<decode.trace.num_branches; i++) {
+		if (decode.trace.branches[i].end==decode.page.index-1)
+			return decode.trace.branches[i].link;
+	}
+	return -1;
+}
+
+// work out how many opcodes the next segment can take, from the space left
+// in the cache block and in the save_info table; the rarely executed code
+// of the entries so far, the branch itself, and the code ending the block
+// are set aside first
+static bool dyn_trace_has_room(void) {
+	decode.trace.segment_opcodes=0;
+	if (decode.big_op!=cpu.code.big) return false;
+
+	const auto used=static_cast<Bitu>(cache.pos-decode.block->cache.start);
+	const Bitu size=std::min<Bitu>(decode.block->cache.size,CACHE_MAXSIZE);
+	const Bitu reserved=used+(used_save_info_dynrec+1)*DYN_SAVE_INFO_BYTES+
+	                    2*DYN_TRACE_OPCODE_BYTES;
+	if (reserved>=size) return false;
+
+	constexpr Bitu num_save_infos=std::size(save_info_dynrec);
+	if (used_save_info_dynrec+1>=num_save_infos) return false;
+
+	decode.trace.segment_opcodes=std::min(
+	        (size-reserved)/DYN_TRACE_OPCODE_BYTES,
+	        (num_save_infos-used_save_info_dynrec-1)/DYN_TRACE_OPCODE_INFOS);
+	return decode.trace.segment_opcodes>0;
+}
+
+// continue decoding at a branch target further down the same page; the
+// skipped bytes are added to the write map so the block still covers one
+// contiguous range (modifications there invalidate the superblock as well)
+static bool dyn_trace_skip_to(int32_t eip_add) {
+	if (eip_add<0 || decode.page.index+eip_add>=4096) return false;
+	for (Bitu i=decode.page.index; i<decode.page.index+eip_add; i++) {
+		decode.page.wmap[i]++;
+	}
+	decode.code+=eip_add;
+	decode.page.index+=eip_add;
+	return true;
+}
+
+// conditional jump inside a superblock, returns false if the block has to
+// end with a regular branched exit
+static bool dyn_trace_branch(BranchTypes btype,int32_t eip_add) {
+	const int link=dyn_trace_link();
+	if (link<0 || !dyn_trace_has_room()) return false;
+	if (link==1 && (eip_add<0 || decode.page.index+eip_add>=4096)) return false;
+
+	const Bitu eip_base=decode.code-decode.code_start;
+	AcquireFlags(FMASK_TEST);
+
+	// branch to the side exit if the cold path is taken
+	dyn_branchflag_to_reg(link ? (BranchTypes)(btype^1) : btype);
+	save_info_dynrec[used_save_info_dynrec].branch_pos=gen_create_branch_long_nonzero(FC_RETOP,true);
+	save_info_dynrec[used_save_info_dynrec].eip_change=(uint32_t)(link ? eip_base : eip_base+eip_add);
+	save_info_dynrec[used_save_info_dynrec].cycles=decode.cycles;
+	save_info_dynrec[used_save_info_dynrec].type=trace_exit;
+	used_save_info_dynrec++;
+
+	if (link) dyn_trace_skip_to(eip_add);
+	return true;
+}
+
+// unconditional jump inside a superblock
+static bool dyn_trace_jump(int32_t eip_add) {
+	if (dyn_trace_link()!=0 || !dyn_trace_has_room()) return false;
+	return dyn_trace_skip_to(eip_add);
+}
+
 /*
 static void dyn_set_byte_on_condition(BranchTypes btype) {
 	dyn_get_modrm();
@@ -18,6 +18,7 @@
  */
 
 #include "mmx.h"
+#include "mmx_ops.h"
 
 extern uint32_t* lookupRMEAregd[256];
 
@@ -137,10 +138,7 @@ static void mmx_paddb(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_paddb(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PADDB(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xFC) // PADDB Pq,Qq
@@ -165,10 +163,7 @@ static void mmx_paddw(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_paddw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PADDW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xFD) // PADDW Pq,Qq
@@ -193,10 +188,7 @@ static void mmx_paddd(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_paddd(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PADDD(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xFE) // PADDD Pq,Qq
@@ -221,10 +213,7 @@ static void mmx_paddsb(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_paddsb(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PADDSB(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xEC) // PADDSB Pq,Qq
@@ -249,10 +238,7 @@ static void mmx_paddsw(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_paddsw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PADDSW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xED) // PADDSW Pq,Qq
@@ -277,10 +263,7 @@ static void mmx_paddusb(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_paddusb(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PADDUSB(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xDC) // PADDUSB Pq,Qq
@@ -305,10 +288,7 @@ static void mmx_paddusw(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_paddusw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PADDUSW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xDD) // PADDUSW Pq,Qq
@@ -333,10 +313,7 @@ static void mmx_psubb(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psubb(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSUBB(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xF8) // PSUBB Pq,Qq
@@ -361,10 +338,7 @@ static void mmx_psubw(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psubw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSUBW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xF9) // PSUBW Pq,Qq
@@ -389,10 +363,7 @@ static void mmx_psubsb(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psubsb(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSUBSB(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xE8) // PSUBSB Pq,Qq
@@ -417,10 +388,7 @@ static void mmx_psubsw(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psubsw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSUBSW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xE9) // PSUBSW Pq,Qq
@@ -445,10 +413,7 @@ static void mmx_psubusb(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psubusb(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSUBUSB(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xD8) // PSUBUSB Pq,Qq
@@ -473,10 +438,7 @@ static void mmx_psubusw(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psubusw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSUBUSW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xD9) // PSUBUSW Pq,Qq
@@ -501,10 +463,7 @@ static void mmx_psubd(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psubd(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSUBD(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xFA) // PSUBD Pq,Qq
@@ -529,10 +488,7 @@ static void mmx_pmaddwd(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pmaddwd(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PMADDWD(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xF5) // PMADDWD Pq,Qq
@@ -557,10 +513,7 @@ static void mmx_pmulhw(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pmulhw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PMULHW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xE5) // PMULHW Pq,Qq
@@ -585,10 +538,7 @@ static void mmx_pmullw(const Bitu rm, const PhysPt eaa)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pmullw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PMULLW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xD5) // PMULLW Pq,Qq
@@ -613,10 +563,7 @@ static void mmx_packuswb(const Bitu rm, const PhysPt eaa = 0)
 	} else {
 		src.q = LoadMq(eaa);
 	}
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_packuswb(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PACKUSWB(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x67) // PACKUSWB Pq,Qq
@@ -638,23 +585,14 @@ static void mmx_psllw_psrlw_psraw(const Bitu rm, const Bitu shift)
 	MMX_reg* dest = reg_mmx[rm & 7];
 	switch (op) {
 	case 0x06: // PSLLW
-	{
-		const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-		const auto res = simde_m_psllwi(dest_m, shift);
-		dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
-	} break;
+		dest->q = MMX_PSLLW(dest->q, shift);
+		break;
 	case 0x02: // PSRLW
-	{
-		const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-		const auto res = simde_m_psrlwi(dest_m, shift);
-		dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
-	} break;
+		dest->q = MMX_PSRLW(dest->q, shift);
+		break;
 	case 0x04: // PSRAW
-	{
-		const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-		const auto res = simde_m_psrawi(dest_m, shift);
-		dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
-	} break;
+		dest->q = MMX_PSRAW(dest->q, shift);
+		break;
 	}
 }
 
@@ -673,23 +611,14 @@ static void mmx_pslld_psrld_psrad(const Bitu rm, const Bitu shift)
 	MMX_reg* dest = reg_mmx[rm & 7];
 	switch (op) {
 	case 0x06: // PSLLD
-	{
-		const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-		const auto res = simde_m_pslldi(dest_m, shift);
-		dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
-	} break;
+		dest->q = MMX_PSLLD(dest->q, shift);
+		break;
 	case 0x02: // PSRLD
-	{
-		const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-		const auto res = simde_m_psrldi(dest_m, shift);
-		dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
-	} break;
+		dest->q = MMX_PSRLD(dest->q, shift);
+		break;
 	case 0x04: // PSRAD
-	{
-		const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-		const auto res = simde_m_psradi(dest_m, shift);
-		dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
-	} break;
+		dest->q = MMX_PSRAD(dest->q, shift);
+		break;
 	}
 }
 
@@ -712,10 +641,7 @@ static void mmx_pslld(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pslld(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSLLD(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xf2) // PSLLD Pq,Qq
@@ -741,10 +667,7 @@ static void mmx_psllq(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psllq(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSLLQ(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xf3) // PSLLQ Pq,Qq
@@ -770,10 +693,7 @@ static void mmx_psrld(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psrld(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSRLD(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xd2) // PSRLD Pq,Qq
@@ -799,10 +719,7 @@ static void mmx_pcmpeqb(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pcmpeqb(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PCMPEQB(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x74) // PCMPEQB Pq,Qq
@@ -828,10 +745,7 @@ static void mmx_pcmpeqw(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pcmpeqw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PCMPEQW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x75) // PCMPEQW Pq,Qq
@@ -857,10 +771,7 @@ static void mmx_pcmpeqd(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pcmpeqd(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PCMPEQD(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x76) // PCMPEQD Pq,Qq
@@ -886,10 +797,7 @@ static void mmx_pcmpgtb(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pcmpgtb(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PCMPGTB(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x64) // PCMPGTB Pq,Qq
@@ -915,10 +823,7 @@ static void mmx_pcmpgtw(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pcmpgtw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PCMPGTW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x65) // PCMPGTW Pq,Qq
@@ -944,10 +849,7 @@ static void mmx_pcmpgtd(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pcmpgtd(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PCMPGTD(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x66) // PCMPGTD Pq,Qq
@@ -973,10 +875,7 @@ static void mmx_packsswb(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_packsswb(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PACKSSWB(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x63) // PACKSSWB Pq,Qq
@@ -1002,10 +901,7 @@ static void mmx_packssdw(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_packssdw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PACKSSDW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x6B) // PACKSSDW Pq,Qq
@@ -1031,10 +927,7 @@ static void mmx_punpckhbw(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_punpckhbw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PUNPCKHBW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x68) // PUNPCKHBW Pq,Qq
@@ -1060,10 +953,7 @@ static void mmx_punpcklbw(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_punpcklbw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PUNPCKLBW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x60) // PUNPCKLBW Pq,Qq
@@ -1089,10 +979,7 @@ static void mmx_punpckhwd(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_punpckhwd(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PUNPCKHWD(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x69) // PUNPCKHWD Pq,Qq
@@ -1118,10 +1005,7 @@ static void mmx_punpcklwd(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_punpcklwd(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PUNPCKLWD(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x61) // PUNPCKLWD Pq,Qq
@@ -1147,10 +1031,7 @@ static void mmx_punpckldq(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_punpckldq(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PUNPCKLDQ(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x62) // PUNPCKLDQ Pq,Qq
@@ -1176,10 +1057,7 @@ static void mmx_punpckhdq(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_punpckhdq(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PUNPCKHDQ(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0x6A) // PUNPCKHDQ Pq,Qq
@@ -1205,10 +1083,7 @@ static void mmx_psllw(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psllw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSLLW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xf1) // PSLLW Pq,Qq
@@ -1234,10 +1109,7 @@ static void mmx_psrlw(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psrlw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSRLW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xd1) // PSRLW Pq,Qq
@@ -1263,10 +1135,7 @@ static void mmx_psrlq(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psrlq(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSRLQ(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xd3) // PSRLQ Pq,Qq
@@ -1285,15 +1154,10 @@ static void dyn_mmx_psrlq()
 static void mmx_psllq_psrlq(const Bitu rm, const Bitu shift)
 {
 	auto dest = reg_mmx[rm & 7];
-	if (shift > 63) {
-		dest->q = 0;
+	if (rm & 0x20) {
+		dest->q = MMX_PSLLQ(dest->q, shift);
 	} else {
-		uint8_t op = rm & 0x20;
-		if (op) {
-			dest->q <<= shift;
-		} else {
-			dest->q >>= shift;
-		}
+		dest->q = MMX_PSRLQ(dest->q, shift);
 	}
 }
 
@@ -1316,10 +1180,7 @@ static void mmx_psraw(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psraw(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSRAW(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xe1) // PSRAW Pq,Qq
@@ -1345,10 +1206,7 @@ static void mmx_psrad(const Bitu rm, const PhysPt eaa)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_psrad(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = MMX_PSRAD(dest->q, src.q);
 }
 
 // CASE_0F_MMX(0xe2) // PSRAD Pq,Qq
@@ -1374,10 +1232,7 @@ static void mmx_por(const Bitu rm, const PhysPt eaa = 0)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_por(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q |= src.q;
 }
 
 // CASE_0F_MMX(0xeb) // POR Pq,Qq
@@ -1402,10 +1257,7 @@ static void mmx_pxor(const Bitu rm, const PhysPt eaa = 0)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pxor(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q ^= src.q;
 }
 
 // CASE_0F_MMX(0xef) // PXOR Pq,Qq
@@ -1430,10 +1282,7 @@ static void mmx_pand(const Bitu rm, const PhysPt eaa = 0)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pand(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q &= src.q;
 }
 
 // CASE_0F_MMX(0xdb) // PAND Pq,Qq
@@ -1458,10 +1307,7 @@ static void mmx_pandn(const Bitu rm, const PhysPt eaa = 0)
 		src.q = LoadMq(eaa);
 	}
 
-	const auto src_m  = simde_m_from_int64(static_cast<int64_t>(src.q));
-	const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	const auto res    = simde_m_pandn(dest_m, src_m);
-	dest->q           = static_cast<uint64_t>(simde_m_to_int64(res));
+	dest->q = ~dest->q & src.q;
 }
 
 // CASE_0F_MMX(0xdf) // PANDN Pq,Qq
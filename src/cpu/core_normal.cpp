@@ -18,8 +18,11 @@
  */
 #include "dosbox.h"
 
-// Needed for std::isnan in simde
-#include <cmath>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <iterator>
 
 #include "callback.h"
 #include "cpu.h"
@@ -27,13 +30,13 @@
 #include "inout.h"
 #include "lazyflags.h"
 #include "mem.h"
+#include "mem_unaligned.h"
 #include "mmx.h"
+#include "mmx_ops.h"
 #include "paging.h"
 #include "pic.h"
 #include "tracy.h"
 
-#include "simde/x86/mmx.h"
-
 #if C_DEBUG
 #include "debug.h"
 #endif
@@ -70,6 +73,13 @@ extern Bitu cycle_count;
 
 #define CPU_TRAP_DECODER	CPU_Core_Normal_Trap_Run
 
+// With compilers that can take the address of a label, the instructions are
+// dispatched through a table of label addresses instead of the switch. The
+// switch remains in place and handles the opcodes missing from the table.
+#if C_COMPUTED_GOTO
+#define CORE_NORMAL_THREADED 1
+#endif
+
 #define OPCODE_NONE			0x000
 #define OPCODE_0F			0x100
 #define OPCODE_SIZE			0x200
@@ -99,6 +109,8 @@ extern Bitu cycle_count;
 
 typedef PhysPt (*GetEAHandler)(void);
 
+struct DecodedInstruction;
+
 static const uint32_t AddrMaskTable[2]={0x0000ffff,0xffffffff};
 
 static struct {
@@ -109,6 +121,7 @@ static struct {
 	bool rep_zero;
 	Bitu prefixes;
 	GetEAHandler * ea_table;
+	DecodedInstruction * decoded; // the instruction's cache entry, if any
 } core;
 
 #define GETIP		(core.cseip-SegBase(cs))
@@ -141,18 +154,53 @@ static inline uint32_t Fetchd() {
 #define Pop_16 CPU_Pop16
 #define Pop_32 CPU_Pop32
 
+// The ModRM byte can come from the decoded instruction cache
+#define FetchRM FetchDecodedRM
+
 #include "instructions.h"
 #include "core_normal/support.h"
 #include "core_normal/string.h"
+#include "core_normal/decode_cache.h"
 
 
 #define EALookupTable (core.ea_table)
 
-Bits CPU_Core_Normal_Run() noexcept
+#if CORE_NORMAL_THREADED
+#define OPCODE_LABEL_W(_WHICH) \
+	opcode_labels[OPCODE_NONE + _WHICH] = &&op_w_##_WHICH;
+#define OPCODE_LABEL_D(_WHICH) \
+	opcode_labels[OPCODE_SIZE + _WHICH] = &&op_d_##_WHICH;
+#define OPCODE_LABEL_0F_W(_WHICH) \
+	opcode_labels[(OPCODE_0F | OPCODE_NONE) + _WHICH] = &&op_0f_w_##_WHICH;
+#define OPCODE_LABEL_0F_D(_WHICH) \
+	opcode_labels[(OPCODE_0F | OPCODE_SIZE) + _WHICH] = &&op_0f_d_##_WHICH;
+#endif
+
+// Taking the address of a label and jumping to it are GNU extensions,
+// which -Wpedantic flags at every one of the table's entries
+#if CORE_NORMAL_THREADED
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+template <bool threaded_dispatch, bool use_decode_cache>
+static Bits run_normal_core()
 {
-	ZoneScoped;
+	Bitu opcode = 0;
+	PhysPt insn_start = 0;
+#if CORE_NORMAL_THREADED
+	static const void *opcode_labels[0x400] = {}; // all four opcode pages
+	if (threaded_dispatch && !opcode_labels[0]) {
+		std::fill(std::begin(opcode_labels),
+		          std::end(opcode_labels),
+		          &&dispatch_switch);
+#include "core_normal/opcode_labels.h"
+	}
+#endif
 	while (CPU_Cycles-->0) {
 		LOADIP;
+		insn_start=core.cseip;
+		core.decoded=nullptr;
 		core.opcode_index=cpu.code.big*0x200;
 		core.prefixes=cpu.code.big;
 		core.ea_table=&EATable[cpu.code.big*256];
@@ -169,7 +217,21 @@ Bits CPU_Core_Normal_Run() noexcept
 		cycle_count++;
 #endif
 restart_opcode:
-		switch (core.opcode_index+Fetchb()) {
+		opcode=core.opcode_index+Fetchb();
+		if (use_decode_cache && decode_cache.enabled) {
+			if (core.cseip - 1 == insn_start) {
+				if (is_prefix(opcode))
+					apply_decoded(insn_start, opcode);
+			} else if (!is_prefix(opcode)) {
+				record_decoded(insn_start, opcode);
+			}
+		}
+#if CORE_NORMAL_THREADED
+		if (threaded_dispatch)
+			goto *opcode_labels[opcode];
+dispatch_switch:
+#endif
+		switch (opcode) {
 		#include "core_normal/prefix_none.h"
 		#include "core_normal/prefix_0f.h"
 		#include "core_normal/prefix_66.h"
@@ -202,6 +264,25 @@ decode_end:
 	return CBRET_NONE;
 }
 
+#if CORE_NORMAL_THREADED
+#pragma GCC diagnostic pop
+#endif
+
+Bits CPU_Core_Normal_Run() noexcept
+{
+	ZoneScoped;
+#if CORE_NORMAL_THREADED
+	return run_normal_core<true, true>();
+#else
+	return run_normal_core<false, true>();
+#endif
+}
+
+Bits CPU_Core_Normal_Switch_Run() noexcept
+{
+	return run_normal_core<false, false>();
+}
+
 Bits CPU_Core_Normal_Trap_Run() noexcept
 {
 	Bits oldCycles = CPU_Cycles;
@@ -220,3 +301,20 @@ void CPU_Core_Normal_Init(void) {
 
 }
 
+void CPU_Core_Normal_Cache_Init(const bool enable_cache)
+{
+	CPU_Core_Normal_Cache_Close();
+	decode_cache.enabled = enable_cache;
+}
+
+void CPU_Core_Normal_Cache_Close()
+{
+	for (auto &page : decode_cache.pages) {
+		if (page.IsActive()) {
+			page.Release();
+		}
+	}
+	decode_cache.next_page = 0;
+	decode_cache.enabled   = false;
+}
+
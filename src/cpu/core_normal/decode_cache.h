@@ -0,0 +1,299 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Decoded instruction cache
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Prefixed instructions go through the dispatch once for every prefix byte
+ * before they reach their opcode. The cache remembers, per linear address,
+ * what decoding such an instruction resolved: the opcode's dispatch index,
+ * the address size and with it the table of effective address handlers,
+ * REP, the segment override, the ModRM byte, and the length up to the
+ * ModRM byte. When the instruction runs again, all of it is applied in one
+ * step and execution continues after the opcode.
+ *
+ * Pages with cached instructions get a page handler that watches writes the
+ * same way the dynamic cores' code pages do: the TLB holds no write pointer
+ * for them, so every write passes the handler. A write that changes a byte
+ * an entry was decoded from invalidates all entries of the page. Like the
+ * dynamic cores, the cache is only used while no dynamic core can run, and
+ * only on plain RAM pages.
+ */
+
+constexpr size_t decoded_cache_size = 4096; // entries, direct mapped
+constexpr size_t decoded_pages_size = 64;   // pages watched at a time
+
+class DecodedPageHandler final : public PageHandler {
+public:
+	DecodedPageHandler() = default;
+
+	DecodedPageHandler(const DecodedPageHandler &) = delete; // prevent copying
+	DecodedPageHandler &operator=(const DecodedPageHandler &) = delete; // prevent assignment
+
+	void SetupAt(const Bitu _phys_page, PageHandler *_old_pagehandler)
+	{
+		phys_page       = _phys_page;
+		old_pagehandler = _old_pagehandler;
+		hostmem = old_pagehandler->GetHostReadPt(phys_page);
+
+		// reads go straight to memory, writes come through here
+		flags = old_pagehandler->flags & ~PFLAG_WRITEABLE;
+
+		MEM_SetPageHandler(phys_page, 1, this);
+	}
+
+	void Release()
+	{
+		// revert to the old handler, unless the page got another one
+		if (MEM_GetPageHandler(phys_page) == this)
+			MEM_SetPageHandler(phys_page, 1, old_pagehandler);
+		PAGING_ClearTLB();
+
+		Invalidate();
+		old_pagehandler = nullptr;
+	}
+
+	bool IsActive() const
+	{
+		return old_pagehandler != nullptr;
+	}
+
+	// the bytes an entry was decoded from, which invalidate the page's
+	// entries when they change
+	void AddDecodedBytes(const size_t page_index, const size_t num_bytes)
+	{
+		assert(page_index + num_bytes <= decoded_map.size());
+		memset(&decoded_map[page_index], 1, num_bytes);
+	}
+
+	void writeb(PhysPt addr, const uint8_t val) override
+	{
+		addr &= 4095;
+		if (host_readb(hostmem + addr) == val)
+			return;
+		host_writeb(hostmem + addr, val);
+		if (decoded_map[addr])
+			Invalidate();
+	}
+
+	void writew(PhysPt addr, const uint16_t val) override
+	{
+		addr &= 4095;
+		if (host_readw(hostmem + addr) == val)
+			return;
+		host_writew(hostmem + addr, val);
+		if (read_unaligned_uint16(&decoded_map[addr]))
+			Invalidate();
+	}
+
+	void writed(PhysPt addr, const uint32_t val) override
+	{
+		addr &= 4095;
+		if (host_readd(hostmem + addr) == val)
+			return;
+		host_writed(hostmem + addr, val);
+		if (read_unaligned_uint32(&decoded_map[addr]))
+			Invalidate();
+	}
+
+	HostPt GetHostReadPt(Bitu _phys_page) override
+	{
+		return old_pagehandler->GetHostReadPt(_phys_page);
+	}
+
+	// changes whenever the page's entries become invalid
+	uint32_t generation = 0;
+
+private:
+	void Invalidate()
+	{
+		++generation;
+		decoded_map.fill(0);
+	}
+
+	std::array<uint8_t, 4096> decoded_map = {};
+
+	PageHandler *old_pagehandler = nullptr;
+	HostPt hostmem = nullptr;
+	Bitu phys_page = 0;
+};
+
+struct DecodedInstruction {
+	PhysPt address           = 0;
+	DecodedPageHandler *page = nullptr;
+	uint32_t generation      = 0; // of the page when decoded
+	uint16_t opcode          = 0; // dispatch index, with the opcode page
+	uint8_t length           = 0; // up to and including the opcode
+	uint8_t prefixes         = 0;
+	uint8_t segment          = 0; // valid if has_segment is set
+	uint8_t rm               = 0; // valid if has_rm is set
+	bool has_segment         = false;
+	bool has_rm              = false;
+	bool rep_zero            = false;
+	bool code_big            = false;
+};
+
+static struct {
+	std::array<DecodedInstruction, decoded_cache_size> entries = {};
+	std::array<DecodedPageHandler, decoded_pages_size> pages   = {};
+	size_t next_page = 0; // the longest watched, reused next
+	bool enabled     = false;
+} decode_cache;
+
+static constexpr auto make_prefix_table()
+{
+	std::array<bool, 256> table = {};
+	for (const auto prefix :
+	     {0x0f, 0x26, 0x2e, 0x36, 0x3e, 0x64, 0x65, 0x66, 0x67, 0xf2, 0xf3}) {
+		table[prefix] = true;
+	}
+	return table;
+}
+
+static constexpr auto prefix_table = make_prefix_table();
+
+static inline bool is_prefix(const Bitu opcode)
+{
+	// Every byte after 0x0f belongs to the opcode
+	return !(opcode & OPCODE_0F) && prefix_table[opcode & 0xff];
+}
+
+static inline DecodedInstruction &get_decoded_entry(const PhysPt address)
+{
+	return decode_cache.entries[(address ^ (address >> 12)) &
+	                            (decoded_cache_size - 1)];
+}
+
+// Returns the watching handler of the page at the linear address, setting
+// one up if it's plain RAM
+static DecodedPageHandler *get_decoded_page(const PhysPt address)
+{
+	PageHandler *handler = get_tlb_readhandler(address);
+	if (const auto page = dynamic_cast<DecodedPageHandler *>(handler)) {
+		return page;
+	}
+	if (handler->flags != (PFLAG_READABLE | PFLAG_WRITEABLE)) {
+		return nullptr;
+	}
+	const Bitu lin_page = address >> 12;
+	Bitu phys_page      = lin_page;
+	if (!PAGING_MakePhysPage(phys_page)) {
+		return nullptr;
+	}
+
+	auto &page = decode_cache.pages[decode_cache.next_page];
+	decode_cache.next_page = (decode_cache.next_page + 1) % decoded_pages_size;
+	if (page.IsActive()) {
+		page.Release();
+	}
+	page.SetupAt(phys_page, handler);
+
+	// the TLB still holds a write pointer to the page
+	PAGING_UnlinkPages(lin_page, 1);
+	return &page;
+}
+
+// Called with the first prefix byte of the instruction at the address
+// fetched. On a hit, the decoder state is set up as if the prefixes and the
+// opcode were decoded, and the opcode is returned.
+static inline bool apply_decoded(const PhysPt address, Bitu &opcode)
+{
+	auto &entry = get_decoded_entry(address);
+	if (entry.address != address || entry.code_big != cpu.code.big ||
+	    get_tlb_readhandler(address) != entry.page ||
+	    entry.generation != entry.page->generation) {
+		return false;
+	}
+	core.opcode_index = entry.opcode & ~0xff;
+	core.prefixes     = entry.prefixes;
+	core.ea_table     = &EATable[(entry.prefixes & PREFIX_ADDR) * 256];
+	if (entry.prefixes & PREFIX_REP) {
+		core.rep_zero = entry.rep_zero;
+	}
+	if (entry.has_segment) {
+		const auto segment = static_cast<SegNames>(entry.segment);
+		BaseDS = SegBase(segment);
+		BaseSS = SegBase(segment);
+		core.base_val_ds = segment;
+	}
+	core.cseip   = address + entry.length;
+	core.decoded = &entry;
+	opcode       = entry.opcode;
+	return true;
+}
+
+// Called with the opcode following the prefixes of the instruction at the
+// address fetched
+static void record_decoded(const PhysPt address, const Bitu opcode)
+{
+	const auto length     = core.cseip - address;
+	const auto page_index = address & 4095;
+	// keep the ModRM byte in the same page as well
+	if (page_index + length >= 4096) {
+		return;
+	}
+	const auto page = get_decoded_page(address);
+	if (!page) {
+		return;
+	}
+	auto &entry = get_decoded_entry(address);
+
+	entry.address    = address;
+	entry.page       = page;
+	entry.generation = page->generation;
+	entry.opcode     = static_cast<uint16_t>(opcode);
+	entry.length     = static_cast<uint8_t>(length);
+	entry.prefixes   = static_cast<uint8_t>(core.prefixes);
+	entry.rep_zero   = core.rep_zero;
+	entry.code_big   = cpu.code.big;
+	entry.has_rm     = false;
+
+	entry.has_segment = false;
+	for (PhysPt i = 0; i + 1 < length; ++i) {
+		switch (LoadMb(address + i)) {
+		case 0x26: case 0x2e: case 0x36:
+		case 0x3e: case 0x64: case 0x65:
+			entry.has_segment = true;
+			entry.segment     = static_cast<uint8_t>(core.base_val_ds);
+			break;
+		}
+	}
+
+	page->AddDecodedBytes(page_index, length);
+	core.decoded = &entry;
+}
+
+// Fetches the ModRM byte, taking it from the entry of the instruction if
+// there is one
+static inline uint8_t FetchDecodedRM()
+{
+	const auto entry = core.decoded;
+	if (!entry || core.cseip != entry->address + entry->length) {
+		return Fetchb();
+	}
+	if (entry->has_rm) {
+		++core.cseip;
+		return entry->rm;
+	}
+	const auto rm = Fetchb();
+	entry->rm     = rm;
+	entry->has_rm = true;
+	entry->page->AddDecodedBytes((entry->address & 4095) + entry->length, 1);
+	return rm;
+}
@@ -133,7 +133,7 @@
 	{ inst(reg_eax,Fetchd(),LoadRd,SaveRd);}
 
 #define FPU_ESC(code) {														\
-	uint8_t rm=Fetchb();														\
+	uint8_t rm=FetchRM();													\
 	if (rm >= 0xc0) {															\
 		FPU_ESC ## code ## _Normal(rm);										\
 	} else {																\
@@ -141,21 +141,33 @@
 	}																		\
 }
 
+// the threaded build of the normal core also jumps to the cases directly,
+// through labels named after their opcode (see opcode_labels.h)
+#if CORE_NORMAL_THREADED
+#define OPCODE_LABEL(_NAME) op_ ## _NAME:
+#else
+#define OPCODE_LABEL(_NAME)
+#endif
+
 #define CASE_W(_WHICH)							\
-	case (OPCODE_NONE+_WHICH):
+	case (OPCODE_NONE+_WHICH):					\
+	OPCODE_LABEL(w_ ## _WHICH)
 
 #define CASE_D(_WHICH)							\
-	case (OPCODE_SIZE+_WHICH):
+	case (OPCODE_SIZE+_WHICH):					\
+	OPCODE_LABEL(d_ ## _WHICH)
 
 #define CASE_B(_WHICH)							\
 	CASE_W(_WHICH)								\
 	CASE_D(_WHICH)
 
 #define CASE_0F_W(_WHICH)						\
-	case ((OPCODE_0F|OPCODE_NONE)+_WHICH):
+	case ((OPCODE_0F|OPCODE_NONE)+_WHICH):		\
+	OPCODE_LABEL(0f_w_ ## _WHICH)
 
 #define CASE_0F_D(_WHICH)						\
-	case ((OPCODE_0F|OPCODE_SIZE)+_WHICH):
+	case ((OPCODE_0F|OPCODE_SIZE)+_WHICH):		\
+	OPCODE_LABEL(0f_d_ ## _WHICH)
 
 #define CASE_0F_B(_WHICH)						\
 	CASE_0F_W(_WHICH)							\
@@ -0,0 +1,229 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Jump table of the threaded normal core: one entry for every CASE_* label
+ * in the prefix_*.h files, spelled exactly like the case's opcode. Opcodes
+ * without an entry go through the switch, so a case missing from here only
+ * costs speed; an entry without a case fails to compile.
+ */
+
+// one-byte opcodes, 16-bit operand size
+OPCODE_LABEL_W(0x00) OPCODE_LABEL_W(0x01) OPCODE_LABEL_W(0x02) OPCODE_LABEL_W(0x03)
+OPCODE_LABEL_W(0x04) OPCODE_LABEL_W(0x05) OPCODE_LABEL_W(0x06) OPCODE_LABEL_W(0x07)
+OPCODE_LABEL_W(0x08) OPCODE_LABEL_W(0x09) OPCODE_LABEL_W(0x0a) OPCODE_LABEL_W(0x0b)
+OPCODE_LABEL_W(0x0c) OPCODE_LABEL_W(0x0d) OPCODE_LABEL_W(0x0e) OPCODE_LABEL_W(0x0f)
+OPCODE_LABEL_W(0x10) OPCODE_LABEL_W(0x11) OPCODE_LABEL_W(0x12) OPCODE_LABEL_W(0x13)
+OPCODE_LABEL_W(0x14) OPCODE_LABEL_W(0x15) OPCODE_LABEL_W(0x16) OPCODE_LABEL_W(0x17)
+OPCODE_LABEL_W(0x18) OPCODE_LABEL_W(0x19) OPCODE_LABEL_W(0x1a) OPCODE_LABEL_W(0x1b)
+OPCODE_LABEL_W(0x1c) OPCODE_LABEL_W(0x1d) OPCODE_LABEL_W(0x1e) OPCODE_LABEL_W(0x1f)
+OPCODE_LABEL_W(0x20) OPCODE_LABEL_W(0x21) OPCODE_LABEL_W(0x22) OPCODE_LABEL_W(0x23)
+OPCODE_LABEL_W(0x24) OPCODE_LABEL_W(0x25) OPCODE_LABEL_W(0x26) OPCODE_LABEL_W(0x27)
+OPCODE_LABEL_W(0x28) OPCODE_LABEL_W(0x29) OPCODE_LABEL_W(0x2a) OPCODE_LABEL_W(0x2b)
+OPCODE_LABEL_W(0x2c) OPCODE_LABEL_W(0x2d) OPCODE_LABEL_W(0x2e) OPCODE_LABEL_W(0x2f)
+OPCODE_LABEL_W(0x30) OPCODE_LABEL_W(0x31) OPCODE_LABEL_W(0x32) OPCODE_LABEL_W(0x33)
+OPCODE_LABEL_W(0x34) OPCODE_LABEL_W(0x35) OPCODE_LABEL_W(0x36) OPCODE_LABEL_W(0x37)
+OPCODE_LABEL_W(0x38) OPCODE_LABEL_W(0x39) OPCODE_LABEL_W(0x3a) OPCODE_LABEL_W(0x3b)
+OPCODE_LABEL_W(0x3c) OPCODE_LABEL_W(0x3d) OPCODE_LABEL_W(0x3e) OPCODE_LABEL_W(0x3f)
+OPCODE_LABEL_W(0x40) OPCODE_LABEL_W(0x41) OPCODE_LABEL_W(0x42) OPCODE_LABEL_W(0x43)
+OPCODE_LABEL_W(0x44) OPCODE_LABEL_W(0x45) OPCODE_LABEL_W(0x46) OPCODE_LABEL_W(0x47)
+OPCODE_LABEL_W(0x48) OPCODE_LABEL_W(0x49) OPCODE_LABEL_W(0x4a) OPCODE_LABEL_W(0x4b)
+OPCODE_LABEL_W(0x4c) OPCODE_LABEL_W(0x4d) OPCODE_LABEL_W(0x4e) OPCODE_LABEL_W(0x4f)
+OPCODE_LABEL_W(0x50) OPCODE_LABEL_W(0x51) OPCODE_LABEL_W(0x52) OPCODE_LABEL_W(0x53)
+OPCODE_LABEL_W(0x54) OPCODE_LABEL_W(0x55) OPCODE_LABEL_W(0x56) OPCODE_LABEL_W(0x57)
+OPCODE_LABEL_W(0x58) OPCODE_LABEL_W(0x59) OPCODE_LABEL_W(0x5a) OPCODE_LABEL_W(0x5b)
+OPCODE_LABEL_W(0x5c) OPCODE_LABEL_W(0x5d) OPCODE_LABEL_W(0x5e) OPCODE_LABEL_W(0x5f)
+OPCODE_LABEL_W(0x60) OPCODE_LABEL_W(0x61) OPCODE_LABEL_W(0x62) OPCODE_LABEL_W(0x63)
+OPCODE_LABEL_W(0x64) OPCODE_LABEL_W(0x65) OPCODE_LABEL_W(0x66) OPCODE_LABEL_W(0x67)
+OPCODE_LABEL_W(0x68) OPCODE_LABEL_W(0x69) OPCODE_LABEL_W(0x6a) OPCODE_LABEL_W(0x6b)
+OPCODE_LABEL_W(0x6c) OPCODE_LABEL_W(0x6d) OPCODE_LABEL_W(0x6e) OPCODE_LABEL_W(0x6f)
+OPCODE_LABEL_W(0x70) OPCODE_LABEL_W(0x71) OPCODE_LABEL_W(0x72) OPCODE_LABEL_W(0x73)
+OPCODE_LABEL_W(0x74) OPCODE_LABEL_W(0x75) OPCODE_LABEL_W(0x76) OPCODE_LABEL_W(0x77)
+OPCODE_LABEL_W(0x78) OPCODE_LABEL_W(0x79) OPCODE_LABEL_W(0x7a) OPCODE_LABEL_W(0x7b)
+OPCODE_LABEL_W(0x7c) OPCODE_LABEL_W(0x7d) OPCODE_LABEL_W(0x7e) OPCODE_LABEL_W(0x7f)
+OPCODE_LABEL_W(0x80) OPCODE_LABEL_W(0x81) OPCODE_LABEL_W(0x82) OPCODE_LABEL_W(0x83)
+OPCODE_LABEL_W(0x84) OPCODE_LABEL_W(0x85) OPCODE_LABEL_W(0x86) OPCODE_LABEL_W(0x87)
+OPCODE_LABEL_W(0x88) OPCODE_LABEL_W(0x89) OPCODE_LABEL_W(0x8a) OPCODE_LABEL_W(0x8b)
+OPCODE_LABEL_W(0x8c) OPCODE_LABEL_W(0x8d) OPCODE_LABEL_W(0x8e) OPCODE_LABEL_W(0x8f)
+OPCODE_LABEL_W(0x90) OPCODE_LABEL_W(0x91) OPCODE_LABEL_W(0x92) OPCODE_LABEL_W(0x93)
+OPCODE_LABEL_W(0x94) OPCODE_LABEL_W(0x95) OPCODE_LABEL_W(0x96) OPCODE_LABEL_W(0x97)
+OPCODE_LABEL_W(0x98) OPCODE_LABEL_W(0x99) OPCODE_LABEL_W(0x9a) OPCODE_LABEL_W(0x9b)
+OPCODE_LABEL_W(0x9c) OPCODE_LABEL_W(0x9d) OPCODE_LABEL_W(0x9e) OPCODE_LABEL_W(0x9f)
+OPCODE_LABEL_W(0xa0) OPCODE_LABEL_W(0xa1) OPCODE_LABEL_W(0xa2) OPCODE_LABEL_W(0xa3)
+OPCODE_LABEL_W(0xa4) OPCODE_LABEL_W(0xa5) OPCODE_LABEL_W(0xa6) OPCODE_LABEL_W(0xa7)
+OPCODE_LABEL_W(0xa8) OPCODE_LABEL_W(0xa9) OPCODE_LABEL_W(0xaa) OPCODE_LABEL_W(0xab)
+OPCODE_LABEL_W(0xac) OPCODE_LABEL_W(0xad) OPCODE_LABEL_W(0xae) OPCODE_LABEL_W(0xaf)
+OPCODE_LABEL_W(0xb0) OPCODE_LABEL_W(0xb1) OPCODE_LABEL_W(0xb2) OPCODE_LABEL_W(0xb3)
+OPCODE_LABEL_W(0xb4) OPCODE_LABEL_W(0xb5) OPCODE_LABEL_W(0xb6) OPCODE_LABEL_W(0xb7)
+OPCODE_LABEL_W(0xb8) OPCODE_LABEL_W(0xb9) OPCODE_LABEL_W(0xba) OPCODE_LABEL_W(0xbb)
+OPCODE_LABEL_W(0xbc) OPCODE_LABEL_W(0xbd) OPCODE_LABEL_W(0xbe) OPCODE_LABEL_W(0xbf)
+OPCODE_LABEL_W(0xc0) OPCODE_LABEL_W(0xc1) OPCODE_LABEL_W(0xc2) OPCODE_LABEL_W(0xc3)
+OPCODE_LABEL_W(0xc4) OPCODE_LABEL_W(0xc5) OPCODE_LABEL_W(0xc6) OPCODE_LABEL_W(0xc7)
+OPCODE_LABEL_W(0xc8) OPCODE_LABEL_W(0xc9) OPCODE_LABEL_W(0xca) OPCODE_LABEL_W(0xcb)
+OPCODE_LABEL_W(0xcc) OPCODE_LABEL_W(0xcd) OPCODE_LABEL_W(0xce) OPCODE_LABEL_W(0xcf)
+OPCODE_LABEL_W(0xd0) OPCODE_LABEL_W(0xd1) OPCODE_LABEL_W(0xd2) OPCODE_LABEL_W(0xd3)
+OPCODE_LABEL_W(0xd4) OPCODE_LABEL_W(0xd5) OPCODE_LABEL_W(0xd6) OPCODE_LABEL_W(0xd7)
+OPCODE_LABEL_W(0xd8) OPCODE_LABEL_W(0xd9) OPCODE_LABEL_W(0xda) OPCODE_LABEL_W(0xdb)
+OPCODE_LABEL_W(0xdc) OPCODE_LABEL_W(0xdd) OPCODE_LABEL_W(0xde) OPCODE_LABEL_W(0xdf)
+OPCODE_LABEL_W(0xe0) OPCODE_LABEL_W(0xe1) OPCODE_LABEL_W(0xe2) OPCODE_LABEL_W(0xe3)
+OPCODE_LABEL_W(0xe4) OPCODE_LABEL_W(0xe5) OPCODE_LABEL_W(0xe6) OPCODE_LABEL_W(0xe7)
+OPCODE_LABEL_W(0xe8) OPCODE_LABEL_W(0xe9) OPCODE_LABEL_W(0xea) OPCODE_LABEL_W(0xeb)
+OPCODE_LABEL_W(0xec) OPCODE_LABEL_W(0xed) OPCODE_LABEL_W(0xee) OPCODE_LABEL_W(0xef)
+OPCODE_LABEL_W(0xf0) OPCODE_LABEL_W(0xf1) OPCODE_LABEL_W(0xf2) OPCODE_LABEL_W(0xf3)
+OPCODE_LABEL_W(0xf4) OPCODE_LABEL_W(0xf5) OPCODE_LABEL_W(0xf6) OPCODE_LABEL_W(0xf7)
+OPCODE_LABEL_W(0xf8) OPCODE_LABEL_W(0xf9) OPCODE_LABEL_W(0xfa) OPCODE_LABEL_W(0xfb)
+OPCODE_LABEL_W(0xfc) OPCODE_LABEL_W(0xfd) OPCODE_LABEL_W(0xfe) OPCODE_LABEL_W(0xff)
+
+// two-byte opcodes, 16-bit operand size
+OPCODE_LABEL_0F_W(0x00) OPCODE_LABEL_0F_W(0x01) OPCODE_LABEL_0F_W(0x02) OPCODE_LABEL_0F_W(0x03)
+OPCODE_LABEL_0F_W(0x06) OPCODE_LABEL_0F_W(0x08) OPCODE_LABEL_0F_W(0x09) OPCODE_LABEL_0F_W(0x20)
+OPCODE_LABEL_0F_W(0x21) OPCODE_LABEL_0F_W(0x22) OPCODE_LABEL_0F_W(0x23) OPCODE_LABEL_0F_W(0x24)
+OPCODE_LABEL_0F_W(0x26) OPCODE_LABEL_0F_W(0x31) OPCODE_LABEL_0F_W(0x60) OPCODE_LABEL_0F_W(0x61)
+OPCODE_LABEL_0F_W(0x62) OPCODE_LABEL_0F_W(0x63) OPCODE_LABEL_0F_W(0x64) OPCODE_LABEL_0F_W(0x65)
+OPCODE_LABEL_0F_W(0x66) OPCODE_LABEL_0F_W(0x67) OPCODE_LABEL_0F_W(0x68) OPCODE_LABEL_0F_W(0x69)
+OPCODE_LABEL_0F_W(0x6A) OPCODE_LABEL_0F_W(0x6B) OPCODE_LABEL_0F_W(0x6e) OPCODE_LABEL_0F_W(0x6f)
+OPCODE_LABEL_0F_W(0x71) OPCODE_LABEL_0F_W(0x72) OPCODE_LABEL_0F_W(0x73) OPCODE_LABEL_0F_W(0x74)
+OPCODE_LABEL_0F_W(0x75) OPCODE_LABEL_0F_W(0x76) OPCODE_LABEL_0F_W(0x77) OPCODE_LABEL_0F_W(0x7e)
+OPCODE_LABEL_0F_W(0x7f) OPCODE_LABEL_0F_W(0x80) OPCODE_LABEL_0F_W(0x81) OPCODE_LABEL_0F_W(0x82)
+OPCODE_LABEL_0F_W(0x83) OPCODE_LABEL_0F_W(0x84) OPCODE_LABEL_0F_W(0x85) OPCODE_LABEL_0F_W(0x86)
+OPCODE_LABEL_0F_W(0x87) OPCODE_LABEL_0F_W(0x88) OPCODE_LABEL_0F_W(0x89) OPCODE_LABEL_0F_W(0x8a)
+OPCODE_LABEL_0F_W(0x8b) OPCODE_LABEL_0F_W(0x8c) OPCODE_LABEL_0F_W(0x8d) OPCODE_LABEL_0F_W(0x8e)
+OPCODE_LABEL_0F_W(0x8f) OPCODE_LABEL_0F_W(0x90) OPCODE_LABEL_0F_W(0x91) OPCODE_LABEL_0F_W(0x92)
+OPCODE_LABEL_0F_W(0x93) OPCODE_LABEL_0F_W(0x94) OPCODE_LABEL_0F_W(0x95) OPCODE_LABEL_0F_W(0x96)
+OPCODE_LABEL_0F_W(0x97) OPCODE_LABEL_0F_W(0x98) OPCODE_LABEL_0F_W(0x99) OPCODE_LABEL_0F_W(0x9a)
+OPCODE_LABEL_0F_W(0x9b) OPCODE_LABEL_0F_W(0x9c) OPCODE_LABEL_0F_W(0x9d) OPCODE_LABEL_0F_W(0x9e)
+OPCODE_LABEL_0F_W(0x9f) OPCODE_LABEL_0F_W(0xa0) OPCODE_LABEL_0F_W(0xa1) OPCODE_LABEL_0F_W(0xa2)
+OPCODE_LABEL_0F_W(0xa3) OPCODE_LABEL_0F_W(0xa4) OPCODE_LABEL_0F_W(0xa5) OPCODE_LABEL_0F_W(0xa8)
+OPCODE_LABEL_0F_W(0xa9) OPCODE_LABEL_0F_W(0xab) OPCODE_LABEL_0F_W(0xac) OPCODE_LABEL_0F_W(0xad)
+OPCODE_LABEL_0F_W(0xaf) OPCODE_LABEL_0F_W(0xb0) OPCODE_LABEL_0F_W(0xb1) OPCODE_LABEL_0F_W(0xb2)
+OPCODE_LABEL_0F_W(0xb3) OPCODE_LABEL_0F_W(0xb4) OPCODE_LABEL_0F_W(0xb5) OPCODE_LABEL_0F_W(0xb6)
+OPCODE_LABEL_0F_W(0xb7) OPCODE_LABEL_0F_W(0xba) OPCODE_LABEL_0F_W(0xbb) OPCODE_LABEL_0F_W(0xbc)
+OPCODE_LABEL_0F_W(0xbd) OPCODE_LABEL_0F_W(0xbe) OPCODE_LABEL_0F_W(0xbf) OPCODE_LABEL_0F_W(0xc0)
+OPCODE_LABEL_0F_W(0xc1) OPCODE_LABEL_0F_W(0xc8) OPCODE_LABEL_0F_W(0xc9) OPCODE_LABEL_0F_W(0xca)
+OPCODE_LABEL_0F_W(0xcb) OPCODE_LABEL_0F_W(0xcc) OPCODE_LABEL_0F_W(0xcd) OPCODE_LABEL_0F_W(0xce)
+OPCODE_LABEL_0F_W(0xcf) OPCODE_LABEL_0F_W(0xd1) OPCODE_LABEL_0F_W(0xd2) OPCODE_LABEL_0F_W(0xd3)
+OPCODE_LABEL_0F_W(0xD5) OPCODE_LABEL_0F_W(0xD8) OPCODE_LABEL_0F_W(0xD9) OPCODE_LABEL_0F_W(0xdb)
+OPCODE_LABEL_0F_W(0xDC) OPCODE_LABEL_0F_W(0xDD) OPCODE_LABEL_0F_W(0xdf) OPCODE_LABEL_0F_W(0xe1)
+OPCODE_LABEL_0F_W(0xe2) OPCODE_LABEL_0F_W(0xE5) OPCODE_LABEL_0F_W(0xE8) OPCODE_LABEL_0F_W(0xE9)
+OPCODE_LABEL_0F_W(0xeb) OPCODE_LABEL_0F_W(0xEC) OPCODE_LABEL_0F_W(0xED) OPCODE_LABEL_0F_W(0xef)
+OPCODE_LABEL_0F_W(0xf1) OPCODE_LABEL_0F_W(0xf2) OPCODE_LABEL_0F_W(0xf3) OPCODE_LABEL_0F_W(0xF5)
+OPCODE_LABEL_0F_W(0xF8) OPCODE_LABEL_0F_W(0xF9) OPCODE_LABEL_0F_W(0xFA) OPCODE_LABEL_0F_W(0xFC)
+OPCODE_LABEL_0F_W(0xFD) OPCODE_LABEL_0F_W(0xFE)
+
+// one-byte opcodes, 32-bit operand size
+OPCODE_LABEL_D(0x00) OPCODE_LABEL_D(0x01) OPCODE_LABEL_D(0x02) OPCODE_LABEL_D(0x03)
+OPCODE_LABEL_D(0x04) OPCODE_LABEL_D(0x05) OPCODE_LABEL_D(0x06) OPCODE_LABEL_D(0x07)
+OPCODE_LABEL_D(0x08) OPCODE_LABEL_D(0x09) OPCODE_LABEL_D(0x0a) OPCODE_LABEL_D(0x0b)
+OPCODE_LABEL_D(0x0c) OPCODE_LABEL_D(0x0d) OPCODE_LABEL_D(0x0e) OPCODE_LABEL_D(0x0f)
+OPCODE_LABEL_D(0x10) OPCODE_LABEL_D(0x11) OPCODE_LABEL_D(0x12) OPCODE_LABEL_D(0x13)
+OPCODE_LABEL_D(0x14) OPCODE_LABEL_D(0x15) OPCODE_LABEL_D(0x16) OPCODE_LABEL_D(0x17)
+OPCODE_LABEL_D(0x18) OPCODE_LABEL_D(0x19) OPCODE_LABEL_D(0x1a) OPCODE_LABEL_D(0x1b)
+OPCODE_LABEL_D(0x1c) OPCODE_LABEL_D(0x1d) OPCODE_LABEL_D(0x1e) OPCODE_LABEL_D(0x1f)
+OPCODE_LABEL_D(0x20) OPCODE_LABEL_D(0x21) OPCODE_LABEL_D(0x22) OPCODE_LABEL_D(0x23)
+OPCODE_LABEL_D(0x24) OPCODE_LABEL_D(0x25) OPCODE_LABEL_D(0x26) OPCODE_LABEL_D(0x27)
+OPCODE_LABEL_D(0x28) OPCODE_LABEL_D(0x29) OPCODE_LABEL_D(0x2a) OPCODE_LABEL_D(0x2b)
+OPCODE_LABEL_D(0x2c) OPCODE_LABEL_D(0x2d) OPCODE_LABEL_D(0x2e) OPCODE_LABEL_D(0x2f)
+OPCODE_LABEL_D(0x30) OPCODE_LABEL_D(0x31) OPCODE_LABEL_D(0x32) OPCODE_LABEL_D(0x33)
+OPCODE_LABEL_D(0x34) OPCODE_LABEL_D(0x35) OPCODE_LABEL_D(0x36) OPCODE_LABEL_D(0x37)
+OPCODE_LABEL_D(0x38) OPCODE_LABEL_D(0x39) OPCODE_LABEL_D(0x3a) OPCODE_LABEL_D(0x3b)
+OPCODE_LABEL_D(0x3c) OPCODE_LABEL_D(0x3d) OPCODE_LABEL_D(0x3e) OPCODE_LABEL_D(0x3f)
+OPCODE_LABEL_D(0x40) OPCODE_LABEL_D(0x41) OPCODE_LABEL_D(0x42) OPCODE_LABEL_D(0x43)
+OPCODE_LABEL_D(0x44) OPCODE_LABEL_D(0x45) OPCODE_LABEL_D(0x46) OPCODE_LABEL_D(0x47)
+OPCODE_LABEL_D(0x48) OPCODE_LABEL_D(0x49) OPCODE_LABEL_D(0x4a) OPCODE_LABEL_D(0x4b)
+OPCODE_LABEL_D(0x4c) OPCODE_LABEL_D(0x4d) OPCODE_LABEL_D(0x4e) OPCODE_LABEL_D(0x4f)
+OPCODE_LABEL_D(0x50) OPCODE_LABEL_D(0x51) OPCODE_LABEL_D(0x52) OPCODE_LABEL_D(0x53)
+OPCODE_LABEL_D(0x54) OPCODE_LABEL_D(0x55) OPCODE_LABEL_D(0x56) OPCODE_LABEL_D(0x57)
+OPCODE_LABEL_D(0x58) OPCODE_LABEL_D(0x59) OPCODE_LABEL_D(0x5a) OPCODE_LABEL_D(0x5b)
+OPCODE_LABEL_D(0x5c) OPCODE_LABEL_D(0x5d) OPCODE_LABEL_D(0x5e) OPCODE_LABEL_D(0x5f)
+OPCODE_LABEL_D(0x60) OPCODE_LABEL_D(0x61) OPCODE_LABEL_D(0x62) OPCODE_LABEL_D(0x63)
+OPCODE_LABEL_D(0x64) OPCODE_LABEL_D(0x65) OPCODE_LABEL_D(0x66) OPCODE_LABEL_D(0x67)
+OPCODE_LABEL_D(0x68) OPCODE_LABEL_D(0x69) OPCODE_LABEL_D(0x6a) OPCODE_LABEL_D(0x6b)
+OPCODE_LABEL_D(0x6c) OPCODE_LABEL_D(0x6d) OPCODE_LABEL_D(0x6e) OPCODE_LABEL_D(0x6f)
+OPCODE_LABEL_D(0x70) OPCODE_LABEL_D(0x71) OPCODE_LABEL_D(0x72) OPCODE_LABEL_D(0x73)
+OPCODE_LABEL_D(0x74) OPCODE_LABEL_D(0x75) OPCODE_LABEL_D(0x76) OPCODE_LABEL_D(0x77)
+OPCODE_LABEL_D(0x78) OPCODE_LABEL_D(0x79) OPCODE_LABEL_D(0x7a) OPCODE_LABEL_D(0x7b)
+OPCODE_LABEL_D(0x7c) OPCODE_LABEL_D(0x7d) OPCODE_LABEL_D(0x7e) OPCODE_LABEL_D(0x7f)
+OPCODE_LABEL_D(0x80) OPCODE_LABEL_D(0x81) OPCODE_LABEL_D(0x82) OPCODE_LABEL_D(0x83)
+OPCODE_LABEL_D(0x84) OPCODE_LABEL_D(0x85) OPCODE_LABEL_D(0x86) OPCODE_LABEL_D(0x87)
+OPCODE_LABEL_D(0x88) OPCODE_LABEL_D(0x89) OPCODE_LABEL_D(0x8a) OPCODE_LABEL_D(0x8b)
+OPCODE_LABEL_D(0x8c) OPCODE_LABEL_D(0x8d) OPCODE_LABEL_D(0x8e) OPCODE_LABEL_D(0x8f)
+OPCODE_LABEL_D(0x90) OPCODE_LABEL_D(0x91) OPCODE_LABEL_D(0x92) OPCODE_LABEL_D(0x93)
+OPCODE_LABEL_D(0x94) OPCODE_LABEL_D(0x95) OPCODE_LABEL_D(0x96) OPCODE_LABEL_D(0x97)
+OPCODE_LABEL_D(0x98) OPCODE_LABEL_D(0x99) OPCODE_LABEL_D(0x9a) OPCODE_LABEL_D(0x9b)
+OPCODE_LABEL_D(0x9c) OPCODE_LABEL_D(0x9d) OPCODE_LABEL_D(0x9e) OPCODE_LABEL_D(0x9f)
+OPCODE_LABEL_D(0xa0) OPCODE_LABEL_D(0xa1) OPCODE_LABEL_D(0xa2) OPCODE_LABEL_D(0xa3)
+OPCODE_LABEL_D(0xa4) OPCODE_LABEL_D(0xa5) OPCODE_LABEL_D(0xa6) OPCODE_LABEL_D(0xa7)
+OPCODE_LABEL_D(0xa8) OPCODE_LABEL_D(0xa9) OPCODE_LABEL_D(0xaa) OPCODE_LABEL_D(0xab)
+OPCODE_LABEL_D(0xac) OPCODE_LABEL_D(0xad) OPCODE_LABEL_D(0xae) OPCODE_LABEL_D(0xaf)
+OPCODE_LABEL_D(0xb0) OPCODE_LABEL_D(0xb1) OPCODE_LABEL_D(0xb2) OPCODE_LABEL_D(0xb3)
+OPCODE_LABEL_D(0xb4) OPCODE_LABEL_D(0xb5) OPCODE_LABEL_D(0xb6) OPCODE_LABEL_D(0xb7)
+OPCODE_LABEL_D(0xb8) OPCODE_LABEL_D(0xb9) OPCODE_LABEL_D(0xba) OPCODE_LABEL_D(0xbb)
+OPCODE_LABEL_D(0xbc) OPCODE_LABEL_D(0xbd) OPCODE_LABEL_D(0xbe) OPCODE_LABEL_D(0xbf)
+OPCODE_LABEL_D(0xc0) OPCODE_LABEL_D(0xc1) OPCODE_LABEL_D(0xc2) OPCODE_LABEL_D(0xc3)
+OPCODE_LABEL_D(0xc4) OPCODE_LABEL_D(0xc5) OPCODE_LABEL_D(0xc6) OPCODE_LABEL_D(0xc7)
+OPCODE_LABEL_D(0xc8) OPCODE_LABEL_D(0xc9) OPCODE_LABEL_D(0xca) OPCODE_LABEL_D(0xcb)
+OPCODE_LABEL_D(0xcc) OPCODE_LABEL_D(0xcd) OPCODE_LABEL_D(0xce) OPCODE_LABEL_D(0xcf)
+OPCODE_LABEL_D(0xd0) OPCODE_LABEL_D(0xd1) OPCODE_LABEL_D(0xd2) OPCODE_LABEL_D(0xd3)
+OPCODE_LABEL_D(0xd4) OPCODE_LABEL_D(0xd5) OPCODE_LABEL_D(0xd6) OPCODE_LABEL_D(0xd7)
+OPCODE_LABEL_D(0xd8) OPCODE_LABEL_D(0xd9) OPCODE_LABEL_D(0xda) OPCODE_LABEL_D(0xdb)
+OPCODE_LABEL_D(0xdc) OPCODE_LABEL_D(0xdd) OPCODE_LABEL_D(0xde) OPCODE_LABEL_D(0xdf)
+OPCODE_LABEL_D(0xe0) OPCODE_LABEL_D(0xe1) OPCODE_LABEL_D(0xe2) OPCODE_LABEL_D(0xe3)
+OPCODE_LABEL_D(0xe4) OPCODE_LABEL_D(0xe5) OPCODE_LABEL_D(0xe6) OPCODE_LABEL_D(0xe7)
+OPCODE_LABEL_D(0xe8) OPCODE_LABEL_D(0xe9) OPCODE_LABEL_D(0xea) OPCODE_LABEL_D(0xeb)
+OPCODE_LABEL_D(0xec) OPCODE_LABEL_D(0xed) OPCODE_LABEL_D(0xee) OPCODE_LABEL_D(0xef)
+OPCODE_LABEL_D(0xf0) OPCODE_LABEL_D(0xf1) OPCODE_LABEL_D(0xf2) OPCODE_LABEL_D(0xf3)
+OPCODE_LABEL_D(0xf4) OPCODE_LABEL_D(0xf5) OPCODE_LABEL_D(0xf6) OPCODE_LABEL_D(0xf7)
+OPCODE_LABEL_D(0xf8) OPCODE_LABEL_D(0xf9) OPCODE_LABEL_D(0xfa) OPCODE_LABEL_D(0xfb)
+OPCODE_LABEL_D(0xfc) OPCODE_LABEL_D(0xfd) OPCODE_LABEL_D(0xfe) OPCODE_LABEL_D(0xff)
+
+// two-byte opcodes, 32-bit operand size
+OPCODE_LABEL_0F_D(0x00) OPCODE_LABEL_0F_D(0x01) OPCODE_LABEL_0F_D(0x02) OPCODE_LABEL_0F_D(0x03)
+OPCODE_LABEL_0F_D(0x06) OPCODE_LABEL_0F_D(0x08) OPCODE_LABEL_0F_D(0x09) OPCODE_LABEL_0F_D(0x20)
+OPCODE_LABEL_0F_D(0x21) OPCODE_LABEL_0F_D(0x22) OPCODE_LABEL_0F_D(0x23) OPCODE_LABEL_0F_D(0x24)
+OPCODE_LABEL_0F_D(0x26) OPCODE_LABEL_0F_D(0x31) OPCODE_LABEL_0F_D(0x60) OPCODE_LABEL_0F_D(0x61)
+OPCODE_LABEL_0F_D(0x62) OPCODE_LABEL_0F_D(0x63) OPCODE_LABEL_0F_D(0x64) OPCODE_LABEL_0F_D(0x65)
+OPCODE_LABEL_0F_D(0x66) OPCODE_LABEL_0F_D(0x67) OPCODE_LABEL_0F_D(0x68) OPCODE_LABEL_0F_D(0x69)
+OPCODE_LABEL_0F_D(0x6A) OPCODE_LABEL_0F_D(0x6B) OPCODE_LABEL_0F_D(0x6e) OPCODE_LABEL_0F_D(0x6f)
+OPCODE_LABEL_0F_D(0x71) OPCODE_LABEL_0F_D(0x72) OPCODE_LABEL_0F_D(0x73) OPCODE_LABEL_0F_D(0x74)
+OPCODE_LABEL_0F_D(0x75) OPCODE_LABEL_0F_D(0x76) OPCODE_LABEL_0F_D(0x77) OPCODE_LABEL_0F_D(0x7e)
+OPCODE_LABEL_0F_D(0x7f) OPCODE_LABEL_0F_D(0x80) OPCODE_LABEL_0F_D(0x81) OPCODE_LABEL_0F_D(0x82)
+OPCODE_LABEL_0F_D(0x83) OPCODE_LABEL_0F_D(0x84) OPCODE_LABEL_0F_D(0x85) OPCODE_LABEL_0F_D(0x86)
+OPCODE_LABEL_0F_D(0x87) OPCODE_LABEL_0F_D(0x88) OPCODE_LABEL_0F_D(0x89) OPCODE_LABEL_0F_D(0x8a)
+OPCODE_LABEL_0F_D(0x8b) OPCODE_LABEL_0F_D(0x8c) OPCODE_LABEL_0F_D(0x8d) OPCODE_LABEL_0F_D(0x8e)
+OPCODE_LABEL_0F_D(0x8f) OPCODE_LABEL_0F_D(0x90) OPCODE_LABEL_0F_D(0x91) OPCODE_LABEL_0F_D(0x92)
+OPCODE_LABEL_0F_D(0x93) OPCODE_LABEL_0F_D(0x94) OPCODE_LABEL_0F_D(0x95) OPCODE_LABEL_0F_D(0x96)
+OPCODE_LABEL_0F_D(0x97) OPCODE_LABEL_0F_D(0x98) OPCODE_LABEL_0F_D(0x99) OPCODE_LABEL_0F_D(0x9a)
+OPCODE_LABEL_0F_D(0x9b) OPCODE_LABEL_0F_D(0x9c) OPCODE_LABEL_0F_D(0x9d) OPCODE_LABEL_0F_D(0x9e)
+OPCODE_LABEL_0F_D(0x9f) OPCODE_LABEL_0F_D(0xa0) OPCODE_LABEL_0F_D(0xa1) OPCODE_LABEL_0F_D(0xa2)
+OPCODE_LABEL_0F_D(0xa3) OPCODE_LABEL_0F_D(0xa4) OPCODE_LABEL_0F_D(0xa5) OPCODE_LABEL_0F_D(0xa8)
+OPCODE_LABEL_0F_D(0xa9) OPCODE_LABEL_0F_D(0xab) OPCODE_LABEL_0F_D(0xac) OPCODE_LABEL_0F_D(0xad)
+OPCODE_LABEL_0F_D(0xaf) OPCODE_LABEL_0F_D(0xb0) OPCODE_LABEL_0F_D(0xb1) OPCODE_LABEL_0F_D(0xb2)
+OPCODE_LABEL_0F_D(0xb3) OPCODE_LABEL_0F_D(0xb4) OPCODE_LABEL_0F_D(0xb5) OPCODE_LABEL_0F_D(0xb6)
+OPCODE_LABEL_0F_D(0xb7) OPCODE_LABEL_0F_D(0xba) OPCODE_LABEL_0F_D(0xbb) OPCODE_LABEL_0F_D(0xbc)
+OPCODE_LABEL_0F_D(0xbd) OPCODE_LABEL_0F_D(0xbe) OPCODE_LABEL_0F_D(0xbf) OPCODE_LABEL_0F_D(0xc0)
+OPCODE_LABEL_0F_D(0xc1) OPCODE_LABEL_0F_D(0xc8) OPCODE_LABEL_0F_D(0xc9) OPCODE_LABEL_0F_D(0xca)
+OPCODE_LABEL_0F_D(0xcb) OPCODE_LABEL_0F_D(0xcc) OPCODE_LABEL_0F_D(0xcd) OPCODE_LABEL_0F_D(0xce)
+OPCODE_LABEL_0F_D(0xcf) OPCODE_LABEL_0F_D(0xd1) OPCODE_LABEL_0F_D(0xd2) OPCODE_LABEL_0F_D(0xd3)
+OPCODE_LABEL_0F_D(0xD5) OPCODE_LABEL_0F_D(0xD8) OPCODE_LABEL_0F_D(0xD9) OPCODE_LABEL_0F_D(0xdb)
+OPCODE_LABEL_0F_D(0xDC) OPCODE_LABEL_0F_D(0xDD) OPCODE_LABEL_0F_D(0xdf) OPCODE_LABEL_0F_D(0xe1)
+OPCODE_LABEL_0F_D(0xe2) OPCODE_LABEL_0F_D(0xE5) OPCODE_LABEL_0F_D(0xE8) OPCODE_LABEL_0F_D(0xE9)
+OPCODE_LABEL_0F_D(0xeb) OPCODE_LABEL_0F_D(0xEC) OPCODE_LABEL_0F_D(0xED) OPCODE_LABEL_0F_D(0xef)
+OPCODE_LABEL_0F_D(0xf1) OPCODE_LABEL_0F_D(0xf2) OPCODE_LABEL_0F_D(0xf3) OPCODE_LABEL_0F_D(0xF5)
+OPCODE_LABEL_0F_D(0xF8) OPCODE_LABEL_0F_D(0xF9) OPCODE_LABEL_0F_D(0xFA) OPCODE_LABEL_0F_D(0xFC)
+OPCODE_LABEL_0F_D(0xFD) OPCODE_LABEL_0F_D(0xFE)
@@ -177,10 +177,7 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psllw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSLLW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xd1) // PSRLW Pq,Qq
@@ -197,10 +194,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psrlw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSRLW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xe1) // PSRAW Pq,Qq
@@ -217,10 +211,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psraw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSRAW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x71) // PSLLW/PSRLW/PSRAW Pq,Ib
@@ -234,24 +225,13 @@
 	        MMX_reg* dest = reg_mmx[rm & 7];
 	        switch (op) {
 	        case 0x06: // PSLLW
-	        {
-		        const auto dest_m = simde_m_from_int64(
-		                static_cast<int64_t>(dest->q));
-		        const auto res = simde_m_psllwi(dest_m, shift);
-		        dest->q = static_cast<uint64_t>(simde_m_to_int64(res));
-	        } break;
+		        dest->q = MMX_PSLLW(dest->q, shift);
+		        break;
 	        case 0x02: // PSRLW
-	        {
-		        const auto dest_m = simde_m_from_int64(
-		                static_cast<int64_t>(dest->q));
-		        const auto res = simde_m_psrlwi(dest_m, shift);
-		        dest->q = static_cast<uint64_t>(simde_m_to_int64(res));
-	        } break;
+		        dest->q = MMX_PSRLW(dest->q, shift);
+		        break;
 	        case 0x04: // PSRAW
-		        const auto dest_m = simde_m_from_int64(
-		                static_cast<int64_t>(dest->q));
-		        const auto res = simde_m_psrawi(dest_m, shift);
-		        dest->q = static_cast<uint64_t>(simde_m_to_int64(res));
+		        dest->q = MMX_PSRAW(dest->q, shift);
 		        break;
 	        }
 	        break;
@@ -270,10 +250,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_pslld(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSLLD(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xd2) // PSRLD Pq,Qq
@@ -290,10 +267,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psrld(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSRLD(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xe2) // PSRAD Pq,Qq
@@ -310,10 +284,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psrad(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSRAD(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x72) // PSLLD/PSRLD/PSRAD Pq,Ib
@@ -327,26 +298,14 @@
 	        MMX_reg* dest = reg_mmx[rm & 7];
 	        switch (op) {
 	        case 0x06: // PSLLD
-	        {
-		        const auto dest_m = simde_m_from_int64(
-		                static_cast<int64_t>(dest->q));
-		        const auto res = simde_m_pslldi(dest_m, shift);
-		        dest->q = static_cast<uint64_t>(simde_m_to_int64(res));
-	        } break;
+		        dest->q = MMX_PSLLD(dest->q, shift);
+		        break;
 	        case 0x02: // PSRLD
-	        {
-		        const auto dest_m = simde_m_from_int64(
-		                static_cast<int64_t>(dest->q));
-		        const auto res = simde_m_psrldi(dest_m, shift);
-		        dest->q = static_cast<uint64_t>(simde_m_to_int64(res));
-	        } break;
+		        dest->q = MMX_PSRLD(dest->q, shift);
+		        break;
 	        case 0x04: // PSRAD
-	        {
-		        const auto dest_m = simde_m_from_int64(
-		                static_cast<int64_t>(dest->q));
-		        const auto res = simde_m_psradi(dest_m, shift);
-		        dest->q = static_cast<uint64_t>(simde_m_to_int64(res));
-	        } break;
+		        dest->q = MMX_PSRAD(dest->q, shift);
+		        break;
 	        }
 	        break;
         }
@@ -364,10 +323,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psllq(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSLLQ(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xd3) // PSRLQ Pq,Qq
@@ -384,10 +340,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psrlq(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSRLQ(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x73) // PSLLQ/PSRLQ Pq,Ib
@@ -398,15 +351,10 @@
 	        GetRM;
 	        uint8_t shift = Fetchb();
 	        MMX_reg* dest = reg_mmx[rm & 7];
-	        if (shift > 63) {
-		        dest->q = 0;
+	        if (rm & 0x20) {
+		        dest->q = MMX_PSLLQ(dest->q, shift);
 	        } else {
-		        uint8_t op = rm & 0x20;
-		        if (op) {
-			        dest->q <<= shift;
-		        } else {
-			        dest->q >>= shift;
-		        }
+		        dest->q = MMX_PSRLQ(dest->q, shift);
 	        }
 	        break;
         }
@@ -426,10 +374,7 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_paddb(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PADDB(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xFD) // PADDW Pq,Qq
@@ -446,10 +391,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_paddw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PADDW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xFE) // PADDD Pq,Qq
@@ -466,10 +408,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_paddd(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PADDD(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xEC) // PADDSB Pq,Qq
@@ -486,10 +425,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_paddsb(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PADDSB(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xED) // PADDSW Pq,Qq
@@ -506,10 +442,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_paddsw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PADDSW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xDC) // PADDUSB Pq,Qq
@@ -526,10 +459,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_paddusb(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PADDUSB(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xDD) // PADDUSW Pq,Qq
@@ -546,10 +476,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_paddusw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PADDUSW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xF8) // PSUBB Pq,Qq
@@ -566,10 +493,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psubb(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSUBB(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xF9) // PSUBW Pq,Qq
@@ -586,10 +510,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psubw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSUBW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xFA) // PSUBD Pq,Qq
@@ -606,10 +527,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psubd(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSUBD(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xE8) // PSUBSB Pq,Qq
@@ -626,10 +544,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psubsb(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSUBSB(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xE9) // PSUBSW Pq,Qq
@@ -646,10 +561,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psubsw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSUBSW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xD8) // PSUBUSB Pq,Qq
@@ -666,10 +578,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psubusb(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSUBUSB(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xD9) // PSUBUSW Pq,Qq
@@ -686,10 +595,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_psubusw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PSUBUSW(dest->q, src.q);
 
 	        break;
         }
@@ -707,10 +613,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_pmulhw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PMULHW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xD5) // PMULLW Pq,Qq
@@ -727,10 +630,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_pmullw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PMULLW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0xF5) // PMADDWD Pq,Qq
@@ -747,10 +647,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_pmaddwd(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PMADDWD(dest->q, src.q);
 	        break;
         }
 
@@ -769,10 +666,7 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_pcmpeqb(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PCMPEQB(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x75) // PCMPEQW Pq,Qq
@@ -789,10 +683,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_pcmpeqw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PCMPEQW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x76) // PCMPEQD Pq,Qq
@@ -809,10 +700,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_pcmpeqd(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PCMPEQD(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x64) // PCMPGTB Pq,Qq
@@ -829,10 +717,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_pcmpgtb(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PCMPGTB(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x65) // PCMPGTW Pq,Qq
@@ -849,10 +734,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_pcmpgtw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PCMPGTW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x66) // PCMPGTD Pq,Qq
@@ -869,10 +751,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_pcmpgtd(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PCMPGTD(dest->q, src.q);
 	        break;
         }
 
@@ -891,10 +770,7 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_packsswb(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PACKSSWB(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x6B) // PACKSSDW Pq,Qq
@@ -911,10 +787,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_packssdw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PACKSSDW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x67) // PACKUSWB Pq,Qq
@@ -931,10 +804,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_packuswb(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PACKUSWB(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x68) // PUNPCKHBW Pq,Qq
@@ -951,10 +821,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_punpckhbw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PUNPCKHBW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x69) // PUNPCKHWD Pq,Qq
@@ -971,10 +838,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_punpckhwd(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PUNPCKHWD(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x6A) // PUNPCKHDQ Pq,Qq
@@ -991,10 +855,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_punpckhdq(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PUNPCKHDQ(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x60) // PUNPCKLBW Pq,Qq
@@ -1011,10 +872,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_punpcklbw(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PUNPCKLBW(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x61) // PUNPCKLWD Pq,Qq
@@ -1031,10 +889,7 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_punpcklwd(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PUNPCKLWD(dest->q, src.q);
 	        break;
         }
         CASE_0F_MMX(0x62) // PUNPCKLDQ Pq,Qq
@@ -1051,9 +906,6 @@
 		        GetEAa;
 		        src.q = LoadMq(eaa);
 	        }
-	        const auto src_m = simde_m_from_int64(static_cast<int64_t>(src.q));
-	        const auto dest_m = simde_m_from_int64(static_cast<int64_t>(dest->q));
-	        const auto res = simde_m_punpckldq(dest_m, src_m);
-	        dest->q        = static_cast<uint64_t>(simde_m_to_int64(res));
+	        dest->q = MMX_PUNPCKLDQ(dest->q, src.q);
 	        break;
         }
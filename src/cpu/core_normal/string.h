@@ -20,6 +20,150 @@
 
 #define LoadD(_BLAH) _BLAH
 
+// Block string operations
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// REP MOVS and REP STOS run in blocks of elements that stay within one page
+// of the source and of the destination, and that don't wrap the index
+// registers. A block whose pages have host pointers in the TLB is copied or
+// filled in host memory in one go. A block written to a page whose handler
+// takes block writes, such as the VGA window, is handed over in one call.
+//
+// Everything else returns 0 and runs one element at a time as before: pages
+// the TLB hasn't mapped yet, pages that would fault, ROM, MMIO, and pages
+// holding translated code. So page faults, self-modifying code checks, and
+// the heavy debugger's breakpoints behave exactly as they did. The cycles
+// for the whole repetition are still taken up front, so the interrupt window
+// is unchanged.
+
+#if C_DEBUG && C_HEAVY_DEBUG
+constexpr bool use_string_blocks = false;
+#else
+constexpr bool use_string_blocks = true;
+#endif
+
+// The number of elements, at most count, from the index onwards that stay
+// within the page and don't wrap the index
+static inline Bitu string_block_length(const PhysPt base, const uint32_t index,
+                                       const uint32_t add_mask,
+                                       const Bits add_index, const Bitu count)
+{
+	const auto size    = static_cast<uint64_t>(add_index > 0 ? add_index : -add_index);
+	const auto in_page = static_cast<uint64_t>((base + index) & (dos_pagesize - 1));
+
+	if (index + size - 1 > add_mask || in_page + size > dos_pagesize) {
+		return 0;
+	}
+	uint64_t length = 0;
+	if (add_index > 0) {
+		const auto to_end = std::min<uint64_t>(dos_pagesize - in_page,
+		                                       uint64_t(add_mask) - index + 1);
+		length = to_end / size;
+	} else {
+		length = std::min<uint64_t>(in_page, index) / size + 1;
+	}
+	return static_cast<Bitu>(std::min<uint64_t>(length, count));
+}
+
+// The lowest address a block of elements touches
+static inline PhysPt string_block_start(const PhysPt address, const Bits add_index,
+                                        const Bitu length)
+{
+	return add_index > 0 ? address
+	                     : address - static_cast<PhysPt>((length - 1) * -add_index);
+}
+
+template <typename T>
+static inline Bitu string_block_stos(const PhysPt di_base, const uint32_t di_index,
+                                     const uint32_t add_mask, const Bits add_index,
+                                     const Bitu count, const T val)
+{
+	if (!use_string_blocks) {
+		return 0;
+	}
+	const auto length = string_block_length(di_base, di_index, add_mask, add_index, count);
+	if (!length) {
+		return 0;
+	}
+	const auto start = string_block_start(di_base + di_index, add_index, length);
+
+	const auto write   = get_tlb_write(start);
+	const auto handler = get_tlb_writehandler(start);
+	if (!write && !(handler->flags & PFLAG_BLOCKWRITE)) {
+		return 0;
+	}
+
+	// The same value everywhere, so the order doesn't matter
+	uint8_t values[dos_pagesize];
+	const auto dest = write ? write + start : values;
+	if constexpr (sizeof(T) == 1) {
+		std::memset(dest, val, length);
+	} else {
+		for (Bitu i = 0; i < length; ++i) {
+			if constexpr (sizeof(T) == 2) {
+				host_writew(dest + i * 2, val);
+			} else {
+				host_writed(dest + i * 4, val);
+			}
+		}
+	}
+	if (!write) {
+		handler->writeblock(start, values, length, sizeof(T));
+	}
+	return length;
+}
+
+template <typename T>
+static inline Bitu string_block_movs(const PhysPt si_base, const uint32_t si_index,
+                                     const PhysPt di_base, const uint32_t di_index,
+                                     const uint32_t add_mask, const Bits add_index,
+                                     const Bitu count)
+{
+	if (!use_string_blocks) {
+		return 0;
+	}
+	const auto length = std::min(
+	        string_block_length(si_base, si_index, add_mask, add_index, count),
+	        string_block_length(di_base, di_index, add_mask, add_index, count));
+	if (!length) {
+		return 0;
+	}
+	const auto src = string_block_start(si_base + si_index, add_index, length);
+	const auto dest = string_block_start(di_base + di_index, add_index, length);
+
+	const auto read = get_tlb_read(src);
+	if (!read) {
+		return 0;
+	}
+	const auto from      = read + src;
+	const auto num_bytes = length * sizeof(T);
+
+	if (const auto write = get_tlb_write(dest)) {
+		const auto to = write + dest;
+
+		// Copying away from the overlap is a plain move. Copying into it
+		// repeats the elements copied so far, as on the CPU.
+		const bool overlaps = to < from + num_bytes && from < to + num_bytes;
+		const bool forward  = add_index > 0;
+		if (!overlaps || (forward && to <= from) || (!forward && to >= from)) {
+			std::memmove(to, from, num_bytes);
+		} else {
+			for (Bitu i = 0; i < length; ++i) {
+				const auto offset = (forward ? i : length - 1 - i) * sizeof(T);
+				T value;
+				std::memcpy(&value, from + offset, sizeof(T));
+				std::memcpy(to + offset, &value, sizeof(T));
+			}
+		}
+		return length;
+	}
+	const auto handler = get_tlb_writehandler(dest);
+	if (handler->flags & PFLAG_BLOCKWRITE) {
+		handler->writeblock(dest, from, length, sizeof(T));
+		return length;
+	}
+	return 0;
+}
+
 static void DoString(STRING_OP type) {
 	const auto si_base = BaseDS;
 	const auto di_base = SegBase(es);
@@ -92,46 +236,100 @@ static void DoString(STRING_OP type) {
 		}
 		break;
 	case R_STOSB:
-		for (;count>0;count--) {
+		for (;count>0;) {
+			const auto done = string_block_stos<uint8_t>(
+			        di_base, di_index, add_mask, add_index, count, reg_al);
+			if (done) {
+				di_index=(di_index+static_cast<uint32_t>(done*add_index)) & add_mask;
+				count-=done;
+				continue;
+			}
 			SaveMb(di_base+di_index,reg_al);
 			di_index=(di_index+add_index) & add_mask;
+			count--;
 		}
 		break;
 	case R_STOSW:
 		add_index *= 2;
-		for (;count>0;count--) {
+		for (;count>0;) {
+			const auto done = string_block_stos<uint16_t>(
+			        di_base, di_index, add_mask, add_index, count, reg_ax);
+			if (done) {
+				di_index=(di_index+static_cast<uint32_t>(done*add_index)) & add_mask;
+				count-=done;
+				continue;
+			}
 			SaveMw(di_base+di_index,reg_ax);
 			di_index=(di_index+add_index) & add_mask;
+			count--;
 		}
 		break;
 	case R_STOSD:
 		add_index *= 4;
-		for (;count>0;count--) {
+		for (;count>0;) {
+			const auto done = string_block_stos<uint32_t>(
+			        di_base, di_index, add_mask, add_index, count, reg_eax);
+			if (done) {
+				di_index=(di_index+static_cast<uint32_t>(done*add_index)) & add_mask;
+				count-=done;
+				continue;
+			}
 			SaveMd(di_base+di_index,reg_eax);
 			di_index=(di_index+add_index) & add_mask;
+			count--;
 		}
 		break;
 	case R_MOVSB:
-		for (;count>0;count--) {
+		for (;count>0;) {
+			const auto done = string_block_movs<uint8_t>(
+			        si_base, si_index, di_base, di_index, add_mask, add_index, count);
+			if (done) {
+				const auto advance = static_cast<uint32_t>(done*add_index);
+				di_index=(di_index+advance) & add_mask;
+				si_index=(si_index+advance) & add_mask;
+				count-=done;
+				continue;
+			}
 			SaveMb(di_base+di_index,LoadMb(si_base+si_index));
 			di_index=(di_index+add_index) & add_mask;
 			si_index=(si_index+add_index) & add_mask;
+			count--;
 		}
 		break;
 	case R_MOVSW:
 		add_index *= 2;
-		for (;count>0;count--) {
+		for (;count>0;) {
+			const auto done = string_block_movs<uint16_t>(
+			        si_base, si_index, di_base, di_index, add_mask, add_index, count);
+			if (done) {
+				const auto advance = static_cast<uint32_t>(done*add_index);
+				di_index=(di_index+advance) & add_mask;
+				si_index=(si_index+advance) & add_mask;
+				count-=done;
+				continue;
+			}
 			SaveMw(di_base+di_index,LoadMw(si_base+si_index));
 			di_index=(di_index+add_index) & add_mask;
 			si_index=(si_index+add_index) & add_mask;
+			count--;
 		}
 		break;
 	case R_MOVSD:
 		add_index *= 4;
-		for (;count>0;count--) {
+		for (;count>0;) {
+			const auto done = string_block_movs<uint32_t>(
+			        si_base, si_index, di_base, di_index, add_mask, add_index, count);
+			if (done) {
+				const auto advance = static_cast<uint32_t>(done*add_index);
+				di_index=(di_index+advance) & add_mask;
+				si_index=(si_index+advance) & add_mask;
+				count-=done;
+				continue;
+			}
 			SaveMd(di_base+di_index,LoadMd(si_base+si_index));
 			di_index=(di_index+add_index) & add_mask;
 			si_index=(si_index+add_index) & add_mask;
+			count--;
 		}
 		break;
 	case R_LODSB:
@@ -19,9 +19,6 @@
 
 #include <cstdio>
 
-// Needed for std::isnan in simde
-#include <cmath>
-
 #include "callback.h"
 #include "cpu.h"
 #include "dosbox.h"
@@ -30,11 +27,10 @@
 #include "lazyflags.h"
 #include "mem.h"
 #include "mmx.h"
+#include "mmx_ops.h"
 #include "paging.h"
 #include "pic.h"
 
-#include "simde/x86/mmx.h"
-
 #if C_DEBUG
 #include "debug.h"
 #endif
@@ -38,6 +38,10 @@
 #include "support.h"
 #include "video.h"
 
+#if (C_DYNAMIC_X86) || (C_DYNREC)
+#include "dyn_cache_store.h"
+#endif
+
 #if 1
 #undef LOG
 #if defined (_MSC_VER)
@@ -2241,13 +2245,8 @@ static void CPU_CycleDecrease(bool pressed) {
 	}
 }
 
-extern int64_t ticksDone;
-extern int64_t ticksScheduled;
-
 void CPU_Reset_AutoAdjust(void) {
-	CPU_IODelayRemoved = 0;
-	ticksDone = 0;
-	ticksScheduled = 0;
+	DOSBOX_ResetAutoCycles();
 }
 
 class CPU final : public Module_base {
@@ -2307,6 +2306,11 @@ public:
 		CPU_Core_Dyn_X86_Init();
 #elif (C_DYNREC)
 		CPU_Core_Dynrec_Init();
+#endif
+#if (C_DYNAMIC_X86) || (C_DYNREC)
+		const auto section = static_cast<Section_prop *>(configuration);
+		DYNCACHE_InitStore(section->Get_bool("dynamic_core_cache"));
+		DYNCACHE_SetMaxSize(section->Get_int("dynamic_core_memsize"));
 #endif
 		MAPPER_AddHandler(CPU_CycleDecrease, SDL_SCANCODE_F11,
 		                  PRIMARY_MOD, "cycledown", "Dec Cycles");
@@ -2473,6 +2477,11 @@ public:
 			CPU_ArchitectureType = ArchitectureType::PentiumMmx;
 		}
 
+		// Only when no dynamic core can take over, as their code pages
+		// would hide the writes from the decoded instruction cache
+		CPU_Core_Normal_Cache_Init(cpudecoder == &CPU_Core_Normal_Run &&
+		                           !(CPU_AutoDetermineMode & CPU_AUTODETERMINE_CORE));
+
 		if (CPU_ArchitectureType>=ArchitectureType::Intel486NewSlow) CPU_extflags_toggle=(FLAG_ID|FLAG_AC);
 		else if (CPU_ArchitectureType>=ArchitectureType::Intel486OldSlow) CPU_extflags_toggle=(FLAG_AC);
 		else CPU_extflags_toggle=0;
@@ -2493,6 +2502,10 @@ public:
 static CPU * test;
 
 void CPU_ShutDown([[maybe_unused]] Section* sec) {
+	CPU_Core_Normal_Cache_Close();
+#if (C_DYNAMIC_X86) || (C_DYNREC)
+	DYNCACHE_SaveStore();
+#endif
 #if (C_DYNAMIC_X86)
 	CPU_Core_Dyn_X86_Cache_Close();
 #elif (C_DYNREC)
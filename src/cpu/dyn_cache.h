@@ -19,13 +19,21 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
+#include <chrono>
+#include <memory>
 #include <new>
+#include <optional>
 #include <type_traits>
+#include <unordered_map>
 
+#include "dyn_cache_store.h"
 #include "mem_unaligned.h"
 #include "paging.h"
+#include "timer.h"
+#include "tracy.h"
 #include "types.h"
 
 #if defined(HAVE_MMAP)
@@ -116,6 +124,21 @@ public:
 	} link[2] = {};                // maximum two links (conditional jumps)
 
 	CacheBlock* crossblock = {};
+
+	// execution profile, used by the dynrec core to form superblocks
+	struct Trace {
+		uint32_t exits[2]   = {}; // how often each link path was taken
+		uint32_t side_exits = 0;  // how often a superblock was left early
+		uint8_t dissolves   = 0;  // how often its superblocks were dissolved
+		bool is_superblock  = false;
+	} trace = {};
+
+	// set when the block is entered, cleared when the allocator passes
+	// it over instead of evicting it (second-chance replacement)
+	bool referenced = false;
+
+	// translated from the persistent store and not entered yet
+	bool restored = false;
 };
 
 static_assert(std::is_standard_layout_v<CacheBlock::Page>, "standard-layout is required for offsetof");
@@ -151,9 +174,61 @@ static uint8_t* cache_code_start_ptr   = {};
 static uint8_t* cache_code             = {};
 static uint8_t* cache_code_link_blocks = {};
 
-static std::vector<CacheBlock> cache_blocks(CACHE_BLOCKS);
+// the cache blocks are allocated in chunks as they're needed; they must not
+// move as the generated code holds pointers to them
+static std::vector<std::unique_ptr<CacheBlock[]>> cache_block_chunks = {};
 static CacheBlock link_blocks[2] = {}; // default linking (specially marked)
 
+// The code cache starts small and doubles in size whenever the allocator
+// wraps around too quickly, up to the configured maximum. The region is
+// reserved for the maximum size up-front; POSIX hosts only back the pages
+// that have been written to, while on Windows the cache is committed as it
+// grows (see cache_commit).
+constexpr int64_t cache_grow_period_ms = 30000;
+
+static struct {
+	size_t limit   = CACHE_TOTAL; // bytes currently in use for code
+	size_t maximum = CACHE_TOTAL; // limit can grow up to this size
+
+	int64_t last_wrap_ms = 0;
+
+	struct Counters {
+		int64_t fills          = 0; // blocks translated
+		int64_t evictions      = 0; // blocks dropped to make room
+		int64_t invalidations  = 0; // blocks dropped by code writes
+		int64_t second_chances = 0; // recently used blocks kept
+		int64_t wraps          = 0;
+		int64_t grows          = 0;
+		int64_t demotions      = 0; // pages left to the interpreter
+	};
+	Counters totals      = {};
+	Counters last_second = {}; // totals at the last plotted second
+	Counters per_second  = {};
+
+	int tick_count = 0;
+} cache_usage = {};
+
+// Pages whose code keeps being rewritten (typically code and variables that
+// share a page) are translated again after every write. When a page gets
+// too many of its blocks invalidated in a second, it's left to the normal
+// core for a while instead, for longer with every further demotion.
+constexpr int cache_smc_demote_threshold   = 64;
+constexpr int64_t cache_smc_demote_ms      = 250;
+constexpr int64_t cache_smc_max_demote_ms  = 8000;
+
+// invalidation history of a guest physical page; unlike the code page
+// handlers, it's kept when the page stops holding code
+struct SmcPageRecord {
+	int64_t invalidations = 0; // blocks cleared by writes, in total
+	int demotions         = 0;
+
+	int64_t window_start_ms  = 0;
+	int window_invalidations = 0;
+	int64_t demoted_until_ms = 0;
+};
+
+static std::unordered_map<Bitu, SmcPageRecord> cache_smc_pages = {};
+
 // the CodePageHandler class provides access to the contained
 // cache blocks and intercepts writes to the code for special treatment
 class CodePageHandler final : public PageHandler {
@@ -185,6 +260,41 @@ public:
 			delete [] invalidation_map;
 			invalidation_map = nullptr;
 		}
+
+		is_demoted = false;
+		if (!cache_smc_pages.empty()) {
+			const auto record = cache_smc_pages.find(phys_page);
+			is_demoted = (record != cache_smc_pages.end()) &&
+			             (GetTicks() < record->second.demoted_until_ms);
+		}
+
+		// look up the blocks translated for this content in earlier
+		// sessions; they're restored from the run loop, as this can
+		// be reached in the middle of translating another block
+		content_hash   = 0;
+		restore_blocks = nullptr;
+		current_hash.reset();
+		if (DYNCACHE_IsStoreEnabled()) {
+			if (const auto hash = CurrentHash(); hash) {
+				content_hash   = *hash;
+				restore_blocks = DYNCACHE_FindStoredPage(content_hash);
+			}
+		}
+	}
+
+	// hash of the page's current content, if it has host memory; it's
+	// kept until the page is next written to, so the page isn't hashed
+	// again for every block translated in it
+	std::optional<uint64_t> CurrentHash()
+	{
+		if (!current_hash) {
+			const auto host_page = old_pagehandler->GetHostReadPt(phys_page);
+			if (!host_page) {
+				return {};
+			}
+			current_hash = DYNCACHE_HashPage(host_page);
+		}
+		return current_hash;
 	}
 
 	// clear out blocks that contain code which has been modified
@@ -195,6 +305,8 @@ public:
 		                               // modified, it has to be exited
 		                               // as soon as possible
 
+		int num_cleared = 0;
+
 		uint32_t ip_point=SegPhys(cs)+reg_eip;
 		ip_point = (PAGING_GetPhysicalPage(ip_point) -
 		            check_cast<uint32_t>(phys_page << 12)) +
@@ -204,7 +316,7 @@ public:
 			// see if there is still some code in the range
 			for (Bitu count=start;count<=end;count++) map+=write_map[count];
 			if (!map)
-				return is_current_block; // no more code, finished
+				break; // no more code, finished
 
 			CacheBlock *block = hash_map[index];
 			while (block) {
@@ -212,6 +324,7 @@ public:
 				// test if this block is in the range
 				if (start<=block->page.end && end>=block->page.start) {
 					if (ip_point<=block->page.end && ip_point>=block->page.start) is_current_block=true;
+					num_cleared++;
 					block->Clear(); // clear the block,
 					                // decrements the
 					                // write_map accordingly
@@ -220,9 +333,55 @@ public:
 			}
 			index--;
 		}
+		if (num_cleared)
+			CountInvalidations(num_cleared);
 		return is_current_block;
 	}
 
+	// keep track of the code rewrites in this page, and demote it to the
+	// interpreter if they become too frequent
+	void CountInvalidations(const int num_blocks)
+	{
+		cache_usage.totals.invalidations += num_blocks;
+
+		auto &record = cache_smc_pages[phys_page];
+		record.invalidations += num_blocks;
+
+		const auto now = GetTicks();
+		if (now - record.window_start_ms >= 1000) {
+			record.window_start_ms      = now;
+			record.window_invalidations = 0;
+		}
+		record.window_invalidations += num_blocks;
+		if (record.window_invalidations < cache_smc_demote_threshold)
+			return;
+
+		const auto duration = std::min(cache_smc_demote_ms << std::min(record.demotions, 5),
+		                               cache_smc_max_demote_ms);
+		record.demoted_until_ms     = now + duration;
+		record.window_invalidations = 0;
+		record.demotions++;
+		cache_usage.totals.demotions++;
+		is_demoted = true;
+	}
+
+	// true while the page's code is left to the interpreter; checked by
+	// the run loops before they look for a block in this page
+	bool IsDemoted()
+	{
+		if (!is_demoted)
+			return false;
+		if (GetTicks() >= cache_smc_pages[phys_page].demoted_until_ms) {
+			is_demoted = false;
+			return false;
+		}
+		// drop the remaining blocks, so they can't be reached through
+		// the links of blocks in other pages either
+		if (active_blocks)
+			ClearBlocks();
+		return true;
+	}
+
 	uint8_t *alloc_invalidation_map() const
 	{
 		constexpr size_t map_size = 4096;
@@ -248,6 +407,7 @@ public:
 		addr&=4095;
 		if (host_readb(hostmem + addr) == val)
 			return;
+		current_hash.reset();
 		host_writeb(hostmem + addr, val);
 		// see if there's code where we are writing to
 		if (!write_map[addr]) {
@@ -276,6 +436,7 @@ public:
 		addr&=4095;
 		if (host_readw(hostmem + addr) == val)
 			return;
+		current_hash.reset();
 		host_writew(hostmem + addr, val);
 		// see if there's code where we are writing to
 		if (!read_unaligned_uint16(&write_map[addr])) {
@@ -304,6 +465,7 @@ public:
 		addr&=4095;
 		if (host_readd(hostmem + addr) == val)
 			return;
+		current_hash.reset();
 		host_writed(hostmem + addr, val);
 		// see if there's code where we are writing to
 		if (!read_unaligned_uint32(&write_map[addr])) {
@@ -332,6 +494,7 @@ public:
 		addr&=4095;
 		if (host_readb(hostmem + addr) == val)
 			return false;
+		current_hash.reset();
 		// see if there's code where we are writing to
 		if (!write_map[addr]) {
 			if (!active_blocks) {
@@ -365,6 +528,7 @@ public:
 		addr&=4095;
 		if (host_readw(hostmem + addr) == val)
 			return false;
+		current_hash.reset();
 		// see if there's code where we are writing to
 		if (!read_unaligned_uint16(&write_map[addr])) {
 			if (!active_blocks) {
@@ -398,6 +562,7 @@ public:
 		addr&=4095;
 		if (host_readd(hostmem + addr) == val)
 			return false;
+		current_hash.reset();
 		// see if there's code where we are writing to
 		if (!read_unaligned_uint32(&write_map[addr])) {
 			if (!active_blocks) {
@@ -502,7 +667,7 @@ public:
 		prev=nullptr;
 	}
 
-	void ClearRelease()
+	void ClearBlocks()
 	{
 		// clear out all cache blocks in this page
 		Bitu count=active_blocks;
@@ -515,6 +680,14 @@ public:
 			block->Clear();
 			block=nextblock;
 		}
+		active_blocks=0;
+		memset(&hash_map,0,sizeof(hash_map));
+		memset(&write_map,0,sizeof(write_map));
+	}
+
+	void ClearRelease()
+	{
+		ClearBlocks();
 		Release(); // now can release this page
 	}
 
@@ -547,6 +720,11 @@ public:
 	uint8_t write_map[4096] = {};
 	uint8_t *invalidation_map = nullptr;
 
+	// hash of the page content when it became a code page, and the
+	// blocks from the persistent store still waiting to be translated
+	uint64_t content_hash = 0;
+	const dyn_cache_stored_blocks_t *restore_blocks = nullptr;
+
 	CodePageHandler *prev = nullptr;
 	CodePageHandler *next = nullptr;
 
@@ -559,8 +737,12 @@ private:
 	Bitu active_blocks = 0; // the number of cache blocks in this page
 	Bitu active_count = 0;  // delaying parameter to not immediately release
 	                        // a page
+	bool is_demoted = false; // code is run by the interpreter for now
 	HostPt hostmem = nullptr;
 	Bitu phys_page = 0;
+
+	// hash of the current content, reset by every write that changes it
+	std::optional<uint64_t> current_hash = {};
 };
 
 static inline void cache_add_unused_block(CacheBlock *block)
@@ -570,12 +752,23 @@ static inline void cache_add_unused_block(CacheBlock *block)
 	cache.block.free = block;
 }
 
+static void cache_add_blocks(const size_t count)
+{
+	auto chunk = std::make_unique<CacheBlock[]>(count);
+	for (size_t i=0;i<count;i++) {
+		chunk[i].link[0].to = (CacheBlock *)1;
+		chunk[i].link[1].to = (CacheBlock *)1;
+		cache_add_unused_block(&chunk[i]);
+	}
+	cache_block_chunks.push_back(std::move(chunk));
+}
+
 static CacheBlock *cache_getblock()
 {
 	// get a free cache block and advance the free pointer
+	if (!cache.block.free)
+		cache_add_blocks(CACHE_BLOCKS/8);
 	CacheBlock *ret = cache.block.free;
-	if (!ret)
-		E_Exit("Ran out of CacheBlocks");
 	cache.block.free=ret->cache.next;
 	ret->cache.next=nullptr;
 	return ret;
@@ -704,14 +897,86 @@ void CacheBlock::Clear()
 	cache.DeleteWriteMask();
 }
 
+static void cache_commit(size_t from_limit, size_t to_limit);
+
+// grow the cache behind the given last block of the list, returns false if
+// it's already at its maximum size
+static bool cache_grow(CacheBlock *last)
+{
+	const auto new_limit = std::min(cache_usage.limit * 2, cache_usage.maximum);
+	if (new_limit < cache_usage.limit + 2 * CACHE_MAXSIZE)
+		return false;
+	cache_commit(cache_usage.limit, new_limit);
+	CacheBlock *tail = last->cache.next;
+	if (!tail) {
+		// the last block can have been written past the end of the
+		// cache, so the new space starts behind the spare area
+		tail = cache_getblock();
+		tail->cache.start = cache_code + cache_usage.limit + CACHE_MAXSIZE;
+		last->cache.size = (Bitu)(tail->cache.start - last->cache.start);
+		last->cache.next = tail;
+	}
+	tail->cache.size = (Bitu)(cache_code + new_limit - tail->cache.start);
+	cache_usage.limit = new_limit;
+	cache_usage.totals.grows++;
+	cache.block.active = tail;
+	LOG_MSG("DYNCACHE: Grew the code cache to %d MB",
+	        static_cast<int>(new_limit / (1024 * 1024)));
+	return true;
+}
+
+// make the block following the given one the active block, restarting at the
+// beginning of the cache (or growing it) when the end is reached
+static void cache_advance(CacheBlock *block)
+{
+#if (C_DYNAMIC_X86)
+	const bool cache_is_full = !block->cache.next;
+#elif (C_DYNREC)
+	const uint8_t *limit = (cache_code + cache_usage.limit - CACHE_MAXSIZE);
+	const bool cache_is_full = (!block->cache.next ||
+	                            (block->cache.next->cache.start > limit));
+#endif
+	if (!cache_is_full) {
+		cache.block.active=block->cache.next;
+		return;
+	}
+	// the code is being replaced faster than it should; grow instead
+	const auto now = GetTicks();
+	const bool is_thrashing = (now - cache_usage.last_wrap_ms) < cache_grow_period_ms;
+	cache_usage.last_wrap_ms = now;
+	if (is_thrashing && cache_grow(block))
+		return;
+	// LOG_DEBUG("Cache full; restarting");
+	cache_usage.totals.wraps++;
+	cache.block.active=cache.block.first;
+}
+
+// the most blocks the allocator skips before it evicts one regardless
+#define CACHE_MAX_CHANCES (8)
+
 static CacheBlock *cache_openblock()
 {
 	CacheBlock *block = cache.block.active;
+	// approximate LRU: blocks that were entered since the allocator last
+	// came by are kept, and the following ones are tried instead
+	for (int chances=0;chances<CACHE_MAX_CHANCES;chances++) {
+		if (!block->referenced || !block->page.handler)
+			break;
+		block->referenced=false;
+		cache_usage.totals.second_chances++;
+		cache_advance(block);
+		block=cache.block.active;
+	}
+	cache_usage.totals.fills++;
 	// check for enough space in this block
 	Bitu size=block->cache.size;
 	CacheBlock *nextblock = block->cache.next;
-	if (block->page.handler)
+	if (block->page.handler) {
+		cache_usage.totals.evictions++;
 		block->Clear();
+	}
+	block->referenced=false;
+	block->restored=false;
 	// block size must be at least CACHE_MAXSIZE
 	while (size<CACHE_MAXSIZE) {
 		if (!nextblock)
@@ -719,8 +984,10 @@ static CacheBlock *cache_openblock()
 		// merge blocks
 		size+=nextblock->cache.size;
 		CacheBlock *tempblock = nextblock->cache.next;
-		if (nextblock->page.handler)
+		if (nextblock->page.handler) {
+			cache_usage.totals.evictions++;
 			nextblock->Clear();
+		}
 		// block is free now
 		cache_add_unused_block(nextblock);
 		nextblock=tempblock;
@@ -770,18 +1037,100 @@ static void cache_closeblock()
 		}
 	}
 	// advance the active block pointer
-#if (C_DYNAMIC_X86)
-	const bool cache_is_full = !block->cache.next;
-#elif (C_DYNREC)
-	const uint8_t *limit = (cache_code_start_ptr + CACHE_TOTAL - CACHE_MAXSIZE);
-	const bool cache_is_full = (!block->cache.next ||
-	                            (block->cache.next->cache.start > limit));
-#endif
-	if (cache_is_full) {
-		// LOG_DEBUG("Cache full; restarting");
-		cache.block.active=cache.block.first;
-	} else {
-		cache.block.active=block->cache.next;
+	cache_advance(block);
+}
+
+// mark the block as recently used; blocks that are entered through a direct
+// link don't pass the dispatcher, so the link targets are marked as well
+static inline void cache_mark_referenced(CacheBlock *block)
+{
+	block->referenced=true;
+	block->link[0].to->referenced=true;
+	block->link[1].to->referenced=true;
+}
+
+static CacheBlock *CreateCacheBlock(CodePageHandler *codepage, PhysPt start,
+                                    Bitu max_opcodes);
+
+// translate the blocks the persistent store knows for this page's content,
+// so they're present (and can be linked to) before they are first reached
+static void cache_restore_blocks(CodePageHandler *codepage, const PhysPt ip_point)
+{
+	const auto stored_blocks = codepage->restore_blocks;
+	codepage->restore_blocks = nullptr;
+
+	// the stored entry points are only valid for the content they were
+	// recorded with, and the page may have been written to since it
+	// became a code page
+	if (codepage->CurrentHash() != codepage->content_hash) {
+		DYNCACHE_CountChangedPage();
+		return;
+	}
+
+	const auto start_us = GetTicksUs();
+	const auto cpu_mode = DYNCACHE_GetCpuMode();
+	const auto page_base = ip_point & ~static_cast<PhysPt>(0xfff);
+
+	int restored = 0;
+	int skipped  = 0;
+	for (const auto &stored : *stored_blocks) {
+		if (stored.cpu_mode != cpu_mode) {
+			++skipped;
+			continue;
+		}
+		if (codepage->FindCacheBlock(stored.start)) {
+			continue;
+		}
+		// only blocks that ended in this page were stored, so the
+		// decoder won't cross into (and fault on) the next page
+		auto block = CreateCacheBlock(codepage, page_base + stored.start, 32);
+		if (block) {
+			block->restored = true;
+		}
+		++restored;
+	}
+	DYNCACHE_CountRestoredBlocks(restored, skipped, GetTicksUsSince(start_us));
+}
+
+// remember the block for the persistent store, if it lies within one page
+static void cache_store_block(const CacheBlock *block)
+{
+	if (!block || block->crossblock || !block->page.handler) {
+		return;
+	}
+	// the block was decoded from the page's current content, which can
+	// differ from its content when it became a code page
+	const auto page_hash = block->page.handler->CurrentHash();
+	if (!page_hash) {
+		return;
+	}
+	DYNCACHE_StoreBlock(*page_hash,
+	                    static_cast<uint16_t>(block->page.start),
+	                    DYNCACHE_GetCpuMode());
+}
+
+// translate the block the run loop reached; with the persistent store, the
+// block is recorded and the translation timed, to weigh up the restoring
+static CacheBlock *cache_translate_block(CodePageHandler *codepage, const PhysPt ip_point)
+{
+	if (!DYNCACHE_IsStoreEnabled()) {
+		return CreateCacheBlock(codepage, ip_point, 32);
+	}
+	const auto start = std::chrono::steady_clock::now();
+	auto block = CreateCacheBlock(codepage, ip_point, 32);
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	DYNCACHE_CountTranslatedBlock(
+	        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	cache_store_block(block);
+	return block;
+}
+
+// count the restored blocks that execution actually reached
+static inline void cache_note_block_found(CacheBlock *block)
+{
+	if (block && block->restored) {
+		block->restored = false;
+		DYNCACHE_CountRestoredBlockUse();
 	}
 }
 
@@ -857,7 +1206,33 @@ static void cache_block_before_close();
 static void cache_block_closing(const uint8_t *block_start, Bitu block_size);
 #endif
 
-static constexpr size_t cache_code_size = CACHE_TOTAL + CACHE_MAXSIZE + host_pagesize - 1 + host_pagesize;
+static size_t cache_code_size()
+{
+	return cache_usage.maximum + CACHE_MAXSIZE + host_pagesize - 1 + host_pagesize;
+}
+
+// Windows doesn't back reserved memory on first use, so the part of the
+// cache a limit adds (with the spare area behind it) is committed when the
+// cache grows to it. Pages that are already committed are left alone, as
+// committing them again would reset their protection.
+static void cache_commit([[maybe_unused]] const size_t from_limit,
+                         [[maybe_unused]] const size_t to_limit)
+{
+#if defined(WIN32)
+	// the first commit covers the alignment and the link blocks' page
+	const auto start = from_limit ? cache_code + from_limit + CACHE_MAXSIZE
+	                              : cache_code_start_ptr;
+	const auto end = cache_code + to_limit + CACHE_MAXSIZE;
+	assert(end <= cache_code_start_ptr + cache_code_size());
+
+	const auto protection = CPU_UseRwxMemProtect ? PAGE_EXECUTE_READWRITE
+	                                             : PAGE_READWRITE;
+	if (!VirtualAlloc(start, static_cast<size_t>(end - start), MEM_COMMIT, protection)) {
+		E_Exit("DYNCACHE: Failed committing %d MB of cache memory",
+		       static_cast<int>(to_limit / (1024 * 1024)));
+	}
+#endif
+}
 constexpr bool is_64bit_platform = sizeof(void *) == 8;
 
 static inline void dyn_mem_adjust(void *&ptr, size_t &size)
@@ -965,6 +1340,30 @@ static inline void dyn_cache_invalidate([[maybe_unused]] void *ptr,
 #endif
 }
 
+static void cache_usage_tick()
+{
+	if (++cache_usage.tick_count < 1000)
+		return;
+	cache_usage.tick_count = 0;
+
+	const auto &now  = cache_usage.totals;
+	const auto &then = cache_usage.last_second;
+	auto &rate       = cache_usage.per_second;
+
+	rate.fills          = now.fills - then.fills;
+	rate.evictions      = now.evictions - then.evictions;
+	rate.invalidations  = now.invalidations - then.invalidations;
+	rate.second_chances = now.second_chances - then.second_chances;
+	rate.wraps          = now.wraps - then.wraps;
+	rate.grows          = now.grows - then.grows;
+	cache_usage.last_second = now;
+
+	TracyPlot("DYNCACHE fills/s", rate.fills);
+	TracyPlot("DYNCACHE evictions/s", rate.evictions);
+	TracyPlot("DYNCACHE invalidations/s", rate.invalidations);
+	TracyPlot("DYNCACHE size (KB)", static_cast<int64_t>(cache_usage.limit / 1024));
+}
+
 static bool cache_initialized = false;
 
 static void cache_init(bool enable) {
@@ -974,27 +1373,16 @@ static void cache_init(bool enable) {
 			return;
 		}
 		cache_initialized = true;
-		cache.block.free = &cache_blocks[0];
-		// initialize the cache blocks
-		for (int i=0;i<CACHE_BLOCKS-1;i++) {
-			cache_blocks[i].link[0].to = (CacheBlock *)1;
-			cache_blocks[i].link[1].to = (CacheBlock *)1;
-			cache_blocks[i].cache.next = &cache_blocks[i + 1];
-		}
 		if (cache_code_start_ptr == nullptr) {
 			// allocate the code cache memory
 #if defined (WIN32)
-			LPVOID lp_vmem = nullptr;
-			if (CPU_UseRwxMemProtect) {
-				lp_vmem = VirtualAlloc(nullptr, cache_code_size,
-				                       MEM_COMMIT,
-				                       PAGE_EXECUTE_READWRITE); // all operations allowed
-			} else {
-				lp_vmem = VirtualAlloc(nullptr, cache_code_size,
-				                       MEM_COMMIT | MEM_RESERVE,
-				                       PAGE_READWRITE); // needs on-going management
+			// only reserved for the maximum size, committed by cache_commit
+			LPVOID lp_vmem = VirtualAlloc(nullptr, cache_code_size(),
+			                              MEM_RESERVE,
+			                              PAGE_NOACCESS);
+			if (!lp_vmem) {
+				E_Exit("DYNCACHE: Failed reserving cache memory");
 			}
-			assert(lp_vmem);
 			cache_code_start_ptr = static_cast<uint8_t *>(lp_vmem);
 #elif defined(HAVE_MMAP)
 			int map_flags = MAP_PRIVATE | MAP_ANON;
@@ -1002,12 +1390,12 @@ static void cache_init(bool enable) {
 #if defined(HAVE_MAP_JIT)
 			map_flags |= MAP_JIT;
 #endif
-			cache_code_start_ptr=static_cast<uint8_t *>(mmap(nullptr, cache_code_size, prot_flags, map_flags, -1, 0));
+			cache_code_start_ptr=static_cast<uint8_t *>(mmap(nullptr, cache_code_size(), prot_flags, map_flags, -1, 0));
 			if (cache_code_start_ptr == MAP_FAILED) {
 				E_Exit("DYNCACHE: Failed memory-mapping cache memory because: %s", strerror(errno));
 			}
 #else
-			cache_code_start_ptr=static_cast<uint8_t *>(malloc(cache_code_size));
+			cache_code_start_ptr=static_cast<uint8_t *>(malloc(cache_code_size()));
 			if (!cache_code_start_ptr) {
 				E_Exit("DYNCACHE: Failed allocating cache memory because: %s", strerror(errno));
 			}
@@ -1019,12 +1407,16 @@ static void cache_init(bool enable) {
 
 			cache_code_link_blocks=cache_code;
 			cache_code=cache_code+host_pagesize;
+			cache_commit(0, cache_usage.limit);
 			CacheBlock *block = cache_getblock();
 			cache.block.first=block;
 			cache.block.active=block;
 			block->cache.start=&cache_code[0];
-			block->cache.size=CACHE_TOTAL;
+			block->cache.size=cache_usage.limit;
 			block->cache.next = nullptr; // last block in the list
+
+			cache_usage.last_wrap_ms = GetTicks();
+			TIMER_AddTickHandler(&cache_usage_tick);
 		}
 
 		auto cache_addr = static_cast<void *>(cache_code);
@@ -1084,6 +1476,68 @@ static void cache_init(bool enable) {
 	}
 }
 
+void DYNCACHE_SetMaxSize(const int size_mb)
+{
+	// the cache memory is reserved once, at its maximum size
+	if (cache_code_start_ptr)
+		return;
+	const auto size = static_cast<size_t>(size_mb) * 1024 * 1024;
+	cache_usage.maximum = std::max(size, static_cast<size_t>(CACHE_TOTAL));
+}
+
+void DYNCACHE_LogStats()
+{
+	if (!cache_initialized) {
+		LOG(LOG_MISC,LOG_ERROR)("DYNCACHE: The dynamic core hasn't been used");
+		return;
+	}
+	const auto &total = cache_usage.totals;
+	const auto &rate  = cache_usage.per_second;
+
+	size_t num_blocks = 0;
+	for (const CacheBlock *block = cache.block.first; block; block = block->cache.next)
+		if (block->page.handler)
+			num_blocks++;
+
+	LOG(LOG_MISC,LOG_ERROR)("DYNCACHE: Size %d of %d KB, %d blocks, grown %d times, wrapped %d times",
+	                        static_cast<int>(cache_usage.limit / 1024),
+	                        static_cast<int>(cache_usage.maximum / 1024),
+	                        static_cast<int>(num_blocks),
+	                        static_cast<int>(total.grows),
+	                        static_cast<int>(total.wraps));
+	LOG(LOG_MISC,LOG_ERROR)("DYNCACHE: Totals: %lld fills, %lld evictions, %lld invalidations, %lld second chances",
+	                        static_cast<long long>(total.fills),
+	                        static_cast<long long>(total.evictions),
+	                        static_cast<long long>(total.invalidations),
+	                        static_cast<long long>(total.second_chances));
+	LOG(LOG_MISC,LOG_ERROR)("DYNCACHE: Last second: %lld fills, %lld evictions, %lld invalidations, %lld second chances",
+	                        static_cast<long long>(rate.fills),
+	                        static_cast<long long>(rate.evictions),
+	                        static_cast<long long>(rate.invalidations),
+	                        static_cast<long long>(rate.second_chances));
+
+	// the pages with the most code rewrites
+	std::vector<std::pair<Bitu, const SmcPageRecord *>> pages = {};
+	for (const auto &[phys_page, record] : cache_smc_pages)
+		pages.emplace_back(phys_page, &record);
+	const auto num_shown = std::min(pages.size(), static_cast<size_t>(8));
+	std::partial_sort(pages.begin(), pages.begin() + num_shown, pages.end(),
+	                  [](const auto &a, const auto &b) {
+		                  return a.second->invalidations > b.second->invalidations;
+	                  });
+
+	LOG(LOG_MISC,LOG_ERROR)("DYNCACHE: %lld pages demoted to the interpreter, most rewritten pages:",
+	                        static_cast<long long>(total.demotions));
+	for (size_t i = 0; i < num_shown; ++i) {
+		const auto &[phys_page, record] = pages[i];
+		LOG(LOG_MISC,LOG_ERROR)("DYNCACHE:   %08x: %lld blocks invalidated, demoted %d times%s",
+		                        static_cast<uint32_t>(phys_page << 12),
+		                        static_cast<long long>(record->invalidations),
+		                        record->demotions,
+		                        (GetTicks() < record->demoted_until_ms) ? " (now)" : "");
+	}
+}
+
 static void cache_close(void) {
 /*	for (;;) {
 		if (cache.used_pages) {
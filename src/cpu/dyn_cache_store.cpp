@@ -0,0 +1,342 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "dosbox.h"
+
+#if (C_DYNAMIC_X86) || (C_DYNREC)
+
+#include "dyn_cache_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include "cpu.h"
+#include "cross.h"
+#include "regs.h"
+
+#define XXH_INLINE_ALL 1
+#include "decoders/xxhash.h"
+
+// Bump when the file layout or the meaning of the CPU mode bits changes
+constexpr char store_magic[8]        = {'D', 'B', 'D', 'Y', 'N', 'C', 'S', '1'};
+constexpr uint32_t store_version     = 1;
+constexpr const char *store_filename = "dynamic_core_cache.bin";
+
+// Keeps the file from growing forever as titles come and go. Pages seen in
+// the current session are written first.
+constexpr size_t max_stored_blocks = 256 * 1024;
+
+// Block boundaries are decided by the core's decoder, so each core keeps its
+// own map
+#if C_DYNAMIC_X86
+constexpr uint32_t store_core_id = 1;
+#else
+constexpr uint32_t store_core_id = 2;
+#endif
+
+struct StoredPage {
+	dyn_cache_stored_blocks_t blocks = {};
+	bool seen_this_session           = false;
+};
+
+static struct {
+	bool enabled = false;
+
+	std::unordered_map<uint64_t, StoredPage> pages = {};
+
+	struct {
+		int64_t page_lookups    = 0;
+		int64_t page_hits       = 0;
+		int64_t blocks_loaded   = 0;
+		int64_t blocks_recorded = 0;
+		int64_t blocks_restored = 0;
+		int64_t blocks_skipped  = 0;
+		int64_t restore_us      = 0;
+		int64_t pages_changed   = 0;
+		int64_t blocks_used     = 0;
+		int64_t translated      = 0;
+		int64_t translate_ns    = 0;
+		bool file_discarded     = false;
+	} counters = {};
+} store = {};
+
+// File layout, in host byte order:
+//   header:  magic, version, core id, record count, XXH64 of the records
+//   records: page hash (8 bytes), block start (2 bytes), CPU mode (1 byte),
+//            padding (1 byte)
+struct StoreHeader {
+	char magic[8]          = {};
+	uint32_t version       = 0;
+	uint32_t core_id       = 0;
+	uint64_t record_count  = 0;
+	uint64_t records_hash  = 0;
+};
+
+constexpr size_t record_size = sizeof(uint64_t) + sizeof(uint16_t) +
+                               sizeof(uint8_t) + sizeof(uint8_t);
+
+static std_fs::path get_store_path()
+{
+	return GetConfigDir() / store_filename;
+}
+
+static bool load_store(const std_fs::path &path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	StoreHeader header = {};
+	if (!file.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+		return false;
+	}
+	if (memcmp(header.magic, store_magic, sizeof(store_magic)) != 0 ||
+	    header.version != store_version || header.core_id != store_core_id ||
+	    header.record_count > max_stored_blocks) {
+		return false;
+	}
+
+	std::vector<uint8_t> records(header.record_count * record_size);
+	if (!file.read(reinterpret_cast<char *>(records.data()),
+	               static_cast<std::streamsize>(records.size()))) {
+		return false;
+	}
+	if (XXH64(records.data(), records.size(), 0) != header.records_hash) {
+		return false;
+	}
+
+	for (size_t offset = 0; offset < records.size(); offset += record_size) {
+		uint64_t page_hash = 0;
+		uint16_t start     = 0;
+		memcpy(&page_hash, &records[offset], sizeof(page_hash));
+		memcpy(&start, &records[offset + sizeof(page_hash)], sizeof(start));
+		const auto cpu_mode = records[offset + sizeof(page_hash) + sizeof(start)];
+
+		// Offsets past the end of a page can only come from a damaged file
+		if (start >= 4096) {
+			store.pages.clear();
+			return false;
+		}
+		store.pages[page_hash].blocks.push_back({start, cpu_mode});
+	}
+	store.counters.blocks_loaded = static_cast<int64_t>(header.record_count);
+	return true;
+}
+
+static void save_store(const std_fs::path &path)
+{
+	// Pages seen in this session go first, so they survive the size cap
+	std::vector<const std::pair<const uint64_t, StoredPage> *> ordered = {};
+	ordered.reserve(store.pages.size());
+	for (const auto &page : store.pages) {
+		ordered.push_back(&page);
+	}
+	std::stable_partition(ordered.begin(), ordered.end(), [](const auto page) {
+		return page->second.seen_this_session;
+	});
+
+	std::vector<uint8_t> records = {};
+	for (const auto page : ordered) {
+		const auto &[page_hash, stored] = *page;
+		if ((records.size() / record_size) + stored.blocks.size() >
+		    max_stored_blocks) {
+			break;
+		}
+		for (const auto &block : stored.blocks) {
+			const auto offset = records.size();
+			records.resize(offset + record_size, 0);
+			memcpy(&records[offset], &page_hash, sizeof(page_hash));
+			memcpy(&records[offset + sizeof(page_hash)],
+			       &block.start,
+			       sizeof(block.start));
+			records[offset + sizeof(page_hash) + sizeof(block.start)] = block.cpu_mode;
+		}
+	}
+
+	StoreHeader header = {};
+	memcpy(header.magic, store_magic, sizeof(store_magic));
+	header.version      = store_version;
+	header.core_id      = store_core_id;
+	header.record_count = records.size() / record_size;
+	header.records_hash = XXH64(records.data(), records.size(), 0);
+
+	// Best-effort: if the file can't be written, the next session simply
+	// starts cold
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		LOG_WARNING("DYNCACHE: Can't write the translation map to '%s'",
+		            path.string().c_str());
+		return;
+	}
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char *>(records.data()),
+	           static_cast<std::streamsize>(records.size()));
+}
+
+void DYNCACHE_InitStore(const bool enabled)
+{
+	store.pages.clear();
+	store.counters = {};
+	store.enabled  = enabled;
+	if (!enabled) {
+		return;
+	}
+
+	const auto path = get_store_path();
+	if (!load_store(path)) {
+		store.pages.clear();
+		store.counters.file_discarded = std_fs::exists(path);
+	}
+	if (store.counters.file_discarded) {
+		LOG_MSG("DYNCACHE: Discarded the translation map in '%s' as it failed validation",
+		        path.string().c_str());
+	} else {
+		LOG_MSG("DYNCACHE: Loaded %lld translated block entry points for %d pages",
+		        static_cast<long long>(store.counters.blocks_loaded),
+		        static_cast<int>(store.pages.size()));
+	}
+}
+
+void DYNCACHE_SaveStore()
+{
+	if (!store.enabled) {
+		return;
+	}
+	save_store(get_store_path());
+
+	const auto &c = store.counters;
+
+	const auto hit_rate = c.page_lookups
+	                            ? 100.0 * static_cast<double>(c.page_hits) /
+	                                      static_cast<double>(c.page_lookups)
+	                            : 0.0;
+
+	LOG_MSG("DYNCACHE: %lld of %lld code pages matched the translation map (%.1f%% hit rate)",
+	        static_cast<long long>(c.page_hits),
+	        static_cast<long long>(c.page_lookups),
+	        hit_rate);
+	LOG_MSG("DYNCACHE: Restored %lld blocks ahead of execution in %.2f ms, "
+	        "skipped %lld translated in another CPU mode, recorded %lld new blocks",
+	        static_cast<long long>(c.blocks_restored),
+	        static_cast<double>(c.restore_us) / 1000.0,
+	        static_cast<long long>(c.blocks_skipped),
+	        static_cast<long long>(c.blocks_recorded));
+
+	// Each restored block that was reached spared one translation at the
+	// time it was reached, as measured for the blocks translated on demand
+	if (c.translated > 0) {
+		const auto translate_us = static_cast<double>(c.translate_ns) /
+		                          static_cast<double>(c.translated) / 1000.0;
+		const auto spared_us = translate_us * static_cast<double>(c.blocks_used);
+		const auto saved_us = spared_us - static_cast<double>(c.restore_us);
+
+		LOG_MSG("DYNCACHE: %lld restored blocks were run, sparing %.2f ms of "
+		        "on-demand translation (%.2f us per block): %.2f ms startup time saved",
+		        static_cast<long long>(c.blocks_used),
+		        spared_us / 1000.0,
+		        translate_us,
+		        saved_us / 1000.0);
+	}
+	if (c.pages_changed > 0) {
+		LOG_MSG("DYNCACHE: Dropped the stored blocks of %lld pages modified before they ran",
+		        static_cast<long long>(c.pages_changed));
+	}
+
+	store.enabled = false;
+	store.pages.clear();
+}
+
+bool DYNCACHE_IsStoreEnabled()
+{
+	return store.enabled;
+}
+
+uint64_t DYNCACHE_HashPage(const uint8_t *page)
+{
+	return XXH64(page, 4096, 0);
+}
+
+uint8_t DYNCACHE_GetCpuMode()
+{
+	uint8_t mode = 0;
+	mode |= cpu.code.big ? 0b0000'0001 : 0;
+	mode |= cpu.pmode ? 0b0000'0010 : 0;
+	mode |= (reg_flags & FLAG_VM) ? 0b0000'0100 : 0;
+	mode |= static_cast<uint8_t>((cpu.cpl & 0b11) << 3);
+	return mode;
+}
+
+const dyn_cache_stored_blocks_t *DYNCACHE_FindStoredPage(const uint64_t page_hash)
+{
+	++store.counters.page_lookups;
+
+	const auto it = store.pages.find(page_hash);
+	if (it == store.pages.end() || it->second.blocks.empty()) {
+		return nullptr;
+	}
+	++store.counters.page_hits;
+	it->second.seen_this_session = true;
+	return &it->second.blocks;
+}
+
+void DYNCACHE_StoreBlock(const uint64_t page_hash, const uint16_t start,
+                         const uint8_t cpu_mode)
+{
+	auto &page = store.pages[page_hash];
+	page.seen_this_session = true;
+
+	const auto already_stored = std::any_of(
+	        page.blocks.begin(), page.blocks.end(), [=](const auto &block) {
+		        return block.start == start && block.cpu_mode == cpu_mode;
+	        });
+	if (!already_stored) {
+		page.blocks.push_back({start, cpu_mode});
+		++store.counters.blocks_recorded;
+	}
+}
+
+void DYNCACHE_CountRestoredBlocks(const int restored, const int skipped,
+                                  const int64_t elapsed_us)
+{
+	store.counters.blocks_restored += restored;
+	store.counters.blocks_skipped += skipped;
+	store.counters.restore_us += elapsed_us;
+}
+
+void DYNCACHE_CountChangedPage()
+{
+	++store.counters.pages_changed;
+}
+
+void DYNCACHE_CountTranslatedBlock(const int64_t elapsed_ns)
+{
+	++store.counters.translated;
+	store.counters.translate_ns += elapsed_ns;
+}
+
+void DYNCACHE_CountRestoredBlockUse()
+{
+	++store.counters.blocks_used;
+}
+
+#endif
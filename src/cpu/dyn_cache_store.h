@@ -0,0 +1,81 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_DYN_CACHE_STORE_H
+#define DOSBOX_DYN_CACHE_STORE_H
+
+#include <cstdint>
+#include <vector>
+
+// Persistent translation map for the dynamic cores
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The host code produced by the recompilers embeds absolute host addresses
+// (the register file, helper functions, and pointers straight into guest
+// RAM for unmodified immediates), so it can't be reused by another process.
+// What does carry over between sessions is where the guest code's blocks
+// start. The store remembers, per guest code page, the block entry points
+// that were translated and the CPU mode they were translated in.
+//
+// Pages are identified by a hash of their 4 KB content, which also
+// validates them: if a title loads the same code again, the page hashes
+// match and its known blocks are translated in one batch as soon as the
+// page becomes a code page. Those blocks can then be linked directly instead
+// of each one bouncing through the dispatcher when it's first reached.
+
+struct DynCacheStoredBlock {
+	uint16_t start   = 0; // offset of the block's first byte in the page
+	uint8_t cpu_mode = 0; // see DYNCACHE_GetCpuMode()
+};
+
+using dyn_cache_stored_blocks_t = std::vector<DynCacheStoredBlock>;
+
+// Loads the store from the config directory if enabled, otherwise leaves it
+// empty and inactive.
+void DYNCACHE_InitStore(bool enabled);
+
+// Writes the store back to disk and logs its counters.
+void DYNCACHE_SaveStore();
+
+bool DYNCACHE_IsStoreEnabled();
+
+uint64_t DYNCACHE_HashPage(const uint8_t *page);
+
+// The decoder's output depends on the code size, the protection mode, the
+// privilege level, and V86 mode, so these are packed into one value.
+uint8_t DYNCACHE_GetCpuMode();
+
+// Returns the blocks previously translated in a page with this content, or
+// nullptr if the page wasn't seen before.
+const dyn_cache_stored_blocks_t *DYNCACHE_FindStoredPage(uint64_t page_hash);
+
+void DYNCACHE_StoreBlock(uint64_t page_hash, uint16_t start, uint8_t cpu_mode);
+
+void DYNCACHE_CountRestoredBlocks(int restored, int skipped, int64_t elapsed_us);
+
+// A page whose content changed between becoming a code page and reaching
+// its stored blocks; they're dropped rather than decoded at stale offsets.
+void DYNCACHE_CountChangedPage();
+
+// The cost of translating blocks when they're reached and how many of the
+// restored blocks were reached give the startup time the store saved.
+void DYNCACHE_CountTranslatedBlock(int64_t elapsed_ns);
+void DYNCACHE_CountRestoredBlockUse();
+
+#endif
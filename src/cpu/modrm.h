@@ -23,8 +23,13 @@ extern uint8_t  * lookupRMEAregb[256];
 extern uint16_t * lookupRMEAregw[256];
 extern uint32_t * lookupRMEAregd[256];
 
+// cores can take the ModRM byte from somewhere else than memory
+#ifndef FetchRM
+#define FetchRM Fetchb
+#endif
+
 #define GetRM												\
-	uint8_t rm=Fetchb();
+	uint8_t rm=FetchRM();
 
 #define Getrb												\
 	uint8_t * rmrb;											\
@@ -19,6 +19,8 @@
 
 #include "paging.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
@@ -38,6 +40,16 @@
 
 PagingBlock paging;
 
+static struct {
+	int64_t links          = 0; // pages linked, also by restoring
+	int64_t flushes        = 0;
+	int64_t dir_loads      = 0;
+	int64_t dir_reloads    = 0; // CR3 written with its current value
+	int64_t pages_restored = 0;
+	int64_t pages_skipped  = 0; // retained but no longer linkable directly
+	int64_t pages_expired  = 0; // restored too often without a miss
+} tlb_stats = {};
+
 uint8_t PageHandler::readb(PhysPt addr)
 {
 	E_Exit("No byte handler for read from %d",addr);	
@@ -88,6 +100,21 @@ void PageHandler::writeq(PhysPt addr, uint64_t val) {
     }
 }
 
+void PageHandler::writeblock(PhysPt addr, const uint8_t* data,
+                             const size_t num_values, const size_t width)
+{
+	for (size_t i = 0; i < num_values; ++i) {
+		switch (width) {
+		case 1: writeb(addr, data[0]); break;
+		case 2: writew(addr, host_readw(data)); break;
+		case 4: writed(addr, host_readd(data)); break;
+		default: assert(false); break;
+		}
+		addr += static_cast<PhysPt>(width);
+		data += width;
+	}
+}
+
 HostPt PageHandler::GetHostReadPt(Bitu /*phys_page*/) {
 	return nullptr;
 }
@@ -790,6 +817,7 @@ void PAGING_InitTLB()
 
 void PAGING_ClearTLB()
 {
+	++tlb_stats.flushes;
 	uint32_t * entries=&paging.links.entries[0];
 	for (;paging.links.used>0;paging.links.used--) {
 		const auto page=*entries++;
@@ -842,6 +870,7 @@ void PAGING_LinkPage(uint32_t lin_page,uint32_t phys_page) {
 	else paging.tlb.write[lin_page]=nullptr;
 
 	paging.links.entries[paging.links.used++]=lin_page;
+	++tlb_stats.links;
 	paging.tlb.readhandler[lin_page]=handler;
 	paging.tlb.writehandler[lin_page]=handler;
 }
@@ -864,6 +893,7 @@ void PAGING_LinkPage_ReadOnly(uint32_t lin_page,uint32_t phys_page) {
 	paging.tlb.write[lin_page]=nullptr;
 
 	paging.links.entries[paging.links.used++]=lin_page;
+	++tlb_stats.links;
 	paging.tlb.readhandler[lin_page]=handler;
 	paging.tlb.writehandler[lin_page]=&init_page_handler_userro;
 }
@@ -893,6 +923,7 @@ void PAGING_InitTLB()
 
 void PAGING_ClearTLB()
 {
+	++tlb_stats.flushes;
 	uint32_t* entries = &paging.links.entries[0];
 	for (;paging.links.used>0;paging.links.used--) {
 		Bitu page=*entries++;
@@ -948,6 +979,7 @@ void PAGING_LinkPage(uint32_t lin_page, uint32_t phys_page)
 	else entry->write=0;
 
  	paging.links.entries[paging.links.used++]=lin_page;
+	++tlb_stats.links;
 	entry->readhandler=handler;
 	entry->writehandler=handler;
 }
@@ -971,6 +1003,7 @@ void PAGING_LinkPage_ReadOnly(uint32_t lin_page, uint32_t phys_page)
 	entry->write=0;
 
  	paging.links.entries[paging.links.used++]=lin_page;
+	++tlb_stats.links;
 	entry->readhandler=handler;
 	entry->writehandler=&init_page_handler_userro;
 }
@@ -978,18 +1011,195 @@ void PAGING_LinkPage_ReadOnly(uint32_t lin_page, uint32_t phys_page)
 #endif
 
 
+// TLB retention across CR3 loads
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Loading CR3 flushes the TLB. DOS extenders and Windows switch page
+// directories on every task switch, and 386-compatible code reloads CR3 with
+// its current value to flush, so the pages a task touches are faulted in
+// through the init handler over and over.
+//
+// Instead the linear pages a directory had linked are remembered when it's
+// unloaded. When the directory is loaded again, each of them is linked right
+// away if the current page tables allow a plain user read/write link with
+// the accessed and dirty bits already set, which is exactly what the init
+// handler would do for any access at any privilege level. Pages that don't
+// qualify or changed in between are left to fault in as before, so no
+// translation can go stale.
+//
+// Accesses to a linked page don't pass through any handler, so a restored
+// page that's never used again can't be told apart from one that is. Each
+// retained page counts the loads it was restored on without missing the
+// TLB since; after max_unused_restores of them it's dropped, and it's only
+// retained again once an access faults it in. This keeps the set to the
+// pages the directory used over its last few loads, at the cost of one
+// miss per used page every few loads.
+//
+// The TLB itself stays a flat array indexed by linear page: the dynamic x86
+// core reads it directly from generated code, and flushes only walk the list
+// of linked pages rather than resetting the arrays.
+
+constexpr int max_retained_directories = 16;
+constexpr size_t max_retained_pages    = 8192; // well below PAGING_LINKS
+constexpr uint8_t max_unused_restores  = 8;
+
+struct RetainedPage {
+	uint32_t lin_page = 0;
+	uint8_t restores  = 0; // loads it was restored on since its last miss
+};
+
+struct RetainedDirectory {
+	uint32_t base_page = 0;
+	uint64_t last_used = 0; // 0 for unused slots
+	std::vector<RetainedPage> pages = {};
+};
+
+static struct {
+	std::array<RetainedDirectory, max_retained_directories> directories = {};
+	uint64_t use_count = 0;
+
+	// The pages the last load restored, in the order they were linked;
+	// they're the first entries on the list of links until it's flushed
+	std::vector<RetainedPage> restored = {};
+} tlb_retention = {};
+
+static RetainedDirectory *find_retained_directory(const uint32_t base_page)
+{
+	for (auto &directory : tlb_retention.directories) {
+		if (directory.last_used && directory.base_page == base_page) {
+			return &directory;
+		}
+	}
+	return nullptr;
+}
+
+static void retain_linked_pages(const uint32_t base_page)
+{
+	auto directory = find_retained_directory(base_page);
+	if (!directory) {
+		// Take over the least recently used slot
+		directory = &*std::min_element(tlb_retention.directories.begin(),
+		                               tlb_retention.directories.end(),
+		                               [](const auto &a, const auto &b) {
+			                               return a.last_used < b.last_used;
+		                               });
+	}
+	directory->base_page = base_page;
+	directory->last_used = ++tlb_retention.use_count;
+
+	const auto &restored = tlb_retention.restored;
+
+	auto &pages = directory->pages;
+	pages.clear();
+	for (uint32_t i = 0; i < paging.links.used; ++i) {
+		if (pages.size() >= max_retained_pages) {
+			break;
+		}
+		// Links undone by InitPageUpdateLink are still on the list
+		const auto lin_page = paging.links.entries[i];
+		if (get_tlb_readhandler(lin_page << 12) == &init_page_handler) {
+			continue;
+		}
+		// Any other link on the list was made by a miss
+		uint8_t restores = 0;
+		if (i < restored.size() && restored[i].lin_page == lin_page) {
+			restores = restored[i].restores + 1;
+			if (restores >= max_unused_restores) {
+				++tlb_stats.pages_expired;
+				continue;
+			}
+		}
+		pages.push_back({lin_page, restores});
+	}
+	// A page restored and then faulted in again keeps its fewer restores
+	std::sort(pages.begin(), pages.end(), [](const auto &a, const auto &b) {
+		return a.lin_page != b.lin_page ? a.lin_page < b.lin_page
+		                                : a.restores < b.restores;
+	});
+	pages.erase(std::unique(pages.begin(),
+	                        pages.end(),
+	                        [](const auto &a, const auto &b) {
+		                        return a.lin_page == b.lin_page;
+	                        }),
+	            pages.end());
+}
+
+static bool is_linkable_directly(const X86PageEntry &table, const X86PageEntry &entry)
+{
+	return table.p && table.a && table.us && table.wr && entry.p &&
+	       entry.a && entry.d && entry.us && entry.wr;
+}
+
+static void restore_linked_pages(const uint32_t base_page)
+{
+	tlb_retention.restored.clear();
+
+	const auto directory = find_retained_directory(base_page);
+	if (!directory) {
+		return;
+	}
+	directory->last_used = ++tlb_retention.use_count;
+
+	X86PageEntry table = {};
+	uint32_t table_index = UINT32_MAX;
+	for (const auto &page : directory->pages) {
+		const auto lin_page = page.lin_page;
+		// The pages are sorted, so neighbours share their page table
+		if ((lin_page >> 10) != table_index) {
+			table_index = lin_page >> 10;
+			table.set(phys_readd((base_page << 12) + table_index * 4));
+		}
+		X86PageEntry entry = {};
+		if (table.p) {
+			entry.set(phys_readd((table.base << 12) + (lin_page & 0x3ff) * 4));
+		}
+		if (is_linkable_directly(table, entry)) {
+			PAGING_LinkPage(lin_page, entry.base);
+			tlb_retention.restored.push_back(page);
+			++tlb_stats.pages_restored;
+		} else {
+			++tlb_stats.pages_skipped;
+		}
+	}
+}
+
 void PAGING_SetDirBase(Bitu cr3) {
 	assert(cr3 <= UINT32_MAX);
+	const auto old_base_page = paging.base.page;
 	paging.cr3=static_cast<uint32_t>(cr3);
 	
 	paging.base.page=static_cast<uint32_t>(cr3 >> 12);
 	paging.base.addr=static_cast<PhysPt>(cr3 & ~4095);
 //	LOG(LOG_PAGING,LOG_NORMAL)("CR3:%X Base %X",cr3,paging.base.page);
 	if (paging.enabled) {
+		++tlb_stats.dir_loads;
+		if (paging.base.page == old_base_page) {
+			++tlb_stats.dir_reloads;
+		}
+		retain_linked_pages(old_base_page);
 		PAGING_ClearTLB();
+		restore_linked_pages(paging.base.page);
 	}
 }
 
+void PAGING_LogStats()
+{
+	const auto &s = tlb_stats;
+	LOG(LOG_MISC, LOG_ERROR)("PAGING: %s, %d pages linked",
+	                         paging.enabled ? "Enabled" : "Disabled",
+	                         static_cast<int>(paging.links.used));
+	LOG(LOG_MISC, LOG_ERROR)("PAGING: %lld TLB misses, %lld flushes, %lld CR3 loads (%lld with an unchanged value)",
+	                         static_cast<long long>(s.links - s.pages_restored),
+	                         static_cast<long long>(s.flushes),
+	                         static_cast<long long>(s.dir_loads),
+	                         static_cast<long long>(s.dir_reloads));
+	LOG(LOG_MISC, LOG_ERROR)("PAGING: %lld pages relinked on CR3 loads, %lld skipped as their entries changed",
+	                         static_cast<long long>(s.pages_restored),
+	                         static_cast<long long>(s.pages_skipped));
+	LOG(LOG_MISC, LOG_ERROR)("PAGING: %lld pages no longer retained after %d loads without a miss",
+	                         static_cast<long long>(s.pages_expired),
+	                         static_cast<int>(max_unused_restores));
+}
+
 void PAGING_Enable(bool enabled) {
 	/* If paging is disabled, we work from a default paging table */
 	if (paging.enabled==enabled) return;
@@ -1019,6 +1229,8 @@ public:
 		/* Setup default Page Directory, force it to update */
 		paging.enabled=false;
 		PAGING_InitTLB();
+		tlb_retention = {};
+		tlb_stats     = {};
 		for (auto i=0;i<LINK_START;i++) {
 			paging.firstmb[i]=i;
 		}
@@ -51,6 +51,7 @@
 #include "keyboard.h"
 #include "setup.h"
 #include "std_filesystem.h"
+#include "vga.h"
 
 SDL_Window *GFX_GetSDLWindow(void);
 
@@ -1373,8 +1374,16 @@ bool ParseCommand(char* str) {
 
 	if (command == "PAGING") {LogPages(found); return true;}
 
+	if (command == "TLB") {PAGING_LogStats(); return true;}
+
 	if (command == "CPU") {LogCPUInfo(); return true;}
 
+	if (command == "TEXTCACHE") {VGA_LogTextCacheStats(); return true;}
+
+#if (C_DYNAMIC_X86) || (C_DYNREC)
+	if (command == "DYNCACHE") {DYNCACHE_LogStats(); return true;}
+#endif
+
 	if (command == "INTVEC") {
 		if (found[0] != 0) {
 			OutputVecTable(found);
@@ -1460,10 +1469,15 @@ bool ParseCommand(char* str) {
 		DEBUG_ShowMsg("INTHAND [intNum]          - Set code view to interrupt handler.\n");
 
 		DEBUG_ShowMsg("CPU                       - Display CPU status information.\n");
+		DEBUG_ShowMsg("TEXTCACHE                 - Display text mode glyph cache statistics.\n");
+#if (C_DYNAMIC_X86) || (C_DYNREC)
+		DEBUG_ShowMsg("DYNCACHE                  - Display dynamic core code cache statistics.\n");
+#endif
 		DEBUG_ShowMsg("GDT                       - Lists descriptors of the GDT.\n");
 		DEBUG_ShowMsg("LDT                       - Lists descriptors of the LDT.\n");
 		DEBUG_ShowMsg("IDT                       - Lists descriptors of the IDT.\n");
 		DEBUG_ShowMsg("PAGING [page]             - Display content of page table.\n");
+		DEBUG_ShowMsg("TLB                       - Display TLB miss and flush statistics.\n");
 		DEBUG_ShowMsg("EXTEND                    - Toggle additional info.\n");
 		DEBUG_ShowMsg("TIMERIRQ                  - Run the system timer.\n");
 
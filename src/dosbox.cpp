@@ -30,6 +30,8 @@
 #include <thread>
 #include <unistd.h>
 
+#include "auto_cycles.h"
+#include "benchmark.h"
 #include "callback.h"
 #include "capture/capture.h"
 #include "control.h"
@@ -128,9 +130,11 @@ static LoopHandler * loop;
 static int64_t ticksRemain;
 static int64_t ticksLast;
 static int64_t ticksAdded;
-int64_t ticksDone;
-int64_t ticksScheduled;
+static int64_t ticksScheduled;
+int64_t ticksIdleUs;
+static int64_t ticksWindowStartUs;
 bool ticksLocked;
+static AutoCycles auto_cycles = {};
 void increaseticks();
 
 bool mono_cga=false;
@@ -143,7 +147,17 @@ static Bitu Normal_Loop() {
 	Bits ret;
 	while (1) {
 		if (PIC_RunQueue()) {
-			ret = (*cpudecoder)();
+			if (BENCHMARK_IsActive()) {
+				const auto core = cpudecoder;
+				BENCHMARK_BeginSlice();
+				ret = (*core)();
+				if (BENCHMARK_EndSlice(core)) {
+					GFX_RequestExit(true);
+					return 0;
+				}
+			} else {
+				ret = (*cpudecoder)();
+			}
 			if (ret < 0) {
 				return 1;
 			}
@@ -165,6 +179,10 @@ static Bitu Normal_Loop() {
 			if (ticksRemain > 0) {
 				TIMER_AddTick();
 				ticksRemain--;
+				if (BENCHMARK_IsActive() && BENCHMARK_AddTick()) {
+					GFX_RequestExit(true);
+					return 0;
+				}
 			} else {increaseticks();return 0;}
 		}
 	}
@@ -172,13 +190,13 @@ static Bitu Normal_Loop() {
 
 void increaseticks() { //Make it return ticksRemain and set it in the function above to remove the global variable.
 	ZoneScoped;
-	if (ticksLocked) { // For Fast Forward Mode
+	// Fast Forward Mode, and the benchmark which doesn't follow the host clock
+	if (ticksLocked || BENCHMARK_IsActive()) {
 		ticksRemain=5;
 		/* Reset any auto cycle guessing for this frame */
 		ticksLast = GetTicks();
 		ticksAdded = 0;
-		ticksDone = 0;
-		ticksScheduled = 0;
+		DOSBOX_ResetAutoCycles();
 		return;
 	}
 
@@ -189,39 +207,18 @@ void increaseticks() { //Make it return ticksRemain and set it in the function a
 	if (ticksNew <= ticksLast) { //lower should not be possible, only equal.
 		ticksAdded = 0;
 
-		static int64_t cumulativeTimeSlept = 0;
-
-		constexpr auto sleepDuration = std::chrono::microseconds(1000);
-		std::this_thread::sleep_for(sleepDuration);
-
-		const auto timeslept = GetTicksUsSince(ticksNewUs);
-
-		cumulativeTimeSlept += timeslept;
-
-		// Update ticksDone with the total time spent sleeping
-		if (cumulativeTimeSlept >= 1000) {
-			const auto cumulativeTicksSlept = cumulativeTimeSlept / 1000;
-			ticksDone -= cumulativeTicksSlept;
-			cumulativeTimeSlept %= 1000;
-		}
+		// Wait for the next millisecond to start rather than a full one,
+		// the emulation may well have used most of the current one
+		const auto waitUs = (ticksLast + 1) * 1000 - ticksNewUs;
+		std::this_thread::sleep_for(std::chrono::microseconds(waitUs));
 
-		if (ticksDone < 0)
-			ticksDone = 0;
-		return; //0
-
-		// If we do work this tick and sleep till the next tick, then ticksDone is decreased,
-		// despite the fact that work was done as well in this tick. Maybe make it depend on an extra parameter.
-		// What do we know: ticksRemain = 0 (condition to enter this function)
-		// ticksNew = time before sleeping
-
-		// maybe keep track of sleeped time in this frame, and use sleeped and done as indicators. (and take care of the fact there
-		// are frames that have both.
+		ticksIdleUs += GetTicksUsSince(ticksNewUs);
+		return;
 	}
 
 	//TicksNew > ticksLast
 	ticksRemain = GetTicksDiff(ticksNew, ticksLast);
 	ticksLast = ticksNew;
-	ticksDone += ticksRemain;
 	if ( ticksRemain > 20 ) {
 //		LOG(LOG_MISC,LOG_ERROR)("large remain %d",ticksRemain);
 		ticksRemain = 20;
@@ -229,90 +226,48 @@ void increaseticks() { //Make it return ticksRemain and set it in the function a
 	ticksAdded = ticksRemain;
 
 	// Is the system in auto cycle mode guessing ? If not just exit. (It can be temporary disabled)
-	if (!CPU_CycleAutoAdjust) return;
-
-	if (ticksScheduled >= 100 || ticksDone >= 100 || (ticksAdded > 15 && ticksScheduled >= 5) ) {
-		if(ticksDone < 1) ticksDone = 1; // Protect against div by zero
-		// Ratio we are aiming for is 100% usage
-		int32_t ratio = static_cast<int32_t>(
-		        (ticksScheduled * (CPU_CyclePercUsed * 1024 / 100)) /
-		        ticksDone);
-
-		int32_t new_cmax = CPU_CycleMax;
-		int64_t cproc = (int64_t)CPU_CycleMax * (int64_t)ticksScheduled;
-		double ratioremoved = 0.0; //increase scope for logging
-		if (cproc > 0) {
-			/* ignore the cycles added due to the IO delay code in order
-			   to have smoother auto cycle adjustments */
-			ratioremoved = (double) CPU_IODelayRemoved / (double) cproc;
-			if (ratioremoved < 1.0) {
-				double ratio_not_removed = 1 - ratioremoved;
-				ratio = (int32_t)((double)ratio * ratio_not_removed);
-
-				/* Don't allow very high ratio which can cause us to lock as we don't scale down
-				 * for very low ratios. High ratio might result because of timing resolution */
-				if (ticksScheduled >= 100 && ticksDone < 10 && ratio > 16384)
-					ratio = 16384;
-
-				// Limit the ratio even more when the cycles are already way above the realmode default.
-				if (ticksScheduled >= 100 && ticksDone < 10 && ratio > 5120 && CPU_CycleMax > 50000)
-					ratio = 5120;
-
-				// When downscaling multiple times in a row, ensure a minimum amount of downscaling
-				if (ticksAdded > 15 && ticksScheduled >= 5 && ticksScheduled <= 20 && ratio > 800)
-					ratio = 800;
-
-				if (ratio <= 1024) {
-					// ratio_not_removed = 1.0; //enabling this restores the old formula
-					double r = (1.0 + ratio_not_removed) /(ratio_not_removed + 1024.0/(static_cast<double>(ratio)));
-					new_cmax = 1 + static_cast<int32_t>(CPU_CycleMax * r);
-				} else {
-					int64_t ratio_with_removed = (int64_t) ((((double)ratio - 1024.0) * ratio_not_removed) + 1024.0);
-					int64_t cmax_scaled = (int64_t)CPU_CycleMax * ratio_with_removed;
-					new_cmax = (int32_t)(1 + (CPU_CycleMax >> 1) + cmax_scaled / (int64_t)2048);
-				}
-			}
-		}
+	if (!CPU_CycleAutoAdjust) {
+		DOSBOX_ResetAutoCycles();
+		return;
+	}
 
-		if (new_cmax < CPU_CYCLES_LOWER_LIMIT)
-			new_cmax = CPU_CYCLES_LOWER_LIMIT;
-		/*
-		LOG_INFO("cyclelog: current %06d   cmax %06d   ratio  %05d  done %03d   sched %03d Add %d rr %4.2f",
-			CPU_CycleMax,
-			new_cmax,
-			ratio,
-			ticksDone,
-			ticksScheduled,
-			ticksAdded,
-			ratioremoved);
-		*/
-
-		/* ratios below 1% are considered to be dropouts due to
-		   temporary load imbalance, the cycles adjusting is skipped */
-		if (ratio > 10) {
-			/* ratios below 12% along with a large time since the last update
-			   has taken place are most likely caused by heavy load through a
-			   different application, the cycles adjusting is skipped as well */
-			if ((ratio > 120) || (ticksDone < 700)) {
-				CPU_CycleMax = new_cmax;
-				if (CPU_CycleLimit > 0) {
-					if (CPU_CycleMax > CPU_CycleLimit) CPU_CycleMax = CPU_CycleLimit;
-				} else if (CPU_CycleMax > 2000000) CPU_CycleMax = 2000000; //Hardcoded limit, if no limit was specified.
-			}
-		}
+	AutoCycles::Sample sample = {};
+	sample.emulated_ms        = ticksScheduled;
+	sample.elapsed_us         = GetTicksDiff(ticksNewUs, ticksWindowStartUs);
+	sample.idle_us            = ticksIdleUs;
+	sample.io_delay_cycles    = CPU_IODelayRemoved;
+
+	AutoCycles::Settings settings = {};
+	settings.target_usage = static_cast<double>(CPU_CyclePercUsed) / 100.0;
+	settings.min_cycles   = CPU_CYCLES_LOWER_LIMIT;
+	// Hardcoded limit, if no limit was specified
+	settings.max_cycles = CPU_CycleLimit > 0 ? CPU_CycleLimit : 2000000;
+
+	const auto new_cmax = auto_cycles.Update(CPU_CycleMax, settings, sample);
+	if (!new_cmax) {
+		return;
+	}
+	CPU_CycleMax = *new_cmax;
+
+	TracyPlot("Auto cycles setpoint (%)", auto_cycles.GetSetpoint() * 100.0);
+	TracyPlot("Auto cycles usage (%)", auto_cycles.GetMeasuredUsage() * 100.0);
+	TracyPlot("Auto cycles", static_cast<int64_t>(CPU_CycleMax));
+
+	// Start the next window
+	CPU_IODelayRemoved = 0;
+	ticksScheduled     = 0;
+	ticksIdleUs        = 0;
+	ticksWindowStartUs = ticksNewUs;
+}
+
+void DOSBOX_ResetAutoCycles()
+{
+	auto_cycles.Reset();
 
-		//Reset cycleguessing parameters.
-		CPU_IODelayRemoved = 0;
-		ticksDone = 0;
-		ticksScheduled = 0;
-	} else if (ticksAdded > 15) {
-		/* ticksAdded > 15 but ticksScheduled < 5, lower the cycles
-		   but do not reset the scheduled/done ticks to take them into
-		   account during the next auto cycle adjustment */
-		CPU_CycleMax /= 3;
-		if (CPU_CycleMax < CPU_CYCLES_LOWER_LIMIT)
-			CPU_CycleMax = CPU_CYCLES_LOWER_LIMIT;
-	} //if (ticksScheduled >= 250 || ticksDone >= 250 || (ticksAdded > 15 && ticksScheduled >= 5) )
+	CPU_IODelayRemoved = 0;
+	ticksScheduled     = 0;
+	ticksIdleUs        = 0;
+	ticksWindowStartUs = GetTicksUs();
 }
 
 void DOSBOX_SetLoop(LoopHandler * handler) {
@@ -529,6 +484,18 @@ void DOSBOX_Init()
 	        "though a few games might require a higher value.\n"
 	        "There is generally no speed advantage when raising this value.");
 
+	pstring = secprop->Add_string("memory_huge_pages", only_at_start, "off");
+	pstring->Set_help(
+	        "Back the emulated machine's memory with huge host pages, which can\n"
+	        "speed up programs that use a lot of memory (off by default):\n"
+	        "  off:          Use regular pages, committed as the memory is used.\n"
+	        "  transparent:  Let the host kernel use huge pages as the memory is used\n"
+	        "                (Linux only).\n"
+	        "  explicit:     Take the memory from the host's preallocated huge page\n"
+	        "                pool up front (Linux hugetlbfs, or Windows large pages).\n"
+	        "Unavailable modes fall back to the next mode down.");
+	pstring->Set_values({"off", "transparent", "explicit"});
+
 	pstring = secprop->Add_string("mcb_fault_strategy", only_at_start, "repair");
 	pstring->Set_help(
 	        "How software-corrupted memory chain blocks should be handled:\n"
@@ -711,6 +678,22 @@ void DOSBOX_Init()
 	pint->Set_help("Number of cycles subtracted with the decrease cycles hotkey (20 by default).\n"
 	               "Setting it lower than 100 will be a percentage.");
 
+#if (C_DYNAMIC_X86) || (C_DYNREC)
+	pbool = secprop->Add_bool("dynamic_core_cache", only_at_start, false);
+	pbool->Set_help(
+	        "Remember which code blocks the dynamic core translated, and translate them\n"
+	        "again up-front when the same code is loaded in a later session (disabled by\n"
+	        "default). The block list is kept in 'dynamic_core_cache.bin' in the config\n"
+	        "directory; pages whose content changed are not restored.");
+
+	pint = secprop->Add_int("dynamic_core_memsize", only_at_start, 64);
+	pint->SetMinMax(8, 512);
+	pint->Set_help(
+	        "Maximum size of the dynamic core's translated code cache in MB (64 by default).\n"
+	        "The cache starts at 4 MB and grows when code is retranslated too often;\n"
+	        "raise this for large protected mode programs such as Windows 9x.");
+#endif
+
 #if C_FPU
 	secprop->AddInitFunction(&FPU_Init);
 #endif
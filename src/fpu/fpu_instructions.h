@@ -20,6 +20,7 @@
 #include "fpu.h"
 #endif
 
+#include "float80.h"
 #include "math_utils.h"
 
 static constexpr uint16_t PrecisionModeMask = 0x0300;
@@ -150,58 +151,47 @@ static double FROUND(double in)
 	}
 }
 
-#define BIAS80 16383
-#define BIAS64 1023
-
-static Real64 FPU_FLD80(PhysPt addr) {
-	struct {
-		int16_t begin = 0;
-		FPU_Reg eind  = {};
-	} test = {};
-
-	test.eind.ll = mem_readq(addr);
-	test.begin = mem_readw(addr+8);
-   
-	int64_t exp64 = (((test.begin&0x7fff) - BIAS80));
-	int64_t blah = ((exp64 >0)?exp64:-exp64)&0x3ff;
-	int64_t exp64final = ((exp64 >0)?blah:-blah) +BIAS64;
+static Real64 FPU_FLD80(PhysPt addr)
+{
+	Float80 value       = {};
+	value.mantissa      = mem_readq(addr);
+	value.sign_exponent = mem_readw(addr + 8);
+	return FLOAT80_ToDouble(value);
+}
 
-	int64_t mant64 = (test.eind.ll >> 11) & LONGTYPE(0xfffffffffffff);
-	int64_t sign = (test.begin&0x8000)?1:0;
-	FPU_Reg result;
-	result.ll = (sign <<63)|(exp64final << 52)| mant64;
+static void FPU_ST80(PhysPt addr, Bitu reg)
+{
+	const auto value = FLOAT80_FromDouble(fpu.regs[reg].d);
+	mem_writeq(addr, value.mantissa);
+	mem_writew(addr + 8, value.sign_exponent);
+}
 
-	if (test.eind.l.lower == 0 && test.eind.l.upper == INT32_MIN &&
-	    (test.begin & INT16_MAX) == INT16_MAX) {
-		//Detect INF and -INF (score 3.11 when drawing a slur.)
-		result.d = sign?-HUGE_VAL:HUGE_VAL;
+// The registers hold doubles, so extended and double precision give the
+// same results. In single precision mode the x87 rounds the significand of
+// every arithmetic result to 24 bits, which some games depend on; the
+// exponent keeps the register's range.
+static inline double FPU_ApplyPrecision(const double value)
+{
+	switch (fpu.cw & PrecisionModeMask) {
+	case SinglePrecisionMode:
+		return FLOAT80_RoundSignificand(value, 24, fpu.round);
+	case DoublePrecisionMode:
+		return FLOAT80_RoundSignificand(value, 53, fpu.round);
+	default: return value;
 	}
-	return result.d;
-
-	//mant64= test.mant80/2***64    * 2 **53 
-}
-
-static void FPU_ST80(PhysPt addr,Bitu reg) {
-	struct {
-		int16_t begin = 0;
-		FPU_Reg eind  = {};
-	} test = {};
-
-	int64_t sign80 = (fpu.regs[reg].ll & LONGTYPE(0x8000000000000000)) ? 1 : 0;
-	int64_t exp80       = fpu.regs[reg].ll & LONGTYPE(0x7ff0000000000000);
-	int64_t exp80final  = (exp80 >> 52);
-	int64_t mant80 = fpu.regs[reg].ll&LONGTYPE(0x000fffffffffffff);
-	int64_t mant80final = (mant80 << 11);
-	if(fpu.regs[reg].d != 0){ //Zero is a special case
-		// Elvira wants the 8 and tcalc doesn't
-		mant80final |= LONGTYPE(0x8000000000000000);
-		//Ca-cyber doesn't like this when result is zero.
-		exp80final += (BIAS80 - BIAS64);
+}
+
+// FSIN, FCOS, FSINCOS, and FPTAN leave operands of 2^63 and above
+// unchanged and flag them with C2, for the program to reduce them first
+static inline bool FPU_IsTrigOperandInRange(const double value)
+{
+	constexpr double trig_limit = 9223372036854775808.0; // 2^63
+	if (std::fabs(value) < trig_limit) {
+		FPU_SET_C2(0);
+		return true;
 	}
-	test.begin = (static_cast<int16_t>(sign80)<<15)| static_cast<int16_t>(exp80final);
-	test.eind.ll = mant80final;
-	mem_writeq(addr, test.eind.ll);
-	mem_writew(addr+8,test.begin);
+	FPU_SET_C2(1);
+	return false;
 }
 
 
@@ -368,36 +358,40 @@ static void FPU_FBST(PhysPt addr) {
 }
 
 static void FPU_FADD(Bitu op1, Bitu op2){
-	fpu.regs[op1].d+=fpu.regs[op2].d;
+	fpu.regs[op1].d = FPU_ApplyPrecision(fpu.regs[op1].d + fpu.regs[op2].d);
 	//flags and such :)
 	return;
 }
 
 static void FPU_FSIN(void){
-	fpu.regs[TOP].d = sin(fpu.regs[TOP].d);
-	FPU_SET_C2(0);
+	if (FPU_IsTrigOperandInRange(fpu.regs[TOP].d)) {
+		fpu.regs[TOP].d = sin(fpu.regs[TOP].d);
+	}
 	//flags and such :)
 	return;
 }
 
 static void FPU_FSINCOS(void){
 	Real64 temp = fpu.regs[TOP].d;
+	if (!FPU_IsTrigOperandInRange(temp)) {
+		return;
+	}
 	fpu.regs[TOP].d = sin(temp);
 	FPU_PUSH(cos(temp));
-	FPU_SET_C2(0);
 	//flags and such :)
 	return;
 }
 
 static void FPU_FCOS(void){
-	fpu.regs[TOP].d = cos(fpu.regs[TOP].d);
-	FPU_SET_C2(0);
+	if (FPU_IsTrigOperandInRange(fpu.regs[TOP].d)) {
+		fpu.regs[TOP].d = cos(fpu.regs[TOP].d);
+	}
 	//flags and such :)
 	return;
 }
 
 static void FPU_FSQRT(void){
-	fpu.regs[TOP].d = sqrt(fpu.regs[TOP].d);
+	fpu.regs[TOP].d = FPU_ApplyPrecision(sqrt(fpu.regs[TOP].d));
 	//flags and such :)
 	return;
 }
@@ -408,38 +402,40 @@ static void FPU_FPATAN(void){
 	return;
 }
 static void FPU_FPTAN(void){
+	if (!FPU_IsTrigOperandInRange(fpu.regs[TOP].d)) {
+		return;
+	}
 	fpu.regs[TOP].d = tan(fpu.regs[TOP].d);
 	FPU_PUSH(1.0);
-	FPU_SET_C2(0);
 	//flags and such :)
 	return;
 }
 static void FPU_FDIV(Bitu st, Bitu other){
-	fpu.regs[st].d= fpu.regs[st].d/fpu.regs[other].d;
+	fpu.regs[st].d = FPU_ApplyPrecision(fpu.regs[st].d / fpu.regs[other].d);
 	//flags and such :)
 	return;
 }
 
 static void FPU_FDIVR(Bitu st, Bitu other){
-	fpu.regs[st].d= fpu.regs[other].d/fpu.regs[st].d;
+	fpu.regs[st].d = FPU_ApplyPrecision(fpu.regs[other].d / fpu.regs[st].d);
 	// flags and such :)
 	return;
 }
 
 static void FPU_FMUL(Bitu st, Bitu other){
-	fpu.regs[st].d*=fpu.regs[other].d;
+	fpu.regs[st].d = FPU_ApplyPrecision(fpu.regs[st].d * fpu.regs[other].d);
 	//flags and such :)
 	return;
 }
 
 static void FPU_FSUB(Bitu st, Bitu other){
-	fpu.regs[st].d = fpu.regs[st].d - fpu.regs[other].d;
+	fpu.regs[st].d = FPU_ApplyPrecision(fpu.regs[st].d - fpu.regs[other].d);
 	//flags and such :)
 	return;
 }
 
 static void FPU_FSUBR(Bitu st, Bitu other){
-	fpu.regs[st].d= fpu.regs[other].d - fpu.regs[st].d;
+	fpu.regs[st].d = FPU_ApplyPrecision(fpu.regs[other].d - fpu.regs[st].d);
 	//flags and such :)
 	return;
 }
@@ -551,24 +547,34 @@ static void FPU_FXAM(void){
 
 
 static void FPU_F2XM1(void){
-	fpu.regs[TOP].d = pow(2.0,fpu.regs[TOP].d) - 1;
+	constexpr double ln2 = 0.693147180559945309417;
+	// expm1 keeps the precision for the small operands F2XM1 takes
+	fpu.regs[TOP].d = std::expm1(fpu.regs[TOP].d * ln2);
 	return;
 }
 
 static void FPU_FYL2X(void){
-	fpu.regs[STV(1)].d*=log(fpu.regs[TOP].d)/log(static_cast<Real64>(2.0));
+	fpu.regs[STV(1)].d *= std::log2(fpu.regs[TOP].d);
 	FPU_FPOP();
 	return;
 }
 
 static void FPU_FYL2XP1(void){
-	fpu.regs[STV(1)].d*=log(fpu.regs[TOP].d+1.0)/log(static_cast<Real64>(2.0));
+	constexpr double log2e = 1.44269504088896340736;
+	// log1p keeps the precision for the small operands FYL2XP1 takes
+	fpu.regs[STV(1)].d *= std::log1p(fpu.regs[TOP].d) * log2e;
 	FPU_FPOP();
 	return;
 }
 
 static void FPU_FSCALE(void){
-	fpu.regs[TOP].d *= pow(2.0,static_cast<Real64>(static_cast<int64_t>(fpu.regs[STV(1)].d)));
+	if (std::isnan(fpu.regs[STV(1)].d)) {
+		fpu.regs[TOP].d = fpu.regs[STV(1)].d;
+		return;
+	}
+	// Scales beyond the range of a double saturate just the same
+	const auto scale = std::clamp(std::trunc(fpu.regs[STV(1)].d), -4096.0, 4096.0);
+	fpu.regs[TOP].d = std::ldexp(fpu.regs[TOP].d, static_cast<int>(scale));
 	//FPU_SET_C1(0);
 	return; //2^x where x is chopped.
 }
@@ -631,7 +637,7 @@ static void FPU_FXTRACT(void) {
 
 	FPU_Reg test = fpu.regs[TOP];
 	int64_t exp80 =  test.ll&LONGTYPE(0x7ff0000000000000);
-	int64_t exp80final = (exp80>>52) - BIAS64;
+	int64_t exp80final = (exp80 >> 52) - float80::bias64;
 	Real64 mant = test.d / (pow(2.0,static_cast<Real64>(exp80final)));
 	fpu.regs[TOP].d = static_cast<Real64>(exp80final);
 	FPU_PUSH(mant);
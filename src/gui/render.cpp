@@ -22,15 +22,18 @@
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <mutex>
 
 #include "../capture/capture.h"
+#include "benchmark.h"
 #include "control.h"
 #include "fraction.h"
 #include "mapper.h"
 #include "math_utils.h"
 #include "render.h"
+#include "scanline_diff.h"
 #include "setup.h"
 #include "shader_manager.h"
 #include "shell.h"
@@ -137,26 +140,19 @@ static void empty_line_handler(const void*) {}
 static void start_line_handler(const void* s)
 {
 	if (s) {
-		auto src = static_cast<const uintptr_t*>(s);
-		auto cache = reinterpret_cast<uintptr_t*>(render.scale.cacheRead);
-		for (Bits x = render.src_start; x > 0;) {
-			const auto src_ptr = reinterpret_cast<const uint8_t*>(src);
-			const auto src_val = read_unaligned_size_t(src_ptr);
-			if (src_val != cache[0]) {
-				if (!GFX_StartUpdate(render.scale.outWrite,
-				                     render.scale.outPitch)) {
-					RENDER_DrawLine = empty_line_handler;
-					return;
-				}
-				render.scale.outWrite += render.scale.outPitch *
-				                         Scaler_ChangedLines[0];
-				RENDER_DrawLine = render.scale.lineHandler;
-				RENDER_DrawLine(s);
+		const auto line  = static_cast<const uint8_t*>(s);
+		const auto pitch = render.scale.cachePitch;
+		if (find_first_change(line, render.scale.cacheRead, pitch) < pitch) {
+			if (!GFX_StartUpdate(render.scale.outWrite,
+			                     render.scale.outPitch)) {
+				RENDER_DrawLine = empty_line_handler;
 				return;
 			}
-			x--;
-			src++;
-			cache++;
+			render.scale.outWrite += render.scale.outPitch *
+			                         Scaler_ChangedLines[0];
+			RENDER_DrawLine = render.scale.lineHandler;
+			RENDER_DrawLine(s);
+			return;
 		}
 	}
 	render.scale.cacheRead += render.scale.cachePitch;
@@ -168,26 +164,16 @@ static void start_line_handler(const void* s)
 static void finish_line_handler(const void* s)
 {
 	if (s) {
-		auto src = static_cast<const uintptr_t*>(s);
-		auto cache = reinterpret_cast<uintptr_t*>(render.scale.cacheRead);
-		for (Bits x = render.src_start; x > 0;) {
-			cache[0] = src[0];
-			x--;
-			src++;
-			cache++;
-		}
+		memcpy(render.scale.cacheRead, s, render.scale.cachePitch);
 	}
 	render.scale.cacheRead += render.scale.cachePitch;
 }
 
 static void clear_cache_handler(const void* src)
 {
-	const uint32_t* srcLine = (const uint32_t*)src;
-	uint32_t* cacheLine     = (uint32_t*)render.scale.cacheRead;
-	Bitu width              = render.scale.cachePitch / 4;
-	for (Bitu x = 0; x < width; x++) {
-		cacheLine[x] = ~srcLine[x];
-	}
+	copy_inverted(render.scale.cacheRead,
+	              static_cast<const uint8_t*>(src),
+	              render.scale.cachePitch);
 	render.scale.lineHandler(src);
 }
 
@@ -199,6 +185,12 @@ bool RENDER_StartUpdate(void)
 	if (!render.active) {
 		return false;
 	}
+	// Frames that won't be presented aren't drawn, unless every frame is
+	// captured or counted
+	if (!CAPTURE_IsCapturingImage() && !CAPTURE_IsCapturingVideo() &&
+	    !BENCHMARK_IsActive() && !GFX_IsFrameWanted()) {
+		return false;
+	}
 	if (render.scale.inMode == scalerMode8) {
 		check_palette();
 	}
@@ -291,8 +283,16 @@ void RENDER_EndUpdate(bool abort)
 		CAPTURE_AddFrame(image, frames_per_second);
 	}
 
+	if (BENCHMARK_IsActive()) {
+		BENCHMARK_AddFrame(render.scale.outWrite && !abort);
+	}
+
 	if (render.scale.outWrite) {
-		GFX_EndUpdate(abort ? nullptr : Scaler_ChangedLines);
+		if (abort) {
+			GFX_EndUpdate(nullptr);
+		} else {
+			GFX_EndUpdate(Scaler_ChangedLines, Scaler_ChangedColumns);
+		}
 	} else {
 		// If we made it here, then there's nothing new to render.
 		GFX_EndUpdate(nullptr);
@@ -382,24 +382,7 @@ static void render_reset(void)
 	yscale    = simpleBlock->yscale;
 	//		LOG_MSG("Scaler:%s",simpleBlock->name);
 
-	constexpr auto src_pixel_bytes = sizeof(uintptr_t);
-
-	switch (render.src.pixel_format) {
-	case PixelFormat::Indexed8:
-	case PixelFormat::RGB555_Packed16:
-	case PixelFormat::RGB565_Packed16:
-		render.src_start = (render.src.width * 2) / src_pixel_bytes;
-		gfx_flags        = (gfx_flags & ~GFX_CAN_8);
-		break;
-	case PixelFormat::BGR24_ByteArray:
-		render.src_start = (render.src.width * 3) / src_pixel_bytes;
-		gfx_flags        = (gfx_flags & ~GFX_CAN_8);
-		break;
-	case PixelFormat::BGRX32_ByteArray:
-		render.src_start = (render.src.width * 4) / src_pixel_bytes;
-		gfx_flags        = (gfx_flags & ~GFX_CAN_8);
-		break;
-	}
+	gfx_flags = (gfx_flags & ~GFX_CAN_8);
 
 	gfx_flags = GFX_GetBestMode(gfx_flags);
 
@@ -24,11 +24,18 @@
 
 #include "dosbox.h"
 #include "render.h"
+#include <algorithm>
 #include <cstring>
 
+#include "math_utils.h"
+#include "scanline_diff.h"
+
 uint8_t Scaler_Aspect[SCALER_MAXHEIGHT]        = {};
 uint16_t Scaler_ChangedLines[SCALER_MAXHEIGHT] = {};
 
+// The changed columns of the changed runs in Scaler_ChangedLines
+ChangedColumns Scaler_ChangedColumns[SCALER_MAXHEIGHT] = {};
+
 Bitu Scaler_ChangedLineIndex = 0;
 
 static union {
@@ -65,11 +72,27 @@ static inline void BituMove( void *_dst, const void * _src, Bitu size) {
 	 }
 }
 
-static inline void ScalerAddLines( Bitu changed, Bitu count ) {
-	if ((Scaler_ChangedLineIndex & 1) == changed ) {
-		Scaler_ChangedLines[Scaler_ChangedLineIndex] += count;
-	} else {
+static inline void ScalerAddLines(Bitu changed, Bitu count,
+                                  Bitu first_column = 0, Bitu last_column = 0)
+{
+	const bool is_new_run = (Scaler_ChangedLineIndex & 1) != changed;
+	if (is_new_run) {
 		Scaler_ChangedLines[++Scaler_ChangedLineIndex] = count;
+	} else {
+		Scaler_ChangedLines[Scaler_ChangedLineIndex] += count;
+	}
+	if (changed) {
+		// Widen the run's columns to cover the lines added to it
+		const auto first = static_cast<uint16_t>(first_column);
+		const auto last  = static_cast<uint16_t>(last_column);
+
+		auto& columns = Scaler_ChangedColumns[Scaler_ChangedLineIndex];
+		if (is_new_run) {
+			columns = {first, last};
+		} else {
+			columns.first = std::min(columns.first, first);
+			columns.last  = std::max(columns.last, last);
+		}
 	}
 	render.scale.outWrite += render.scale.outPitch * count;
 }
@@ -49,6 +49,7 @@ extern uint8_t Scaler_Aspect[];
 extern uint8_t diff_table[];
 extern Bitu Scaler_ChangedLineIndex;
 extern uint16_t Scaler_ChangedLines[];
+extern ChangedColumns Scaler_ChangedColumns[];
 
 union scalerSourceCache_t {
 	uint32_t b32	[SCALER_MAXHEIGHT] [SCALER_MAXWIDTH];
@@ -50,6 +50,9 @@ static void conc4d(SCALERNAME,SBPP,DBPP,R)(const void *s) {
 	render.scale.cacheRead += render.scale.cachePitch;
 	PTYPE * line0=(PTYPE *)(render.scale.outWrite);
 #if (SBPP == 9)
+	// Palette changes can affect any pixel, so the whole line is scanned
+	const Bitu span_start = 0;
+	const Bitu span_end   = render.src.width;
 	for (Bits x=render.src.width;x>0;) {
 		if (std::memcmp(src, cache, sizeof(uint32_t)) == 0 &&
 		    (render.pal.modified[src[0]] | render.pal.modified[src[1]] |
@@ -61,14 +64,26 @@ static void conc4d(SCALERNAME,SBPP,DBPP,R)(const void *s) {
 #else
 	constexpr uint8_t address_step = sizeof(Bitu) / sizeof(SRCTYPE);
 
-	for (Bits x = render.src.width; x > 0;) {
-		const auto src_ptr = reinterpret_cast<const uint8_t *>(src);
-		const auto src_val = read_unaligned_size_t(src_ptr);
+	// Only the span of the line that changed since it was cached is
+	// compared and scaled
+	const auto span = find_changed_span(reinterpret_cast<const uint8_t*>(src),
+	                                    reinterpret_cast<const uint8_t*>(cache),
+	                                    render.scale.cachePitch);
+	const auto span_start = span.first / sizeof(SRCTYPE);
+	const auto span_end   = ceil_udivide(span.last, sizeof(SRCTYPE));
+	src += span_start;
+	cache += span_start;
+	line0 += span_start * SCALERWIDTH;
 
+	// The span ends with a changed pixel, so the pixels left when fewer
+	// than a word's worth remain are scaled without comparing them. A
+	// whole-word compare there would read past the end of the line.
+	for (Bits x = static_cast<Bits>(span_end - span_start); x > 0;) {
+		const auto src_ptr   = reinterpret_cast<const uint8_t *>(src);
 		const auto cache_ptr = reinterpret_cast<uint8_t *>(cache);
-		const auto cache_val = read_unaligned_size_t(cache_ptr);
 
-		if (src_val == cache_val) {
+		if (x >= address_step && read_unaligned_size_t(src_ptr) ==
+		                                 read_unaligned_size_t(cache_ptr)) {
 			x -= address_step;
 			src += address_step;
 			cache += address_step;
@@ -114,7 +129,10 @@ static void conc4d(SCALERNAME,SBPP,DBPP,R)(const void *s) {
 			render.src.width * SCALERWIDTH * PSIZE);
 	}
 #endif
-	ScalerAddLines( hadChange, scaleLines );
+	ScalerAddLines(hadChange,
+	               scaleLines,
+	               span_start * SCALERWIDTH,
+	               span_end * SCALERWIDTH);
 }
 
 #if !defined(SCALERLINEAR) 
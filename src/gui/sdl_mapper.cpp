@@ -2784,7 +2784,7 @@ void BIND_MappingEvents() {
 	SDL_Event event;
 	static bool isButtonPressed = false;
 	static CButton *lastHoveredButton = nullptr;
-	while (SDL_PollEvent(&event)) {
+	while (GFX_PollEvent(&event)) {
 		switch (event.type) {
 		case SDL_MOUSEBUTTONDOWN:
 			isButtonPressed = true;
@@ -31,6 +31,7 @@
 #include <cstring>
 #include <sys/types.h>
 #include <tuple>
+#include <utility>
 #include <unistd.h>
 
 #if C_DEBUG
@@ -51,6 +52,7 @@
 #include "../capture/capture.h"
 #include "../dos/dos_locale.h"
 #include "../ints/int10.h"
+#include "benchmark.h"
 #include "control.h"
 #include "cpu.h"
 #include "cross.h"
@@ -208,10 +210,12 @@ static SDL_Rect to_sdl_rect(const DosBox::Rect& r)
 static void clean_up_sdl_resources();
 static void handle_video_resize(int width, int height);
 
-static void update_frame_texture([[maybe_unused]] const uint16_t* changedLines);
+static void update_frame_texture(const uint16_t* changedLines,
+                                 const ChangedColumns* changedColumns);
 static bool present_frame_texture();
 #if C_OPENGL
-static void update_frame_gl(const uint16_t *changedLines);
+static void update_frame_gl(const uint16_t* changedLines,
+                            const ChangedColumns* changedColumns);
 static bool present_frame_gl();
 static const char* safe_gl_get_string(const GLenum requested_name,
                                       const char* default_result);
@@ -509,6 +513,21 @@ static bool is_command_pressed(const SDL_Event event)
 }
 #endif
 
+// Takes the next event, the queued ones first. The loops that wait for
+// events while a queued event is being handled take theirs from here, so
+// they see the events in the order they came.
+bool GFX_PollEvent(SDL_Event* event)
+{
+	return sdl.input_events.Pop(*event) || SDL_PollEvent(event);
+}
+
+static void wait_event(SDL_Event& event)
+{
+	if (!sdl.input_events.Pop(event)) {
+		SDL_WaitEvent(&event);
+	}
+}
+
 [[maybe_unused]] static void pause_emulation(bool pressed)
 {
 	if (!pressed) {
@@ -521,7 +540,7 @@ static bool is_command_pressed(const SDL_Event event)
 
 	SDL_Event event;
 
-	while (SDL_PollEvent(&event)) {
+	while (GFX_PollEvent(&event)) {
 		// flush event queue.
 	}
 
@@ -529,7 +548,7 @@ static bool is_command_pressed(const SDL_Event event)
 	// SDL 2.0, rather than scan codes. Is that the correct behavior?
 	while (sdl.is_paused && !shutdown_requested) {
 		// since we're not polling, CPU usage drops to 0.
-		SDL_WaitEvent(&event);
+		wait_event(event);
 
 		switch (event.type) {
 		case SDL_QUIT: GFX_RequestExit(true); break;
@@ -837,18 +856,23 @@ static int benchmark_presentation_rate()
 	// so we can hit the vsync wall (if it exists).
 	render_pacer->SetTimeout(0);
 
+	// Nothing is drawn in between, but each frame has to cost the upload
+	// of a fully changed frame
+	sdl.frame.force_full_upload = true;
+
 	// Warmup round
 	for (auto i = 0; i < warmup_frames; ++i) {
-		sdl.frame.update(nullptr);
+		sdl.frame.update(nullptr, nullptr);
 		sdl.frame.present();
 	}
 	// Measured round
 	const auto start_us = GetTicksUs();
 	for (auto frame = 0; frame < bench_frames; ++frame) {
-		sdl.frame.update(nullptr);
+		sdl.frame.update(nullptr, nullptr);
 		sdl.frame.present();
 	}
 	const auto elapsed_us = std::max(static_cast<int64_t>(1L), GetTicksUsSince(start_us));
+	sdl.frame.force_full_upload = false;
 	return iround(static_cast<int>((bench_frames * 1'000'000) / elapsed_us));
 }
 
@@ -975,27 +999,71 @@ static void remove_window()
 //
 static void maybe_present_throttled(const bool frame_is_new)
 {
-	static int64_t last_present_time = 0;
-	static auto was_new_and_throttled = false;
-
-	const auto now     = GetTicksUs();
-	const auto elapsed = now - last_present_time;
+	const auto now = GetTicksUs();
 
-	if (elapsed >= sdl.frame.period_us) {
-		// If we waited beyond this frame's refresh period, then credit
-		// this extra wait back by deducting it from the recorded time.
-		const auto wait_overage = elapsed % sdl.frame.period_us;
-		last_present_time = now - (9 * wait_overage / 10);
+	const auto presented = sdl.frame.throttle.Present(now,
+	                                                  sdl.frame.period_us,
+	                                                  frame_is_new);
+	if (presented) {
+		sdl.frame.present();
+	}
 
-		if (frame_is_new || was_new_and_throttled) {
-			sdl.frame.present();
-		}
+	// Every frame is drawn when verifying, so compare this presentation
+	// with the one skipping the predicted frames would have made
+	if (sdl.frame.skipping != FrameSkipping::Verify) {
+		return;
 	}
-	// Otherwise we've had to throttle the frame, however if the frame was
-	// new, we'll record it as such and try to present it next time.
-	else {
-		was_new_and_throttled = frame_is_new;
+	// Frames drawn while capturing aren't predicted
+	const auto skip_predicted = std::exchange(sdl.frame.skip_predicted, false);
+
+	auto& check = sdl.frame.skip_check;
+	if (check.Check(now,
+	                sdl.frame.period_us,
+	                frame_is_new,
+	                skip_predicted,
+	                presented)) {
+		LOG_WARNING("SDL: Skipping frames would have %s frame %d (%d of %d frames differ, %d skips predicted)",
+		            presented ? "dropped" : "presented",
+		            check.frames,
+		            check.mismatches,
+		            check.frames,
+		            check.skips);
+	}
+}
+
+// The throttled presenter drops the frames that end too soon after the last
+// presented one, so those frames needn't be drawn. The next drawn frame still
+// carries their changes, as the renderer compares each line with the last
+// one it drew. Raster effects are unaffected: the frames that are drawn are
+// drawn line by line as before.
+//
+bool GFX_IsFrameWanted()
+{
+	// The recent frames' host times predict when this one ends
+	const auto now = GetTicksUs();
+	if (sdl.frame.start_us != 0) {
+		sdl.frame.skip_predictor.FrameEnded(now - sdl.frame.start_us);
 	}
+	sdl.frame.start_us = now;
+
+	sdl.frame.skip_predicted = false;
+	if (sdl.frame.mode != FrameMode::ThrottledVfr ||
+	    sdl.frame.skipping == FrameSkipping::Off ||
+	    CAPTURE_IsCapturingPostRenderImage()) {
+		return true;
+	}
+
+	// Verifying predicts the skips as if the predicted frames had been
+	// skipped all along
+	const auto last_present_us = (sdl.frame.skipping == FrameSkipping::Verify)
+	                                   ? sdl.frame.skip_check.LastPresentUs()
+	                                   : sdl.frame.throttle.last_present_us;
+
+	sdl.frame.skip_predicted = sdl.frame.skip_predictor.IsSkipPredicted(
+	        now, last_present_us, sdl.frame.period_us);
+
+	return !sdl.frame.skip_predicted ||
+	       sdl.frame.skipping == FrameSkipping::Verify;
 }
 
 static void maybe_present_synced(const bool present_if_last_skipped)
@@ -2362,14 +2430,13 @@ bool GFX_StartUpdate(uint8_t * &pixels, int &pitch)
 	return false;
 }
 
-extern int64_t ticksDone;
+extern int64_t ticksIdleUs;
 
-void GFX_EndUpdate(const uint16_t* changedLines)
+void GFX_EndUpdate(const uint16_t* changedLines, const ChangedColumns* changedColumns)
 {
-	static int64_t cumulative_time_rendered = 0;
-	const auto start                        = GetTicksUs();
+	const auto start = GetTicksUs();
 
-	sdl.frame.update(changedLines);
+	sdl.frame.update(changedLines, changedColumns);
 
 	if (CAPTURE_IsCapturingPostRenderImage()) {
 		// Always present the frame if we want to capture the next rendered
@@ -2408,14 +2475,9 @@ void GFX_EndUpdate(const uint16_t* changedLines)
 		}
 	}
 
-	const auto elapsed = GetTicksUsSince(start);
-	cumulative_time_rendered += elapsed;
-	// Update ticksDone with the rendering time
-	if (cumulative_time_rendered >= 1000) {
-		const auto cumulative_ticks_rendered = cumulative_time_rendered / 1000;
-		ticksDone -= cumulative_ticks_rendered;
-		cumulative_time_rendered %= 1000;
-	}
+	// Presenting can wait for the display, so the auto cycles controller
+	// doesn't count it as emulation time
+	ticksIdleUs += GetTicksUsSince(start);
 
 	sdl.updating = false;
 	FrameMark;
@@ -2423,12 +2485,48 @@ void GFX_EndUpdate(const uint16_t* changedLines)
 
 // Texture update and presentation
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-static void update_frame_texture([[maybe_unused]] const uint16_t *changedLines)
+static void update_frame_texture(const uint16_t* changedLines,
+                                 const ChangedColumns* changedColumns)
 {
-	SDL_UpdateTexture(sdl.texture.texture,
-	                  nullptr, // update entire texture
-	                  sdl.texture.input_surface->pixels,
-	                  sdl.texture.input_surface->pitch);
+	const auto surface = sdl.texture.input_surface;
+
+	if (!changedLines || !changedColumns) {
+		// Without a list of changes, only a frame that was drawn into
+		// needs uploading
+		if (sdl.updating || sdl.frame.force_full_upload) {
+			SDL_UpdateTexture(sdl.texture.texture,
+			                  nullptr, // update entire texture
+			                  surface->pixels,
+			                  surface->pitch);
+		}
+		return;
+	}
+
+	// Upload the changed columns of each run of changed lines
+	const auto pixels          = static_cast<uint8_t*>(surface->pixels);
+	const auto bytes_per_pixel = surface->format->BytesPerPixel;
+
+	int y        = 0;
+	size_t index = 0;
+	while (y < sdl.draw.render_height_px) {
+		const int height_px = changedLines[index];
+		if (index & 1) {
+			const auto& columns = changedColumns[index];
+			const SDL_Rect rect = {columns.first,
+			                       y,
+			                       columns.last - columns.first,
+			                       height_px};
+			if (rect.w > 0) {
+				SDL_UpdateTexture(sdl.texture.texture,
+				                  &rect,
+				                  pixels + y * surface->pitch +
+				                          rect.x * bytes_per_pixel,
+				                  surface->pitch);
+			}
+		}
+		y += height_px;
+		index++;
+	}
 }
 
 static std::optional<RenderedImage> get_rendered_output_from_backbuffer()
@@ -2578,26 +2676,40 @@ static bool present_frame_texture()
 // OpenGL frame-based update and presentation
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 #if C_OPENGL
-static void update_frame_gl(const uint16_t* changedLines)
+static void update_frame_gl(const uint16_t* changedLines,
+                            const ChangedColumns* changedColumns)
 {
 	if (changedLines) {
 		const auto framebuf = static_cast<uint8_t *>(sdl.opengl.framebuf);
 		const auto pitch = sdl.opengl.pitch;
+
+		// Sub-rectangles are read out of the full width frame buffer
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, sdl.draw.render_width_px);
+
 		int y = 0;
 		size_t index = 0;
 		while (y < sdl.draw.render_height_px) {
 			if (!(index & 1)) {
 				y += changedLines[index];
 			} else {
-				const uint8_t *pixels = framebuf + y * pitch;
+				int x_px     = 0;
+				int width_px = sdl.draw.render_width_px;
+				if (changedColumns) {
+					x_px     = changedColumns[index].first;
+					width_px = changedColumns[index].last - x_px;
+				}
+				const uint8_t *pixels = framebuf + y * pitch + x_px * 4;
 				const int height_px = changedLines[index];
-				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y,
-				                sdl.draw.render_width_px, height_px, GL_BGRA_EXT,
-				                GL_UNSIGNED_INT_8_8_8_8_REV, pixels);
+				if (width_px > 0) {
+					glTexSubImage2D(GL_TEXTURE_2D, 0, x_px, y,
+					                width_px, height_px, GL_BGRA_EXT,
+					                GL_UNSIGNED_INT_8_8_8_8_REV, pixels);
+				}
 				y += height_px;
 			}
 			index++;
 		}
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 	} else {
 		sdl.opengl.actual_frame_count++;
 	}
@@ -3450,6 +3562,16 @@ static void read_gui_config(Section* sec)
 		sdl.display_number = 0;
 	}
 
+	const std::string frame_skipping_pref = section->Get_string(
+	        "skip_throttled_frames");
+	if (frame_skipping_pref == "on") {
+		sdl.frame.skipping = FrameSkipping::On;
+	} else if (frame_skipping_pref == "verify") {
+		sdl.frame.skipping = FrameSkipping::Verify;
+	} else {
+		sdl.frame.skipping = FrameSkipping::Off;
+	}
+
 	const std::string presentation_mode_pref = section->Get_string(
 	        "presentation_mode");
 	if (presentation_mode_pref == "auto")
@@ -3739,7 +3861,12 @@ bool GFX_Events()
 		MAPPER_UpdateJoysticks();
 	}
 #endif
-	while (SDL_PollEvent(&event)) {
+	// Events the queue has no room for stay in SDL's queue until the next
+	// call
+	while (!sdl.input_events.IsFull() && SDL_PollEvent(&event)) {
+		sdl.input_events.Push(event);
+	}
+	while (sdl.input_events.Pop(event)) {
 #if C_DEBUG
 		if (is_debugger_event(event)) {
 			pdc_event_queue.push(event);
@@ -4000,7 +4127,7 @@ bool GFX_Events()
 					bool paused = true;
 					while (paused && !shutdown_requested) {
 						// WaitEvent waits for an event rather than polling, so CPU usage drops to zero
-						SDL_WaitEvent(&ev);
+						wait_event(ev);
 
 						switch (ev.type) {
 						case SDL_QUIT:
@@ -4196,6 +4323,17 @@ static void messages_add_command_line()
 	        "\n"
 	        "  --socket <num>           Run nullmodem on the specified socket number.\n"
 	        "\n"
+	        "  --headless               Run as fast as possible without video and sound output,\n"
+	        "                           then print a JSON report of the cycles executed, the\n"
+	        "                           emulated and host time, and the frames rendered.\n"
+	        "                           Use a fixed 'cycles' setting for repeatable results.\n"
+	        "\n"
+	        "  --benchmark-ms <num>     Exit after <num> emulated milliseconds in headless mode.\n"
+	        "\n"
+	        "  --benchmark-mcycles <num>\n"
+	        "                           Exit after <num> million emulated cycles in headless\n"
+	        "                           mode. DOSBox executes one instruction per cycle.\n"
+	        "\n"
 	        "  -h, -?, --help           Print help message and exit.\n"
 	        "\n"
 	        "  -V, --version            Print version information and exit.\n");
@@ -4319,6 +4457,16 @@ static void config_add_sdl()
 	        "  vfr:   Always present changed DOS frames at a variable frame rate.");
 	pstring->Set_values({"auto", "cfr", "vfr"});
 
+	pstring = sdl_sec->Add_string("skip_throttled_frames", on_start, "off");
+	pstring->Set_help(
+	        "Skip drawing the DOS frames that the 'auto' presentation mode would drop\n"
+	        "because the host rate is lower than the DOS rate (experimental):\n"
+	        "  off:     Draw every frame (default).\n"
+	        "  on:      Don't draw the frames predicted not to be presented.\n"
+	        "  verify:  Draw every frame, and log the frames whose presentation would\n"
+	        "           differ if the predicted frames were skipped.");
+	pstring->Set_values({"off", "on", "verify"});
+
 #if C_OPENGL
 	const std::string default_output = "opengl";
 #else
@@ -4632,6 +4780,37 @@ static void override_wm_class()
 #endif
 }
 
+// Sends video and audio to SDL's dummy drivers, so benchmarks can run on
+// machines without a display or sound device
+static void setup_headless_mode(CommandLineArguments& arguments)
+{
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+	SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+
+	// Applied after the user's settings, so they can't be overridden.
+	// There's no OpenGL context without a display.
+	arguments.set.emplace_back("sdl output=texture");
+	arguments.set.emplace_back("mixer nosound=true");
+}
+
+static void start_benchmark(const CommandLineArguments& arguments)
+{
+	BenchmarkSettings settings = {};
+
+	if (arguments.benchmark_ms) {
+		settings.max_emulated_ms = std::max(*arguments.benchmark_ms, 0);
+	}
+	if (arguments.benchmark_mcycles) {
+		settings.max_cycles = static_cast<int64_t>(
+		                              std::max(*arguments.benchmark_mcycles, 0)) *
+		                      1'000'000;
+	}
+	if (settings.max_emulated_ms == 0 && settings.max_cycles == 0) {
+		LOG_MSG("BENCHMARK: Running headless without a budget until DOSBox exits");
+	}
+	BENCHMARK_Start(settings);
+}
+
 extern "C" int SDL_CDROMInit(void);
 
 int sdl_main(int argc, char* argv[])
@@ -4812,6 +4991,10 @@ int sdl_main(int argc, char* argv[])
 		// clicks on out-of-focus window are passed to the guest
 		SDL_SetHint(SDL_HINT_MOUSE_FOCUS_CLICKTHROUGH, "1");
 
+		if (arguments->headless) {
+			setup_headless_mode(*arguments);
+		}
+
 		if (const auto err = check_kmsdrm_setting(); err != 0) {
 			return err;
 		}
@@ -4933,9 +5116,15 @@ int sdl_main(int argc, char* argv[])
 			MAPPER_DisplayUI();
 		}
 
+		if (arguments->headless) {
+			start_benchmark(*arguments);
+		}
+
 		// Run the machine until shutdown
 		control->StartUp();
 
+		BENCHMARK_Report();
+
 		// Shutdown and release
 		control.reset();
 
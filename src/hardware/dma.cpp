@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <cstring>
 #include <memory>
+#include <vector>
 
 #include "dma.h"
 #include "mem.h"
@@ -53,21 +54,43 @@ static void UpdateEMSMapping()
 	}
 }
 
-// Generic function to read or write a block of data to or from memory.
-// Don't use this directly; call two helpers: DMA_BlockRead or DMA_BlockWrite
-static void perform_dma_io(const DMA_DIRECTION direction, const PhysPt spage,
-                           PhysPt mem_address, void* const data_start,
-                           const size_t num_words, const uint8_t is_dma16)
+// Walks the guest memory of a transfer as spans of consecutive physical
+// memory, calling on_span with each span's host pointer and size. The page
+// remapping of the first megabyte and the EMS page frame is resolved once
+// per 4 KB page, and pages that follow each other physically are merged into
+// one span. Memory past the end of RAM is passed as a null pointer.
+template <typename SpanFn>
+static void for_each_dma_span(const PhysPt spage, PhysPt mem_address,
+                              const size_t num_words, const uint8_t is_dma16,
+                              SpanFn&& on_span)
 {
 	assert(is_dma16 == 0 || is_dma16 == 1);
 
 	const auto highpart_addr_page = spage >> 12;
+	const auto ram_bytes = static_cast<size_t>(MEM_TotalPages()) * dos_pagesize;
 
 	// Maybe move the mem_address into the 16-bit range
 	mem_address <<= is_dma16;
 
-	// The data pointer will be incremented per transfer
-	auto data_pt = reinterpret_cast<uint8_t*>(data_start);
+	// The span being gathered
+	size_t span_start = 0;
+	size_t span_bytes = 0;
+
+	auto flush_span = [&]() {
+		if (span_bytes == 0) {
+			return;
+		}
+		// Clip the part of the span, if any, that lies past RAM
+		const auto in_ram = span_start < ram_bytes
+		                          ? std::min(span_bytes, ram_bytes - span_start)
+		                          : size_t(0);
+		if (in_ram) {
+			on_span(MemBase + span_start, in_ram);
+		}
+		if (in_ram < span_bytes) {
+			on_span(nullptr, span_bytes - in_ram);
+		}
+	};
 
 	// Convert from DMA 'words' to actual bytes, no greater than 64 KB
 	auto remaining_bytes = check_cast<uint16_t>(num_words << is_dma16);
@@ -86,30 +109,57 @@ static void perform_dma_io(const DMA_DIRECTION direction, const PhysPt spage,
 		const auto pos_in_page       = mem_address & (dos_pagesize - 1);
 		const auto bytes_to_page_end = check_cast<uint16_t>(
 		        dos_pagesize - pos_in_page);
-		const auto chunk_start = check_cast<PhysPt>(page * dos_pagesize +
-		                                            pos_in_page);
+		const auto chunk_start = static_cast<size_t>(page) * dos_pagesize +
+		                         pos_in_page;
 
 		// Determine how many bytes to transfer within this page
 		const auto chunk_bytes = std::min(remaining_bytes, bytes_to_page_end);
 
-		// Copy the data from the page address into the data pointer
+		// Extend the span if the chunk follows on from it
+		if (span_bytes && span_start + span_bytes == chunk_start) {
+			span_bytes += chunk_bytes;
+		} else {
+			flush_span();
+			span_start = chunk_start;
+			span_bytes = chunk_bytes;
+		}
+
+		mem_address += chunk_bytes;
+		remaining_bytes -= chunk_bytes;
+	} while (remaining_bytes);
+
+	flush_span();
+}
+
+// Generic function to read or write a block of data to or from memory.
+// Don't use this directly; call two helpers: DMA_BlockRead or DMA_BlockWrite
+static void perform_dma_io(const DMA_DIRECTION direction, const PhysPt spage,
+                           const PhysPt mem_address, void* const data_start,
+                           const size_t num_words, const uint8_t is_dma16)
+{
+	// The data pointer will be incremented per transfer
+	auto data_pt = reinterpret_cast<uint8_t*>(data_start);
+
+	auto copy_span = [&](uint8_t* const span, const size_t num_bytes) {
+		// Copy the data from the span into the data pointer
 		if (direction == DMA_DIRECTION::READ) {
-			for (auto i = 0; i < chunk_bytes; ++i) {
-				data_pt[i] = phys_readb(chunk_start + i);
+			if (span) {
+				std::memcpy(data_pt, span, num_bytes);
+			} else {
+				// Nothing drives the bus past the end of RAM
+				std::memset(data_pt, 0xff, num_bytes);
 			}
 		}
 
-		// Copy the data from the data pointer into the page address
-		else if (direction == DMA_DIRECTION::WRITE) {
-			for (auto i = 0; i < chunk_bytes; ++i) {
-				phys_writeb(chunk_start + i, data_pt[i]);
-			}
+		// Copy the data from the data pointer into the span
+		else if (direction == DMA_DIRECTION::WRITE && span) {
+			std::memcpy(span, data_pt, num_bytes);
 		}
 
-		mem_address += chunk_bytes;
-		data_pt += chunk_bytes;
-		remaining_bytes -= chunk_bytes;
-	} while (remaining_bytes);
+		data_pt += num_bytes;
+	};
+
+	for_each_dma_span(spage, mem_address, num_words, is_dma16, copy_span);
 }
 
 void TANDYSOUND_ShutDown(Section* = nullptr);
@@ -431,25 +481,56 @@ size_t DmaChannel::Write(const size_t words, uint8_t* const src_buffer)
 	return ReadOrWrite(DMA_DIRECTION::WRITE, words, src_buffer);
 }
 
+size_t DmaChannel::ReadSpans(const size_t words, const DMA_SpanCallback& on_span)
+{
+	// Memory past the end of RAM reads as an idle bus
+	static const std::vector<uint8_t> open_bus(dos_pagesize, 0xff);
+
+	auto pass_span = [&](const uint8_t* span, size_t num_bytes) {
+		if (span) {
+			on_span(span, num_bytes);
+			return;
+		}
+		while (num_bytes) {
+			const auto n = std::min(num_bytes, open_bus.size());
+			on_span(open_bus.data(), n);
+			num_bytes -= n;
+		}
+	};
+	auto read_spans = [&](const uint32_t address, const size_t num_words) {
+		for_each_dma_span(page_base, address, num_words, is_16bit, pass_span);
+	};
+	return Transfer(words, read_spans);
+}
+
 size_t DmaChannel::ReadOrWrite(const DMA_DIRECTION direction,
                                const size_t words, uint8_t* const buffer)
+{
+	// incremented per transfer
+	auto curr_buffer = buffer;
+
+	auto read_or_write = [&](const uint32_t address, const size_t num_words) {
+		perform_dma_io(direction, page_base, address, curr_buffer, num_words, is_16bit);
+		curr_buffer += num_words << is_16bit;
+	};
+	return Transfer(words, read_or_write);
+}
+
+size_t DmaChannel::Transfer(const size_t words, const transfer_fn& transfer)
 {
 	auto want     = check_cast<uint16_t>(words);
 	uint16_t done = 0;
 	curr_addr &= dma_wrapping;
 
-	// incremented per transfer
-	auto curr_buffer = buffer;
 again:
 	Bitu left = (curr_count + 1);
 	if (want < left) {
-		perform_dma_io(direction, page_base, curr_addr, curr_buffer, want, is_16bit);
+		transfer(curr_addr, want);
 		done += want;
 		curr_addr += want;
 		curr_count -= want;
 	} else {
-		perform_dma_io(direction, page_base, curr_addr, curr_buffer, left, is_16bit);
-		curr_buffer += left << is_16bit;
+		transfer(curr_addr, left);
 		want -= left;
 		done += left;
 		ReachedTerminalCount();
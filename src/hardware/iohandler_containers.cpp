@@ -21,9 +21,11 @@
 
 #include "dosbox.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <functional>
+#include <iterator>
 #include <limits>
 #include <unordered_map>
 
@@ -55,15 +57,172 @@ IO_WriteHandleObject::~IO_WriteHandleObject(){
 }
 
 // type-sized IO handlers
+//
+// The maps own the handlers as they were registered. Every IN and OUT is
+// dispatched through the dense per-width tables below instead, which hold a
+// call trampoline and its target for all 64K ports. Handlers that are plain
+// functions are called directly through their function pointer; only
+// lambdas and bound members go through the owned std::function.
+//
 std::unordered_map<io_port_t, io_read_f> io_read_handlers[io_widths] = {};
-constexpr auto &io_read_byte_handler = io_read_handlers[0];
-constexpr auto &io_read_word_handler = io_read_handlers[1];
-constexpr auto &io_read_dword_handler = io_read_handlers[2];
 
 std::unordered_map<io_port_t, io_write_f> io_write_handlers[io_widths] = {};
-constexpr auto &io_write_byte_handler = io_write_handlers[0];
-constexpr auto &io_write_word_handler = io_write_handlers[1];
-constexpr auto &io_write_dword_handler = io_write_handlers[2];
+
+union io_read_target_t {
+	const io_read_f *function;
+	io_val_t (*returns_val)(io_port_t, io_width_t);
+	uint8_t (*returns_byte)(io_port_t, io_width_t);
+	uint16_t (*returns_word)(io_port_t, io_width_t);
+};
+
+union io_write_target_t {
+	const io_write_f *function;
+	void (*takes_val)(io_port_t, io_val_t, io_width_t);
+};
+
+// An entry without a trampoline has no handler registered
+struct io_read_entry_t {
+	io_val_t (*call)(const io_read_target_t &, io_port_t, io_width_t) = nullptr;
+	io_read_target_t target = {nullptr};
+};
+
+struct io_write_entry_t {
+	void (*call)(const io_write_target_t &, io_port_t, io_val_t, io_width_t) = nullptr;
+	io_write_target_t target = {nullptr};
+};
+
+constexpr size_t io_ports = UINT16_MAX + 1;
+
+static io_read_entry_t io_read_dispatch[io_widths][io_ports]   = {};
+static io_write_entry_t io_write_dispatch[io_widths][io_ports] = {};
+
+constexpr int width_to_index(const io_width_t width)
+{
+	return width == io_width_t::byte ? 0 : (width == io_width_t::word ? 1 : 2);
+}
+
+static io_val_t call_read_function(const io_read_target_t &target,
+                                   const io_port_t port, const io_width_t width)
+{
+	return (*target.function)(port, width);
+}
+
+static io_val_t call_read_returns_val(const io_read_target_t &target,
+                                      const io_port_t port, const io_width_t width)
+{
+	return target.returns_val(port, width);
+}
+
+static io_val_t call_read_returns_byte(const io_read_target_t &target,
+                                       const io_port_t port, const io_width_t width)
+{
+	return target.returns_byte(port, width);
+}
+
+static io_val_t call_read_returns_word(const io_read_target_t &target,
+                                       const io_port_t port, const io_width_t width)
+{
+	return target.returns_word(port, width);
+}
+
+static void call_write_function(const io_write_target_t &target,
+                                const io_port_t port, const io_val_t val,
+                                const io_width_t width)
+{
+	(*target.function)(port, val, width);
+}
+
+static void call_write_takes_val(const io_write_target_t &target,
+                                 const io_port_t port, const io_val_t val,
+                                 const io_width_t width)
+{
+	target.takes_val(port, val, width);
+}
+
+// Unwraps the handler to its plain function, if it is one
+static io_read_entry_t make_read_entry(const io_read_f &handler)
+{
+	io_read_entry_t entry = {};
+	if (const auto f = handler.target<io_val_t (*)(io_port_t, io_width_t)>(); f) {
+		entry.call               = call_read_returns_val;
+		entry.target.returns_val = *f;
+	} else if (const auto f = handler.target<uint8_t (*)(io_port_t, io_width_t)>(); f) {
+		entry.call                = call_read_returns_byte;
+		entry.target.returns_byte = *f;
+	} else if (const auto f = handler.target<uint16_t (*)(io_port_t, io_width_t)>(); f) {
+		entry.call                = call_read_returns_word;
+		entry.target.returns_word = *f;
+	} else {
+		entry.call            = call_read_function;
+		entry.target.function = &handler;
+	}
+	return entry;
+}
+
+static io_write_entry_t make_write_entry(const io_write_f &handler)
+{
+	io_write_entry_t entry = {};
+	if (const auto f = handler.target<void (*)(io_port_t, io_val_t, io_width_t)>(); f) {
+		entry.call             = call_write_takes_val;
+		entry.target.takes_val = *f;
+	} else {
+		entry.call            = call_write_function;
+		entry.target.function = &handler;
+	}
+	return entry;
+}
+
+// The entries point into the map's nodes, which stay put when the map
+// rehashes, so they only need updating when a handler is added or removed.
+static void set_read_handler(const io_width_t width, const io_port_t port,
+                             const io_read_f &handler)
+{
+	const auto w = width_to_index(width);
+
+	auto &stored = io_read_handlers[w][port];
+	stored       = handler;
+
+	io_read_dispatch[w][port] = make_read_entry(stored);
+}
+
+static void set_write_handler(const io_width_t width, const io_port_t port,
+                              const io_write_f &handler)
+{
+	const auto w = width_to_index(width);
+
+	auto &stored = io_write_handlers[w][port];
+	stored       = handler;
+
+	io_write_dispatch[w][port] = make_write_entry(stored);
+}
+
+static void free_read_handler(const io_width_t width, const io_port_t port)
+{
+	const auto w = width_to_index(width);
+	io_read_handlers[w].erase(port);
+	io_read_dispatch[w][port] = {};
+}
+
+static void free_write_handler(const io_width_t width, const io_port_t port)
+{
+	const auto w = width_to_index(width);
+	io_write_handlers[w].erase(port);
+	io_write_dispatch[w][port] = {};
+}
+
+void clear_port_handlers()
+{
+	for (int w = 0; w < io_widths; ++w) {
+		io_read_handlers[w].clear();
+		io_write_handlers[w].clear();
+		std::fill(std::begin(io_read_dispatch[w]),
+		          std::end(io_read_dispatch[w]),
+		          io_read_entry_t{});
+		std::fill(std::begin(io_write_dispatch[w]),
+		          std::end(io_write_dispatch[w]),
+		          io_write_entry_t{});
+	}
+}
 
 constexpr io_val_t blocked_read(const io_port_t, const io_width_t)
 {
@@ -73,31 +232,34 @@ constexpr io_val_t blocked_read(const io_port_t, const io_width_t)
 // type-sized IO handler API
 uint8_t read_byte_from_port(const io_port_t port)
 {
-	const auto [it, was_blocked] = io_read_byte_handler.emplace(port, blocked_read);
-	if (was_blocked)
-		LOG(LOG_IO, LOG_WARN)("Unhandled read from port %04Xh; blocking", port);
-	return it->second(port, io_width_t::byte) & 0xff;
+	const auto &reader = io_read_dispatch[0][port];
+	if (reader.call) {
+		return reader.call(reader.target, port, io_width_t::byte) & 0xff;
+	}
+	LOG(LOG_IO, LOG_WARN)("Unhandled read from port %04Xh; blocking", port);
+	set_read_handler(io_width_t::byte, port, blocked_read);
+	return blocked_read(port, io_width_t::byte) & 0xff;
 }
 
 uint16_t read_word_from_port(const io_port_t port)
 {
-	const auto reader = io_read_word_handler.find(port);
-	const auto value = reader != io_read_word_handler.end()
-	                           ? (reader->second(port, io_width_t::word) & 0xffff)
-	                           : static_cast<io_val_t>(
-	                                     read_byte_from_port(port) |
-	                                     (read_byte_from_port(port + 1) << 8));
+	const auto &reader = io_read_dispatch[1][port];
+	const auto value = reader.call
+	                         ? (reader.call(reader.target, port, io_width_t::word) & 0xffff)
+	                         : static_cast<io_val_t>(
+	                                   read_byte_from_port(port) |
+	                                   (read_byte_from_port(port + 1) << 8));
 	return check_cast<uint16_t>(value);
 }
 
 uint32_t read_dword_from_port(const io_port_t port)
 {
-	const auto reader = io_read_dword_handler.find(port);
-	const auto value = reader != io_read_dword_handler.end()
-	                           ? reader->second(port, io_width_t::dword)
-	                           : static_cast<io_val_t>(
-	                                     read_word_from_port(port) |
-	                                     (read_word_from_port(port + 2) << 16));
+	const auto &reader = io_read_dispatch[2][port];
+	const auto value = reader.call
+	                         ? reader.call(reader.target, port, io_width_t::dword)
+	                         : static_cast<io_val_t>(
+	                                   read_word_from_port(port) |
+	                                   (read_word_from_port(port + 2) << 16));
 	assert(value <= UINT32_MAX);
 	return static_cast<uint32_t>(value);
 }
@@ -109,19 +271,22 @@ constexpr void blocked_write(const io_port_t, const io_val_t, const io_width_t)
 
 void write_byte_to_port(const io_port_t port, const uint8_t val)
 {
-	const auto [it, was_blocked] = io_write_byte_handler.emplace(port, blocked_write);
-	if (was_blocked)
-		LOG(LOG_IO, LOG_WARN)("Unhandled write of value 0x%02x"
-		                      " (%u) to port %04Xh; blocking",
-		                      val, val, port);
-	it->second(port, val, io_width_t::byte);
+	const auto &writer = io_write_dispatch[0][port];
+	if (writer.call) {
+		writer.call(writer.target, port, val, io_width_t::byte);
+		return;
+	}
+	LOG(LOG_IO, LOG_WARN)("Unhandled write of value 0x%02x"
+	                      " (%u) to port %04Xh; blocking",
+	                      val, val, port);
+	set_write_handler(io_width_t::byte, port, blocked_write);
 }
 
 void write_word_to_port(const io_port_t port, const uint16_t val)
 {
-	const auto writer = io_write_word_handler.find(port);
-	if (writer != io_write_word_handler.end()) {
-		writer->second(port, val, io_width_t::word);
+	const auto &writer = io_write_dispatch[1][port];
+	if (writer.call) {
+		writer.call(writer.target, port, val, io_width_t::word);
 	} else {
 		write_byte_to_port(port, static_cast<uint8_t>(val & 0xff));
 		write_byte_to_port(port + 1, static_cast<uint8_t>(val >> 8));
@@ -130,9 +295,9 @@ void write_word_to_port(const io_port_t port, const uint16_t val)
 
 void write_dword_to_port(const io_port_t port, const uint32_t val)
 {
-	const auto writer = io_write_dword_handler.find(port);
-	if (writer != io_write_dword_handler.end()) {
-		writer->second(port, val, io_width_t::dword);
+	const auto &writer = io_write_dispatch[2][port];
+	if (writer.call) {
+		writer.call(writer.target, port, val, io_width_t::dword);
 	} else {
 		write_word_to_port(port, static_cast<uint16_t>(val & 0xffff));
 		write_word_to_port(port + 2, static_cast<uint16_t>(val >> 16));
@@ -145,11 +310,11 @@ void IO_RegisterReadHandler(io_port_t port,
                             io_port_t range)
 {
 	while (range--) {
-		io_read_byte_handler[port] = handler;
+		set_read_handler(io_width_t::byte, port, handler);
 		if (max_width == io_width_t::word || max_width == io_width_t::dword)
-			io_read_word_handler[port] = handler;
+			set_read_handler(io_width_t::word, port, handler);
 		if (max_width == io_width_t::dword)
-			io_read_dword_handler[port] = handler;
+			set_read_handler(io_width_t::dword, port, handler);
 		++port;
 	}
 }
@@ -160,11 +325,11 @@ void IO_RegisterWriteHandler(io_port_t port,
                              io_port_t range)
 {
 	while (range--) {
-		io_write_byte_handler[port] = handler;
+		set_write_handler(io_width_t::byte, port, handler);
 		if (max_width == io_width_t::word || max_width == io_width_t::dword)
-			io_write_word_handler[port] = handler;
+			set_write_handler(io_width_t::word, port, handler);
 		if (max_width == io_width_t::dword)
-			io_write_dword_handler[port] = handler;
+			set_write_handler(io_width_t::dword, port, handler);
 		++port;
 	}
 }
@@ -174,11 +339,11 @@ void IO_FreeReadHandler(io_port_t port,
                         io_port_t range)
 {
 	while (range--) {
-		io_read_byte_handler.erase(port);
+		free_read_handler(io_width_t::byte, port);
 		if (max_width == io_width_t::word || max_width == io_width_t::dword)
-			io_read_word_handler.erase(port);
+			free_read_handler(io_width_t::word, port);
 		if (max_width == io_width_t::dword)
-			io_read_dword_handler.erase(port);
+			free_read_handler(io_width_t::dword, port);
 		++port;
 	}
 }
@@ -188,11 +353,11 @@ void IO_FreeWriteHandler(io_port_t port,
                          io_port_t range)
 {
 	while (range--) {
-		io_write_byte_handler.erase(port);
+		free_write_handler(io_width_t::byte, port);
 		if (width == io_width_t::word || width == io_width_t::dword)
-			io_write_word_handler.erase(port);
+			free_write_handler(io_width_t::word, port);
 		if (width == io_width_t::dword)
-			io_write_dword_handler.erase(port);
+			free_write_handler(io_width_t::dword, port);
 		++port;
 	}
 }
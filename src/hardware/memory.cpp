@@ -19,8 +19,11 @@
 
 #include "mem.h"
 
+#include <algorithm>
 #include <cstring>
 
+#include "free_page_runs.h"
+#include "host_memory.h"
 #include "inout.h"
 #include "paging.h"
 #include "pci_bus.h"
@@ -38,12 +41,16 @@ constexpr auto SafeMegabytesWin95 = 480;
 constexpr auto SafeMegabytesWin98 = 512;
 
 static struct MemoryBlock {
-	struct page_t {
-		uint8_t bytes[dos_pagesize] = {};
-	};
-	std::vector<page_t> pages           = {};
+	// Mapped from the host, committed as the guest touches it
+	HostMemory ram   = {};
+	size_t num_pages = 0;
+
 	std::vector<PageHandler*> phandlers = {};
 	std::vector<MemHandle> mhandles     = {};
+
+	// The unallocated XMS and EMS pages, that is the pages past XMS_START
+	// whose handle is 0
+	FreePageRuns free_runs = {};
 	struct {
 		Bitu start_page = 0;
 		Bitu end_page   = 0;
@@ -102,8 +109,8 @@ public:
 	// Get the starting byte address for the give page
 	HostPt GetHostReadPt(const size_t phys_page) override
 	{
-		assert(phys_page < memory.pages.size());
-		return &(memory.pages[phys_page].bytes[0]);
+		assert(phys_page < memory.num_pages);
+		return MemBase + phys_page * dos_pagesize;
 	}
 	HostPt GetHostWritePt(const size_t phys_page) override
 	{
@@ -151,7 +158,7 @@ void MEM_SetLFB(Bitu page, Bitu pages, PageHandler *handler, PageHandler *mmioha
 }
 
 PageHandler * MEM_GetPageHandler(Bitu phys_page) {
-	if (phys_page < memory.pages.size()) {
+	if (phys_page < memory.num_pages) {
 		return memory.phandlers[phys_page];
 	}
 	if (phys_page >= memory.lfb.start_page && phys_page < memory.lfb.end_page) {
@@ -203,22 +210,86 @@ void mem_strcpy(PhysPt dest,PhysPt src) {
 	mem_writeb_inline(dest,0);
 }
 
+// The block transfers below resolve the host pointer once per page and
+// copy the page's share with memcpy. Pages without a host pointer, such as
+// MMIO, the VGA window, ROM, and pages holding translated code, go through
+// their handlers a byte at a time, as do pages the TLB hasn't seen yet
+// until their first access maps them in.
+//
+// The heavy debugger checks memory read breakpoints on every byte, so it
+// keeps the byte-wise transfers.
+#if C_DEBUG && C_HEAVY_DEBUG
+constexpr bool use_host_pointers = false;
+#else
+constexpr bool use_host_pointers = true;
+#endif
+
+// The number of bytes from the address to the end of its page, at most size
+static size_t bytes_left_in_page(const PhysPt address, const size_t size)
+{
+	const size_t page_left = dos_pagesize - (address & (dos_pagesize - 1));
+	return std::min(size, page_left);
+}
+
 void mem_memcpy(PhysPt dest,PhysPt src,Bitu size) {
-	while (size--) mem_writeb_inline(dest++,mem_readb_inline(src++));
+	while (size) {
+		const auto chunk = bytes_left_in_page(dest, bytes_left_in_page(src, size));
+		const HostPt read  = use_host_pointers ? get_tlb_read(src) : nullptr;
+		const HostPt write = use_host_pointers ? get_tlb_write(dest) : nullptr;
+		if (read && write) {
+			const auto from = read + src;
+			const auto to   = write + dest;
+			if (to <= from || to >= from + chunk) {
+				std::memmove(to, from, chunk);
+			} else {
+				// Overlapping upwards: copy forwards like the
+				// guest would, repeating the pattern
+				for (size_t i = 0; i < chunk; ++i) {
+					to[i] = from[i];
+				}
+			}
+			dest += static_cast<PhysPt>(chunk);
+			src += static_cast<PhysPt>(chunk);
+			size -= chunk;
+		} else {
+			mem_writeb_inline(dest++, mem_readb_inline(src++));
+			--size;
+		}
+	}
 }
 
 void MEM_BlockRead(PhysPt pt,void * data,Bitu size) {
 	uint8_t * write=reinterpret_cast<uint8_t *>(data);
-	while (size--) {
-		*write++=mem_readb_inline(pt++);
+	while (size) {
+		const HostPt read = use_host_pointers ? get_tlb_read(pt) : nullptr;
+		if (read) {
+			const auto chunk = bytes_left_in_page(pt, size);
+			std::memcpy(write, read + pt, chunk);
+			pt += static_cast<PhysPt>(chunk);
+			write += chunk;
+			size -= chunk;
+		} else {
+			*write++ = mem_readb_inline(pt++);
+			--size;
+		}
 	}
 }
 
 void MEM_BlockWrite(PhysPt pt, const void *data, size_t size)
 {
 	const uint8_t *read = static_cast<const uint8_t *>(data);
-	while (size--) {
-		mem_writeb_inline(pt++,*read++);
+	while (size) {
+		const HostPt write = use_host_pointers ? get_tlb_write(pt) : nullptr;
+		if (write) {
+			const auto chunk = bytes_left_in_page(pt, size);
+			std::memcpy(write + pt, read, chunk);
+			pt += static_cast<PhysPt>(chunk);
+			read += chunk;
+			size -= chunk;
+		} else {
+			mem_writeb_inline(pt++, *read++);
+			--size;
+		}
 	}
 }
 
@@ -237,38 +308,17 @@ void MEM_StrCopy(PhysPt pt,char * data,Bitu size) {
 
 uint32_t MEM_TotalPages(void)
 {
-	return check_cast<uint32_t>(memory.pages.size());
+	return check_cast<uint32_t>(memory.num_pages);
 }
 
 uint32_t MEM_FreeLargest()
 {
-	uint32_t size    = 0;
-	uint32_t largest = 0;
-	size_t   index   = XMS_START;
-	while (index < memory.pages.size()) {
-		if (!memory.mhandles[index]) {
-			++size;
-		} else {
-			largest = std::max(size, largest);
-			size = 0;
-		}
-		++index;
-	}
-	largest = std::max(size, largest);
-	return largest;
+	return check_cast<uint32_t>(memory.free_runs.GetFreeLargest());
 }
 
 uint32_t MEM_FreeTotal()
 {
-	uint32_t free  = 0;
-	size_t   index = XMS_START;
-	while (index < memory.pages.size()) {
-		if (!memory.mhandles[index]) {
-			++free;
-		}
-		++index;
-	}
-	return free;
+	return check_cast<uint32_t>(memory.free_runs.GetFreeTotal());
 }
 
 uint32_t MEM_AllocatedPages(MemHandle handle) 
@@ -284,40 +334,42 @@ uint32_t MEM_AllocatedPages(MemHandle handle)
 
 //TODO Maybe some protection for this whole allocation scheme
 
-inline Bitu BestMatch(Bitu size) {
-	Bitu index=XMS_START;	
-	Bitu first=0;
-	Bitu best=0xfffffff;
-	Bitu best_first=0;
-	while (index < memory.pages.size()) {
-		/* Check if we are searching for first free page */
-		if (!first) {
-			/* Check if this is a free page */
-			if (!memory.mhandles[index]) {
-				first=index;	
-			}
-		} else {
-			/* Check if this still is used page */
-			if (memory.mhandles[index]) {
-				Bitu pages=index-first;
-				if (pages==size) {
-					return first;
-				} else if (pages>size) {
-					if (pages<best) {
-						best=pages;
-						best_first=first;
-					}
-				}
-				first=0;			//Always reset for new search
-			}
-		}
-		index++;
+// The smallest free run with at least 'size' pages, the lowest one among
+// equally small runs, or 0 if none fits
+static Bitu BestMatch(const Bitu size)
+{
+	return memory.free_runs.FindBestFit(size);
+}
+
+// Chains the pages [index, index + pages) after 'next', returning the
+// handle the chain continues from
+static MemHandle* chain_pages(MemHandle* next, const Bitu index, const Bitu pages)
+{
+	memory.free_runs.Allocate(index, pages);
+	for (Bitu i = 0; i < pages; ++i) {
+		*next = check_cast<MemHandle>(index + i);
+		next  = &memory.mhandles[index + i];
 	}
-	/* Check for the final block if we can */
-	if (first && (index-first>=size) && (index-first<best)) {
-		return first;
+	return next;
+}
+
+// Frees the chain starting at the handle, returning each stretch of
+// consecutive pages to the free runs in one go. A zero-size allocation's
+// handle is a page that was never allocated, so it's left alone.
+static void release_chain(MemHandle handle)
+{
+	while (handle > 0 && memory.mhandles[handle]) {
+		const auto first = handle;
+		size_t pages     = 0;
+		MemHandle last   = 0;
+		do {
+			last   = handle;
+			handle = memory.mhandles[last];
+			memory.mhandles[last] = 0;
+			++pages;
+		} while (handle == last + 1);
+		memory.free_runs.Release(first, pages);
 	}
-	return best_first;
 }
 
 MemHandle MEM_AllocatePages(Bitu pages,bool sequence) {
@@ -326,12 +378,7 @@ MemHandle MEM_AllocatePages(Bitu pages,bool sequence) {
 	if (sequence) {
 		Bitu index=BestMatch(pages);
 		if (!index) return 0;
-		MemHandle * next=&ret;
-		while (pages) {
-			*next=index;
-			next=&memory.mhandles[index];
-			index++;pages--;
-		}
+		MemHandle* next = chain_pages(&ret, index, pages);
 		*next=-1;
 	} else {
 		if (MEM_FreeTotal()<pages) return 0;
@@ -339,11 +386,9 @@ MemHandle MEM_AllocatePages(Bitu pages,bool sequence) {
 		while (pages) {
 			Bitu index=BestMatch(1);
 			if (!index) E_Exit("MEM:corruption during allocate");
-			while (pages && (!memory.mhandles[index])) {
-				*next=index;
-				next=&memory.mhandles[index];
-				index++;pages--;
-			}
+			const Bitu run = std::min<Bitu>(pages, memory.free_runs.GetRunLength(index));
+			next = chain_pages(next, index, run);
+			pages -= run;
 			*next=-1;		//Invalidate it in case we need another match
 		}
 	}
@@ -355,11 +400,7 @@ MemHandle MEM_GetNextFreePage(void) {
 }
 
 void MEM_ReleasePages(MemHandle handle) {
-	while (handle>0) {
-		MemHandle next=memory.mhandles[handle];
-		memory.mhandles[handle]=0;
-		handle=next;
-	}
+	release_chain(handle);
 }
 
 bool MEM_ReAllocatePages(MemHandle & handle,Bitu pages,bool sequence) {
@@ -373,6 +414,18 @@ bool MEM_ReAllocatePages(MemHandle & handle,Bitu pages,bool sequence) {
 		handle=-1;
 		return true;
 	}
+	if (!memory.mhandles[handle]) {
+		// A zero-size allocation holds no pages yet; it grows in place
+		// while the pages from its handle on are still free
+		if (sequence && memory.free_runs.IsFree(handle, pages)) {
+			*chain_pages(&handle, handle, pages) = -1;
+			return true;
+		}
+		const MemHandle newhandle = MEM_AllocatePages(pages, sequence);
+		if (!newhandle) return false;
+		handle=newhandle;
+		return true;
+	}
 	MemHandle index=handle;
 	MemHandle last;Bitu old_pages=0;
 	while (index>0) {
@@ -383,40 +436,26 @@ bool MEM_ReAllocatePages(MemHandle & handle,Bitu pages,bool sequence) {
 	if (old_pages == pages) return true;
 	if (old_pages > pages) {
 		/* Decrease size */
-		pages--;index=handle;old_pages--;
+		pages--;index=handle;
 		while (pages) {
 			index=memory.mhandles[index];
-			pages--;old_pages--;
+			pages--;
 		}
 		MemHandle next=memory.mhandles[index];
 		memory.mhandles[index]=-1;
-		index=next;
-		while (old_pages) {
-			next=memory.mhandles[index];
-			memory.mhandles[index]=0;
-			index=next;
-			old_pages--;
-		}
+		release_chain(next);
 		return true;
 	} else {
 		/* Increase size, check for enough free space */
 		Bitu need=pages-old_pages;
 		if (sequence) {
-			index=last+1;
-			Bitu free=0;
-			while (static_cast<uint32_t>(index) < memory.pages.size() &&
-			       !memory.mhandles[index]) {
-				index++;
-				free++;
-			}
+			const Bitu free = memory.free_runs.GetRunLength(last + 1);
 			if (free>=need) {
 				/* Enough space allocate more pages */
-				index=last;
-				while (need) {
-					memory.mhandles[index]=index+1;
-					need--;index++;
-				}
-				memory.mhandles[index]=-1;
+				MemHandle* next = chain_pages(&memory.mhandles[last],
+				                              last + 1,
+				                              need);
+				*next=-1;
 				return true;
 			} else {
 				/* Not Enough space allocate new block and copy */
@@ -710,6 +749,23 @@ static void check_num_megabytes(const int num_megabytes)
 	}
 }
 
+static HugePages get_huge_pages_setting(Section_prop* section)
+{
+	const std::string huge_pages = section->Get_string("memory_huge_pages");
+	if (huge_pages == "transparent") {
+		return HugePages::Transparent;
+	}
+	if (huge_pages == "explicit") {
+		return HugePages::Explicit;
+	}
+	return HugePages::Off;
+}
+
+std::optional<size_t> MEM_GetResidentBytes()
+{
+	return memory.ram.GetResidentBytes();
+}
+
 HostPt GetMemBase(void)
 {
 	return MemBase;
@@ -729,16 +785,23 @@ public:
 		check_num_megabytes(num_megabytes);
 		const auto num_pages = (num_megabytes * megabyte) / dos_pagesize;
 
-		// Size the actual memory pages
-		memory.pages.resize(num_pages);
+		// Map the memory pages, which the host commits on first touch
+		const auto huge_pages = get_huge_pages_setting(section);
+		memory.ram = HostMemory(static_cast<size_t>(num_pages) * dos_pagesize,
+		                        huge_pages);
+		memory.num_pages = num_pages;
 
 		// The MemBase is address of the first page's first byte
-		MemBase = &(memory.pages[0].bytes[0]);
+		MemBase = memory.ram.Data();
 
 		LOG_MSG("MEMORY: Using %d DOS memory pages (%u MB) at address: %p",
-		        static_cast<int>(memory.pages.size()),
+		        static_cast<int>(memory.num_pages),
 		        num_megabytes,
 		        static_cast<void*>(MemBase));
+		if (memory.ram.GetHugePages() != HugePages::Off) {
+			LOG_MSG("MEMORY: Backed by %s huge pages",
+			        to_string(memory.ram.GetHugePages()));
+		}
 
 		// Setup the page handlers, defaulting to the RAM handler
 		memory.phandlers.clear();
@@ -748,6 +811,7 @@ public:
 		// memory-allocation
 		memory.mhandles.clear();
 		memory.mhandles.resize(num_pages, 0);
+		memory.free_runs.Reset(XMS_START, std::max<size_t>(XMS_START, num_pages));
 
 		using page_range_t = std::pair<uint16_t, uint16_t>;
 		auto install_rom_page_handlers = [&](const page_range_t& page_range) {
@@ -775,6 +839,16 @@ public:
 		ReadHandler.Install(0x92, read_p92, io_width_t::byte);
 		InitA20();
 	}
+
+	~MEMORY() override
+	{
+		const auto resident_bytes = memory.ram.GetResidentBytes();
+		if (resident_bytes) {
+			LOG_MSG("MEMORY: %zu of %zu KB of guest memory was resident",
+			        *resident_bytes / 1024,
+			        memory.ram.Size() / 1024);
+		}
+	}
 };
 
 static MEMORY* test;
@@ -24,6 +24,8 @@
 #include "timer.h"
 #include "setup.h"
 
+#include <vector>
+
 // PIC Controllers
 // ~~~~~~~~~~~~~~~
 // The sources here identify the two Programmable Interrupt Controllers
@@ -38,8 +40,6 @@
 // "master-slave" relationship, which is misleading given that fact that the
 // primary has no control over the secondary.
 
-#define PIC_QUEUESIZE 512
-
 struct PIC_Controller {
 	Bitu icw_words;
 	Bitu icw_index;
@@ -190,18 +190,261 @@ void PIC_Controller::start_irq(uint8_t val) {
 }
 
 
+// PIC event queue
+// ~~~~~~~~~~~~~~~
+// Pending events are kept in a binary min-heap ordered by their index (the
+// fractional tick at which they are due). Events due at the same index run in
+// the order they were added, matching the previous sorted-list behaviour.
+//
+// Every entry is also linked into an intrusive list of the events that share
+// its handler, so removing a handler's events only touches those events
+// instead of scanning the whole queue. The entry pool grows on demand, so
+// events are never dropped when many devices are scheduling at once.
+
 struct PICEntry {
-	double index;
-	Bitu value;
-	PIC_EventHandler pic_event;
-	PICEntry * next;
+	double index               = 0.0;
+	uint64_t sequence          = 0;
+	PIC_EventHandler pic_event = nullptr;
+	uint32_t value             = 0;
+
+	// Position of this entry in the heap
+	uint32_t heap_pos = 0;
+
+	// Neighbours in the list of entries sharing this handler
+	uint32_t prev_for_handler = 0;
+	uint32_t next_for_handler = 0;
 };
 
-static struct {
-	PICEntry entries[PIC_QUEUESIZE];
-	PICEntry * free_entry;
-	PICEntry * next_entry;
-} pic_queue;
+class PicEventQueue {
+public:
+	PicEventQueue()
+	{
+		entries.reserve(initial_capacity);
+		free_ids.reserve(initial_capacity);
+		heap.reserve(initial_capacity);
+	}
+
+	bool IsEmpty() const
+	{
+		return heap.empty();
+	}
+
+	double NextIndex() const
+	{
+		assert(!IsEmpty());
+		return entries[heap.front()].index;
+	}
+
+	void Add(const PIC_EventHandler handler, const double index, const uint32_t value)
+	{
+		const auto id = AllocateEntry();
+
+		auto &entry     = entries[id];
+		entry.index     = index;
+		entry.sequence  = next_sequence++;
+		entry.pic_event = handler;
+		entry.value     = value;
+
+		LinkHandler(id);
+
+		entry.heap_pos = static_cast<uint32_t>(heap.size());
+		heap.push_back(id);
+		SiftUp(entry.heap_pos);
+	}
+
+	// Removes the next due entry and returns a copy of it
+	PICEntry PopNext()
+	{
+		assert(!IsEmpty());
+		const auto id     = heap.front();
+		const auto popped = entries[id];
+		Remove(id);
+		return popped;
+	}
+
+	void RemoveEvents(const PIC_EventHandler handler)
+	{
+		auto id = FindHandler(handler).head;
+		while (id != none) {
+			const auto next = entries[id].next_for_handler;
+			Remove(id);
+			id = next;
+		}
+	}
+
+	void RemoveSpecificEvents(const PIC_EventHandler handler, const uint32_t value)
+	{
+		auto id = FindHandler(handler).head;
+		while (id != none) {
+			const auto next = entries[id].next_for_handler;
+			if (entries[id].value == value) {
+				Remove(id);
+			}
+			id = next;
+		}
+	}
+
+	// Shifts all pending events one tick closer. A uniform shift keeps the
+	// heap ordering intact, so this is a single linear pass over the
+	// contiguous heap.
+	void AdvanceTick()
+	{
+		for (const auto id : heap) {
+			entries[id].index -= 1.0;
+		}
+	}
+
+	void Clear()
+	{
+		entries.clear();
+		free_ids.clear();
+		heap.clear();
+		handler_slots.clear();
+		next_sequence = 0;
+	}
+
+private:
+	static constexpr uint32_t none           = UINT32_MAX;
+	static constexpr size_t initial_capacity = 512;
+
+	uint32_t AllocateEntry()
+	{
+		if (!free_ids.empty()) {
+			const auto id = free_ids.back();
+			free_ids.pop_back();
+			return id;
+		}
+		assert(entries.size() < none);
+		entries.emplace_back();
+		return static_cast<uint32_t>(entries.size() - 1);
+	}
+
+	void Remove(const uint32_t id)
+	{
+		UnlinkHandler(id);
+
+		const auto pos  = entries[id].heap_pos;
+		const auto last = heap.back();
+		heap.pop_back();
+
+		if (last != id) {
+			heap[pos]              = last;
+			entries[last].heap_pos = pos;
+			if (!SiftUp(pos)) {
+				SiftDown(pos);
+			}
+		}
+		entries[id].pic_event = nullptr;
+		free_ids.push_back(id);
+	}
+
+	bool IsEarlier(const uint32_t a, const uint32_t b) const
+	{
+		const auto &lhs = entries[a];
+		const auto &rhs = entries[b];
+		if (lhs.index != rhs.index) {
+			return lhs.index < rhs.index;
+		}
+		return lhs.sequence < rhs.sequence;
+	}
+
+	void Place(const uint32_t pos, const uint32_t id)
+	{
+		heap[pos]            = id;
+		entries[id].heap_pos = pos;
+	}
+
+	// Returns true if the entry moved
+	bool SiftUp(uint32_t pos)
+	{
+		const auto id    = heap[pos];
+		const auto start = pos;
+		while (pos > 0) {
+			const auto parent = (pos - 1) / 2;
+			if (!IsEarlier(id, heap[parent])) {
+				break;
+			}
+			Place(pos, heap[parent]);
+			pos = parent;
+		}
+		Place(pos, id);
+		return pos != start;
+	}
+
+	void SiftDown(uint32_t pos)
+	{
+		const auto id   = heap[pos];
+		const auto size = static_cast<uint32_t>(heap.size());
+		while (true) {
+			auto child = 2 * pos + 1;
+			if (child >= size) {
+				break;
+			}
+			if (child + 1 < size && IsEarlier(heap[child + 1], heap[child])) {
+				++child;
+			}
+			if (!IsEarlier(heap[child], id)) {
+				break;
+			}
+			Place(pos, heap[child]);
+			pos = child;
+		}
+		Place(pos, id);
+	}
+
+	// Devices register a handful of distinct handlers, so a short flat
+	// table beats hashing. Slots are kept once created, even when empty.
+	struct HandlerSlot {
+		PIC_EventHandler handler = nullptr;
+		uint32_t head            = none;
+	};
+
+	HandlerSlot &FindHandler(const PIC_EventHandler handler)
+	{
+		for (auto &slot : handler_slots) {
+			if (slot.handler == handler) {
+				return slot;
+			}
+		}
+		return handler_slots.emplace_back(HandlerSlot{handler, none});
+	}
+
+	void LinkHandler(const uint32_t id)
+	{
+		auto &entry = entries[id];
+		auto &slot  = FindHandler(entry.pic_event);
+
+		entry.prev_for_handler = none;
+		entry.next_for_handler = slot.head;
+		if (slot.head != none) {
+			entries[slot.head].prev_for_handler = id;
+		}
+		slot.head = id;
+	}
+
+	void UnlinkHandler(const uint32_t id)
+	{
+		const auto &entry = entries[id];
+		if (entry.next_for_handler != none) {
+			entries[entry.next_for_handler].prev_for_handler = entry.prev_for_handler;
+		}
+		if (entry.prev_for_handler != none) {
+			entries[entry.prev_for_handler].next_for_handler = entry.next_for_handler;
+		} else {
+			FindHandler(entry.pic_event).head = entry.next_for_handler;
+		}
+	}
+
+	std::vector<PICEntry> entries = {};
+	std::vector<uint32_t> free_ids = {};
+	std::vector<uint32_t> heap     = {};
+
+	std::vector<HandlerSlot> handler_slots = {};
+
+	uint64_t next_sequence = 0;
+};
+
+static PicEventQueue pic_queue;
 
 static void write_command(io_port_t port, io_val_t value, io_width_t)
 {
@@ -422,37 +665,15 @@ void PIC_SetIRQMask(uint32_t irq, bool masked)
 	pic->set_imr(newmask);
 }
 
-static void AddEntry(PICEntry * entry) {
-	PICEntry * find_entry=pic_queue.next_entry;
-	if (find_entry == nullptr) {
-		entry->next=nullptr;
-		pic_queue.next_entry=entry;
-	} else if (find_entry->index > entry->index) {
-		pic_queue.next_entry=entry;
-		entry->next=find_entry;
-	} else {
-		while (find_entry) {
-			if (find_entry->next) {
-				/* See if the next index comes later than this
-				 * one */
-				if (find_entry->next->index > entry->index) {
-					entry->next      = find_entry->next;
-					find_entry->next = entry;
-					break;
-				} else {
-					find_entry = find_entry->next;
-				}
-			} else {
-				entry->next      = find_entry->next;
-				find_entry->next = entry;
-				break;
-			}
-		}
-	}
-	Bits cycles=PIC_MakeCycles(pic_queue.next_entry->index-PIC_TickIndex());
-	if (cycles<CPU_Cycles) {
-		CPU_CycleLeft+=CPU_Cycles;
-		CPU_Cycles=0;
+static void AddEntry(const PIC_EventHandler handler, const double index,
+                     const uint32_t value)
+{
+	pic_queue.Add(handler, index, value);
+
+	const auto cycles = PIC_MakeCycles(pic_queue.NextIndex() - PIC_TickIndex());
+	if (cycles < CPU_Cycles) {
+		CPU_CycleLeft += CPU_Cycles;
+		CPU_Cycles = 0;
 	}
 }
 static bool InEventService = false;
@@ -460,72 +681,20 @@ static double srv_lag = 0.0;
 
 void PIC_AddEvent(PIC_EventHandler handler, double delay, uint32_t val)
 {
-	if (!pic_queue.free_entry) {
-		LOG(LOG_PIC,LOG_ERROR)("Event queue full");
-		return;
-	}
-	PICEntry * entry=pic_queue.free_entry;
-	if(InEventService) entry->index = delay + srv_lag;
-	else entry->index = delay + PIC_TickIndex();
-
-	entry->pic_event=handler;
-	entry->value=val;
-	pic_queue.free_entry=pic_queue.free_entry->next;
-	AddEntry(entry);
+	const auto index = delay + (InEventService ? srv_lag : PIC_TickIndex());
+	AddEntry(handler, index, val);
 }
 
 void PIC_RemoveSpecificEvents(PIC_EventHandler handler, uint32_t val)
 {
-	PICEntry *entry = pic_queue.next_entry;
-	PICEntry *prev_entry;
-	prev_entry = nullptr;
-	while (entry) {
-		if ((entry->pic_event == handler) && (entry->value == val)) {
-			if (prev_entry) {
-				prev_entry->next=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=prev_entry->next;
-				continue;
-			} else {
-				pic_queue.next_entry=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=pic_queue.next_entry;
-				continue;
-			}
-		}
-		prev_entry=entry;
-		entry=entry->next;
-	}
+	pic_queue.RemoveSpecificEvents(handler, val);
 }
 
-void PIC_RemoveEvents(PIC_EventHandler handler) {
-	PICEntry * entry=pic_queue.next_entry;
-	PICEntry * prev_entry;
-	prev_entry=nullptr;
-	while (entry) {
-		if (entry->pic_event == handler) {
-			if (prev_entry) {
-				prev_entry->next=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=prev_entry->next;
-				continue;
-			} else {
-				pic_queue.next_entry=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=pic_queue.next_entry;
-				continue;
-			}
-		}
-		prev_entry=entry;
-		entry=entry->next;
-	}
+void PIC_RemoveEvents(PIC_EventHandler handler)
+{
+	pic_queue.RemoveEvents(handler);
 }
 
-
 bool PIC_RunQueue(void) {
 	/* Check to see if a new millisecond needs to be started */
 	CPU_CycleLeft+=CPU_Cycles;
@@ -538,24 +707,21 @@ bool PIC_RunQueue(void) {
 
 	/* Check the queue for an entry */
 	InEventService = true;
-	while (pic_queue.next_entry &&
-	       (pic_queue.next_entry->index * static_cast<double>(CPU_CycleMax) <= index_nd_f)) {
-		PICEntry *entry = pic_queue.next_entry;
-		pic_queue.next_entry = entry->next;
-
-		srv_lag = entry->index;
-		(entry->pic_event)(entry->value); // call the event handler
-
-		/* Put the entry in the free list */
-		entry->next=pic_queue.free_entry;
-		pic_queue.free_entry=entry;
+	while (!pic_queue.IsEmpty() &&
+	       (pic_queue.NextIndex() * static_cast<double>(CPU_CycleMax) <= index_nd_f)) {
+		// The entry is taken off the queue before its handler runs, so
+		// the handler is free to add or remove events
+		const auto entry = pic_queue.PopNext();
+
+		srv_lag = entry.index;
+		(entry.pic_event)(entry.value); // call the event handler
 	}
 	InEventService = false;
 
 	/* Check when to set the new cycle end */
-	if (pic_queue.next_entry) {
+	if (!pic_queue.IsEmpty()) {
 		auto cycles = static_cast<int32_t>(
-		        pic_queue.next_entry->index * static_cast<double>(CPU_CycleMax) -
+		        pic_queue.NextIndex() * static_cast<double>(CPU_CycleMax) -
 		        index_nd_f);
 		if (!cycles) {
 			cycles = 1;
@@ -607,11 +773,7 @@ void TIMER_AddTick(void) {
 	CPU_Cycles=0;
 	PIC_Ticks++;
 	/* Go through the list of scheduled events and lower their index with 1000 */
-	PICEntry * entry=pic_queue.next_entry;
-	while (entry) {
-		entry->index -= 1.0f;
-		entry=entry->next;
-	}
+	pic_queue.AdvanceTick();
 	/* Call our list of ticker handlers */
 	TickerBlock * ticker=firstticker;
 	while (ticker) {
@@ -674,12 +836,7 @@ public:
 		WriteHandler[2].Install(0xa0, write_command, io_width_t::byte);
 		WriteHandler[3].Install(0xa1, write_data, io_width_t::byte);
 		/* Initialize the pic queue */
-		for (i=0;i<PIC_QUEUESIZE-1;i++) {
-			pic_queue.entries[i].next=&pic_queue.entries[i+1];
-		}
-		pic_queue.entries[PIC_QUEUESIZE-1].next=nullptr;
-		pic_queue.free_entry=&pic_queue.entries[0];
-		pic_queue.next_entry=nullptr;
+		pic_queue.Clear();
 	}
 
 	~PIC_8259A(){
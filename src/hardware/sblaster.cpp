@@ -863,6 +863,24 @@ static uint32_t read_dma_16bit(const uint32_t bytes_to_read, const uint32_t i =
 	return check_cast<uint32_t>(bytes_read);
 }
 
+// 8-bit mono frames are single bytes, so they go to the mixer straight from
+// guest memory without passing through the DMA buffer
+static uint32_t play_dma_8bit_mono(const uint32_t bytes_to_read)
+{
+	auto add_samples = [](const uint8_t* data, const size_t num_bytes) {
+		const auto frames = check_cast<uint16_t>(num_bytes);
+		if (sb.dma.sign) {
+			sb.chan->AddSamples_m8s(frames,
+			                        reinterpret_cast<const int8_t*>(data));
+		} else {
+			sb.chan->AddSamples_m8(frames, data);
+		}
+	};
+	const auto bytes_read = sb.dma.chan->ReadSpans(bytes_to_read, add_samples);
+
+	return check_cast<uint32_t>(bytes_read);
+}
+
 static void play_dma_transfer(const uint32_t bytes_requested)
 {
 	// How many bytes should we read from DMA?
@@ -973,7 +991,13 @@ static void play_dma_transfer(const uint32_t bytes_requested)
 				sb.dma.remain_size = 0;
 			}
 
-		} else { // Mono
+		} else if (!sb.dsp.warmup_remaining_ms) { // Mono
+			bytes_read = play_dma_8bit_mono(bytes_to_read);
+			samples    = bytes_read;
+			frames     = check_cast<uint16_t>(samples / channels);
+			assert(channels == 1 && frames == samples); // sanity-check
+			                                            // mono
+		} else { // Mono, warming up
 			bytes_read = read_dma_8bit(bytes_to_read);
 			samples    = bytes_read;
 			frames     = check_cast<uint16_t>(samples / channels);
@@ -41,7 +41,6 @@ uint32_t TXT_Font_Table[16];
 uint32_t TXT_FG_Table[16];
 uint32_t TXT_BG_Table[16];
 uint32_t ExpandTable[256];
-uint32_t Expand16Table[4][16];
 uint32_t FillTable[16];
 
 void VGA_LogInitialization(const char *adapter_name,
@@ -408,7 +407,7 @@ void VGA_Init(Section* sec)
 /* Generate tables */
 	VGA_SetCGA2Table(0,1);
 	VGA_SetCGA4Table(0,1,2,3);
-	Bitu i,j;
+	Bitu i;
 	for (i=0;i<256;i++) {
 		ExpandTable[i]=i | (i << 8)| (i <<16) | (i << 24);
 	}
@@ -439,23 +438,6 @@ void VGA_Init(Section* sec)
 			((i & 8) ? 0x000000ff : 0) ;
 #endif
 	}
-	for (j=0;j<4;j++) {
-		for (i=0;i<16;i++) {
-#ifdef WORDS_BIGENDIAN
-			Expand16Table[j][i] =
-				((i & 1) ? 1 << j : 0) |
-				((i & 2) ? 1 << (8 + j) : 0) |
-				((i & 4) ? 1 << (16 + j) : 0) |
-				((i & 8) ? 1 << (24 + j) : 0);
-#else
-			Expand16Table[j][i] =
-				((i & 1) ? 1 << (24 + j) : 0) |
-				((i & 2) ? 1 << (16 + j) : 0) |
-				((i & 4) ? 1 << (8 + j) : 0) |
-				((i & 8) ? 1 << j : 0);
-#endif
-		}
-	}
 }
 
 void SVGA_Setup_Driver(void) {
@@ -23,6 +23,7 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 #include <utility>
@@ -36,6 +37,7 @@
 #include "reelmagic.h"
 #include "render.h"
 #include "rgb565.h"
+#include "text_glyph_cache.h"
 #include "vga.h"
 #include "video.h"
 
@@ -794,13 +796,35 @@ static uint8_t *VGA_TEXT_Herc_Draw_Line(Bitu vidstart, Bitu line)
 	}
 	return TempLine;
 }
+
+// The pixels of the character rows drawn with the DAC palette
+static TextGlyphCache text_glyph_cache = {};
+
+#if C_DEBUG
+// Timing every line is only worth it when the debugger can show it
+static struct {
+	uint64_t lines   = 0;
+	uint64_t draw_ns = 0;
+} text_draw_stats = {};
+#endif
+
 // combined 8/9-dot wide text mode line drawing function
 static uint8_t* draw_text_line_from_dac_palette(Bitu vidstart, Bitu line)
 {
+#if C_DEBUG
+	const auto start = std::chrono::steady_clock::now();
+#endif
 	// pointer to chars+attribs
 	const uint8_t* vidmem  = VGA_Text_Memwrap(vidstart);
 	const auto palette_map = vga.dac.palette_map;
 
+	// The cell colours index the first 16 palette entries
+	TextGlyphCache::Colours colours = {};
+	for (size_t i = 0; i < colours.size(); ++i) {
+		colours[i] = palette_map[i];
+	}
+	text_glyph_cache.SetColours(colours);
+
 	auto blocks = vga.draw.blocks;
 	if (vga.draw.panning) {
 		++blocks; // if the text is panned part of an
@@ -815,6 +839,8 @@ static uint8_t* draw_text_line_from_dac_palette(Bitu vidstart, Bitu line)
 	// pixel and also per character block.
 	auto draw_idx = draw_idx_start;
 
+	const uint8_t glyph_width = vga.seq.clocking_mode.is_eight_dot_mode ? 8 : 9;
+
 	while (blocks--) { // for each character in the line
 		const auto chr  = *vidmem++;
 		const auto attr = *vidmem++;
@@ -838,18 +864,7 @@ static uint8_t* draw_text_line_from_dac_palette(Bitu vidstart, Bitu line)
 			bg_palette_idx = fg_palette_idx;
 		}
 
-		// The font's bits will indicate which color is used per pixel
-		const auto fg_colour = palette_map[fg_palette_idx];
-		const auto bg_colour = palette_map[bg_palette_idx];
-
-		if (vga.seq.clocking_mode.is_eight_dot_mode) {
-			for (auto n = 0; n < 8; ++n) {
-				const auto color = (font & 0x80) ? fg_colour
-				                                 : bg_colour;
-				write_unaligned_uint32_at(TempLine, draw_idx++, color);
-				font <<= 1;
-			}
-		} else {
+		if (glyph_width == 9) {
 			font <<= 1; // 9 pixels
 			// Extend to the 9th pixel if needed
 			if ((font & 0x2) &&
@@ -857,13 +872,17 @@ static uint8_t* draw_text_line_from_dac_palette(Bitu vidstart, Bitu line)
 			    (chr >= 0xc0) && (chr <= 0xdf)) {
 				font |= 1;
 			}
-			for (auto n = 0; n < 9; ++n) {
-				const auto color = (font & 0x100) ? fg_colour
-				                                  : bg_colour;
-				write_unaligned_uint32_at(TempLine, draw_idx++, color);
-				font <<= 1;
-			}
 		}
+
+		// The font's bits indicate which color is used per pixel
+		const auto pixels = text_glyph_cache.GetRow(font,
+		                                            glyph_width,
+		                                            fg_palette_idx,
+		                                            bg_palette_idx);
+		memcpy(&TempLine[draw_idx * sizeof(uint32_t)],
+		       pixels,
+		       glyph_width * sizeof(uint32_t));
+		draw_idx += glyph_width;
 	}
 	// draw the text mode cursor if needed
 	if (!SkipCursor(vidstart, line)) {
@@ -889,9 +908,42 @@ static uint8_t* draw_text_line_from_dac_palette(Bitu vidstart, Bitu line)
 			}
 		}
 	}
+#if C_DEBUG
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	text_draw_stats.draw_ns += static_cast<uint64_t>(
+	        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	++text_draw_stats.lines;
+#endif
 	return TempLine + 32;
 }
 
+void VGA_LogTextCacheStats()
+{
+	const auto& cache = text_glyph_cache;
+
+	const auto lookups   = cache.hits + cache.misses;
+	const auto hit_ratio = lookups ? static_cast<double>(cache.hits) /
+	                                         static_cast<double>(lookups)
+	                               : 0.0;
+	LOG_MSG("TEXTCACHE: %lld hits, %lld misses (%.2f%% hits), %lld flushes",
+	        static_cast<long long>(cache.hits),
+	        static_cast<long long>(cache.misses),
+	        hit_ratio * 100,
+	        static_cast<long long>(cache.flushes));
+#if C_DEBUG
+	const auto& s = text_draw_stats;
+	if (s.lines) {
+		const auto ns_per_line = static_cast<double>(s.draw_ns) /
+		                         static_cast<double>(s.lines);
+		LOG_MSG("TEXTCACHE: %lld lines drawn, %.0f ns per line, %.1f us per %d-line frame",
+		        static_cast<long long>(s.lines),
+		        ns_per_line,
+		        ns_per_line * vga.draw.lines_total / 1000,
+		        static_cast<int>(vga.draw.lines_total));
+	}
+#endif
+}
+
 #ifdef VGA_KEEP_CHANGES
 static inline void VGA_ChangesEnd(void ) {
 	if ( vga.changes.active ) {
@@ -31,6 +31,7 @@
 #include "mem_host.h"
 #include "paging.h"
 #include "pic.h"
+#include "planar_to_chunky.h"
 #include "setup.h"
 #include "vga.h"
 
@@ -119,6 +120,14 @@ static struct {
 	Bitu base, mask;
 } vgapages;
 
+// Converts the planes of EGA addresses into the pixel buffer that's drawn
+static void update_planar_pixels(const PhysPt address, const size_t num_addresses)
+{
+	planar_to_chunky(&vga.mem.linear[address * planar_bytes_per_address],
+	                 &vga.fastmem[address * chunky_bytes_per_address],
+	                 num_addresses);
+}
+
 static void read_delay()
 {
 	if (vga.vmem_delay_ns > 0) {
@@ -129,11 +138,11 @@ static void read_delay()
 	}
 }
 
-static void write_delay()
+static void write_delay(const int32_t num_writes = 1)
 {
 	if (vga.vmem_delay_ns > 0) {
 		const int32_t delay_cycles = (CPU_CycleMax * vga.vmem_delay_ns * 3) /
-		                             (1000000 * 4);
+		                             (1000000 * 4) * num_writes;
 		CPU_Cycles -= delay_cycles;
 		CPU_IODelayRemoved += delay_cycles;
 	}
@@ -194,29 +203,8 @@ public:
 	void writeHandler(PhysPt start, uint8_t val) {
 		ModeOperation(val);
 		/* Update video memory and the pixel buffer */
-		VgaLatch pixels;
 		vga.mem.linear[start] = val;
-		start >>= 2;
-		pixels.d=((uint32_t*)vga.mem.linear)[start];
-
-		uint8_t * write_pixels=&vga.fastmem[start<<3];
-
-		uint32_t colors0_3, colors4_7;
-		VgaLatch temp;
-		temp.d=(pixels.d>>4) & 0x0f0f0f0f;
-		colors0_3 = 
-			Expand16Table[0][temp.b[0]] |
-			Expand16Table[1][temp.b[1]] |
-			Expand16Table[2][temp.b[2]] |
-			Expand16Table[3][temp.b[3]];
-		*(uint32_t *)write_pixels=colors0_3;
-		temp.d=pixels.d & 0x0f0f0f0f; //-V519
-		colors4_7 = 
-			Expand16Table[0][temp.b[0]] |
-			Expand16Table[1][temp.b[1]] |
-			Expand16Table[2][temp.b[2]] |
-			Expand16Table[3][temp.b[3]];
-		*(uint32_t *)(write_pixels+4)=colors4_7;
+		update_planar_pixels(start >> 2, 1);
 	}
 public:	
 	VGA_ChainedEGA_Handler()  {
@@ -291,36 +279,57 @@ public:
 
 class VGA_UnchainedEGA_Handler : public VGA_UnchainedRead_Handler {
 public:
-	void writeHandler(PhysPt start, uint8_t val) {
+	void writePlanes(PhysPt start, uint8_t val) {
 		uint32_t data=ModeOperation(val);
-		/* Update video memory and the pixel buffer */
+		/* Update video memory */
 		VgaLatch pixels;
 		pixels.d=((uint32_t*)vga.mem.linear)[start];
 		pixels.d&=vga.config.full_not_map_mask;
 		pixels.d|=(data & vga.config.full_map_mask);
 		((uint32_t*)vga.mem.linear)[start]=pixels.d;
-		uint8_t * write_pixels=&vga.fastmem[start<<3];
-
-		uint32_t colors0_3, colors4_7;
-		VgaLatch temp;
-		temp.d=(pixels.d>>4) & 0x0f0f0f0f;
-			colors0_3 = 
-			Expand16Table[0][temp.b[0]] |
-			Expand16Table[1][temp.b[1]] |
-			Expand16Table[2][temp.b[2]] |
-			Expand16Table[3][temp.b[3]];
-		*(uint32_t *)write_pixels=colors0_3;
-		temp.d=pixels.d & 0x0f0f0f0f; //-V519
-		colors4_7 = 
-			Expand16Table[0][temp.b[0]] |
-			Expand16Table[1][temp.b[1]] |
-			Expand16Table[2][temp.b[2]] |
-			Expand16Table[3][temp.b[3]];
-		*(uint32_t *)(write_pixels+4)=colors4_7;
+	}
+	void writeHandler(PhysPt start, uint8_t val) {
+		writePlanes(start, val);
+		/* Update the pixel buffer */
+		update_planar_pixels(start, 1);
 	}
 public:	
 	VGA_UnchainedEGA_Handler()  {
-		flags=PFLAG_NOCODE;
+		flags=PFLAG_NOCODE|PFLAG_BLOCKWRITE;
+	}
+
+	// Block transfers to the window, as in latched blits and fills. The
+	// planes are written a byte at a time as usual, and then the pixels
+	// of each run of consecutive addresses are converted in one go.
+	void writeblock(PhysPt addr, const uint8_t* data,
+	                const size_t num_values, const size_t width) override
+	{
+		write_delay(check_cast<int32_t>(num_values));
+		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
+		addr += vga.svga.bank_write_full;
+
+		PhysPt run_start  = 0;
+		size_t run_length = 0;
+		for (size_t i = 0; i < num_values; ++i) {
+			const auto start = CHECKED2(addr);
+			MEM_CHANGED(start << 3);
+			for (size_t b = 0; b < width; ++b) {
+				writePlanes(start + static_cast<PhysPt>(b), data[b]);
+			}
+			if (run_length && start != run_start + run_length) {
+				update_planar_pixels(run_start, run_length);
+				run_length = 0;
+			}
+			if (!run_length) {
+				run_start = start;
+			}
+			run_length += width;
+			addr += static_cast<PhysPt>(width);
+			data += width;
+		}
+		if (run_length) {
+			update_planar_pixels(run_start, run_length);
+		}
 	}
 
 	void writeb(PhysPt addr, uint8_t val) override
@@ -362,7 +371,7 @@ public:
 class VGA_ChainedVGA_Handler final : public PageHandler {
 public:
 	VGA_ChainedVGA_Handler()  {
-		flags=PFLAG_NOCODE;
+		flags=PFLAG_NOCODE|PFLAG_BLOCKWRITE;
 	}
 	static inline uint8_t *ToLinear(PhysPt addr)
 	{
@@ -514,6 +523,31 @@ public:
 		}
 		writeCache_dword(addr, val);
 	}
+
+	// Block transfers to the window, such as REP MOVSD blits. The bytes
+	// land where the per-value writes would put them, but the page is
+	// resolved once and there's no call per value.
+	void writeblock(PhysPt addr, const uint8_t* data,
+	                const size_t num_values, const size_t width) override
+	{
+		write_delay(check_cast<int32_t>(num_values));
+		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
+		addr += vga.svga.bank_write_full;
+		for (size_t i = 0; i < num_values; ++i) {
+			const auto start = CHECKED(addr);
+			MEM_CHANGED(start);
+			for (size_t b = 0; b < width; ++b) {
+				writeHandler_byte(start + b, data[b]);
+			}
+			// The first line's replica is keyed to where the value starts
+			std::memcpy(&vga.fastmem[start], data, width);
+			if (start < 320) {
+				std::memcpy(&vga.fastmem[start + 64 * 1024], data, width);
+			}
+			addr += static_cast<PhysPt>(width);
+			data += width;
+		}
+	}
 };
 
 class VGA_UnchainedVGA_Handler final : public VGA_UnchainedRead_Handler {
@@ -530,7 +564,27 @@ public:
 	}
 public:
 	VGA_UnchainedVGA_Handler()  {
-		flags=PFLAG_NOCODE;
+		flags=PFLAG_NOCODE|PFLAG_BLOCKWRITE;
+	}
+
+	// Block transfers to the window, as in mode X blits. The map mask
+	// and the write mode apply to every byte as they would one at a time,
+	// but the page is resolved once and there's no call per value.
+	void writeblock(PhysPt addr, const uint8_t* data,
+	                const size_t num_values, const size_t width) override
+	{
+		write_delay(check_cast<int32_t>(num_values));
+		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
+		addr += vga.svga.bank_write_full;
+		for (size_t i = 0; i < num_values; ++i) {
+			const auto start = CHECKED2(addr);
+			MEM_CHANGED(start << 2);
+			for (size_t b = 0; b < width; ++b) {
+				writeHandler(start + static_cast<PhysPt>(b), data[b]);
+			}
+			addr += static_cast<PhysPt>(width);
+			data += width;
+		}
 	}
 
 	void writeb(PhysPt addr, uint8_t val) override
@@ -0,0 +1,161 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "auto_cycles.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// A window is acted on after this much emulated or busy host time
+constexpr int64_t window_ms = 100;
+
+// ... or sooner when the emulation falls this far behind real time, so the
+// cycles come down quickly when the host can't keep up
+constexpr int64_t behind_min_ms = 5;
+constexpr double behind_usage   = 3.0;
+
+// Windows using more than this were disturbed by the host, for example by a
+// suspended process or another application hogging the CPU, and are skipped
+constexpr double dropout_usage = 100.0;
+constexpr double stall_usage   = 8.0;
+constexpr int64_t stall_min_us = 700'000;
+
+// Settle a little below the target so normal jitter doesn't push the
+// emulation behind real time
+const double setpoint_margin = std::log(1.03);
+
+// Adjusting stops within the inner band around the setpoint and resumes when
+// the usage leaves the outer band
+const double inner_band = std::log(1.01);
+const double outer_band = std::log(1.03);
+
+// Smoothing of the measured usage; the proportional gain matches it so the
+// controller's zero cancels the filter's pole, and the loop gain of 0.5
+// halves the remaining error every window.
+constexpr double smoothing = 0.5;
+constexpr double gain_p    = 0.5;
+constexpr double gain_i    = 0.5;
+
+// Bounds one adjustment in case a measurement slips past the checks above
+const double max_step_up   = std::log(2.0);
+const double max_step_down = std::log(4.0);
+
+static bool is_window_complete(const AutoCycles::Sample& sample)
+{
+	const auto busy_us = sample.elapsed_us - sample.idle_us;
+
+	if (sample.emulated_ms >= window_ms || busy_us >= window_ms * 1000) {
+		return true;
+	}
+	return sample.emulated_ms >= behind_min_ms &&
+	       static_cast<double>(busy_us) >=
+	               behind_usage * static_cast<double>(sample.emulated_ms * 1000);
+}
+
+std::optional<int32_t> AutoCycles::Update(const int32_t current_cycles,
+                                          const Settings& settings,
+                                          const Sample& sample)
+{
+	assert(current_cycles > 0);
+	assert(settings.min_cycles > 0 && settings.min_cycles <= settings.max_cycles);
+
+	if (!is_window_complete(sample)) {
+		return {};
+	}
+	if (sample.emulated_ms <= 0) {
+		return current_cycles;
+	}
+
+	const auto busy_us = std::max<int64_t>(sample.elapsed_us - sample.idle_us, 1);
+	const auto usage   = static_cast<double>(busy_us) /
+	                   static_cast<double>(sample.emulated_ms * 1000);
+
+	if (usage > dropout_usage ||
+	    (usage > stall_usage && sample.elapsed_us >= stall_min_us)) {
+		return current_cycles;
+	}
+
+	// Cycles skipped by the IO delay took no host time, so the cycles that
+	// did run are costlier than the usage suggests
+	const auto scheduled_cycles = static_cast<double>(current_cycles) *
+	                              static_cast<double>(sample.emulated_ms);
+	const auto skipped_ratio = static_cast<double>(sample.io_delay_cycles) /
+	                           scheduled_cycles;
+	if (skipped_ratio >= 1.0) {
+		return current_cycles;
+	}
+	const auto measured = std::log(usage / (1.0 - std::max(skipped_ratio, 0.0)));
+
+	setpoint = std::log(settings.target_usage) - setpoint_margin;
+
+	if (has_measurement) {
+		log_usage = smoothing * log_usage + (1.0 - smoothing) * measured;
+	} else {
+		// Start as if the filter had settled on the first measurement
+		log_usage       = measured;
+		previous_error  = setpoint - log_usage;
+		has_measurement = true;
+	}
+
+	const auto error = setpoint - log_usage;
+
+	if (adjusting && std::abs(error) < inner_band) {
+		adjusting = false;
+	} else if (!adjusting && std::abs(error) > outer_band) {
+		adjusting = true;
+	}
+
+	auto step = 0.0;
+	if (adjusting) {
+		// Velocity form: the integral term is the step itself
+		step = (gain_p + gain_i) * error - gain_p * previous_error;
+		step = std::clamp(step, -max_step_down, max_step_up);
+	}
+	previous_error = error;
+
+	const auto new_cycles = std::exp(std::log(static_cast<double>(current_cycles)) + step);
+
+	return static_cast<int32_t>(std::clamp(std::lround(new_cycles),
+	                                       static_cast<long>(settings.min_cycles),
+	                                       static_cast<long>(settings.max_cycles)));
+}
+
+void AutoCycles::Reset()
+{
+	has_measurement = false;
+	adjusting       = true;
+	previous_error  = 0.0;
+}
+
+double AutoCycles::GetSetpoint() const
+{
+	return std::exp(setpoint);
+}
+
+double AutoCycles::GetMeasuredUsage() const
+{
+	return has_measurement ? std::exp(log_usage) : 0.0;
+}
+
+bool AutoCycles::IsAdjusting() const
+{
+	return adjusting;
+}
@@ -0,0 +1,190 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "benchmark.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+
+#include "dosbox.h"
+
+using benchmark_clock = std::chrono::steady_clock;
+
+enum class CoreType { Normal, Simple, Full, Prefetch, Dynamic, Other, NumTypes };
+
+constexpr std::array<const char*, static_cast<size_t>(CoreType::NumTypes)> core_names = {
+        "normal", "simple", "full", "prefetch", "dynamic", "other"};
+
+struct CoreCounters {
+	int64_t cycles  = 0;
+	int64_t host_ns = 0;
+};
+
+static struct {
+	bool active = false;
+
+	BenchmarkSettings settings = {};
+
+	benchmark_clock::time_point start_time  = {};
+	benchmark_clock::time_point slice_start = {};
+
+	int64_t slice_cycles = 0;
+
+	int64_t cycles         = 0;
+	int64_t emulated_ms    = 0;
+	int64_t frames         = 0;
+	int64_t changed_frames = 0;
+
+	std::array<CoreCounters, static_cast<size_t>(CoreType::NumTypes)> cores = {};
+} benchmark = {};
+
+static CoreType get_core_type(CPU_Decoder* core)
+{
+	// The trap variants single-step the same core after a POPF or IRET
+	// that sets the trap flag
+	if (core == CPU_Core_Normal_Run || core == CPU_Core_Normal_Trap_Run) {
+		return CoreType::Normal;
+	}
+	if (core == CPU_Core_Simple_Run || core == CPU_Core_Simple_Trap_Run) {
+		return CoreType::Simple;
+	}
+	if (core == CPU_Core_Full_Run) {
+		return CoreType::Full;
+	}
+	if (core == CPU_Core_Prefetch_Run || core == CPU_Core_Prefetch_Trap_Run) {
+		return CoreType::Prefetch;
+	}
+#if C_DYNAMIC_X86
+	if (core == CPU_Core_Dyn_X86_Run || core == CPU_Core_Dyn_X86_Trap_Run) {
+		return CoreType::Dynamic;
+	}
+#endif
+#if C_DYNREC
+	if (core == CPU_Core_Dynrec_Run || core == CPU_Core_Dynrec_Trap_Run) {
+		return CoreType::Dynamic;
+	}
+#endif
+	return CoreType::Other;
+}
+
+// Cycles moved to CPU_CycleLeft by the core are handed out again by the PIC,
+// so only the sum of both tells how many were used up
+static int64_t get_pending_cycles()
+{
+	return static_cast<int64_t>(CPU_Cycles) + static_cast<int64_t>(CPU_CycleLeft);
+}
+
+void BENCHMARK_Start(const BenchmarkSettings& settings)
+{
+	benchmark          = {};
+	benchmark.active   = true;
+	benchmark.settings = settings;
+
+	benchmark.start_time = benchmark_clock::now();
+}
+
+bool BENCHMARK_IsActive()
+{
+	return benchmark.active;
+}
+
+void BENCHMARK_BeginSlice()
+{
+	benchmark.slice_cycles = get_pending_cycles();
+	benchmark.slice_start  = benchmark_clock::now();
+}
+
+bool BENCHMARK_EndSlice(CPU_Decoder* core)
+{
+	const auto elapsed = benchmark_clock::now() - benchmark.slice_start;
+	const auto cycles  = benchmark.slice_cycles - get_pending_cycles();
+
+	auto& counters = benchmark.cores[static_cast<size_t>(get_core_type(core))];
+	counters.cycles += cycles;
+	counters.host_ns +=
+	        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+	benchmark.cycles += cycles;
+
+	const auto max_cycles = benchmark.settings.max_cycles;
+	return max_cycles > 0 && benchmark.cycles >= max_cycles;
+}
+
+bool BENCHMARK_AddTick()
+{
+	++benchmark.emulated_ms;
+
+	const auto max_ms = benchmark.settings.max_emulated_ms;
+	return max_ms > 0 && benchmark.emulated_ms >= max_ms;
+}
+
+void BENCHMARK_AddFrame(const bool changed)
+{
+	++benchmark.frames;
+	if (changed) {
+		++benchmark.changed_frames;
+	}
+}
+
+static double get_mips(const int64_t cycles, const double host_ms)
+{
+	return host_ms > 0.0 ? static_cast<double>(cycles) / (host_ms * 1000.0) : 0.0;
+}
+
+void BENCHMARK_Report()
+{
+	if (!benchmark.active) {
+		return;
+	}
+	benchmark.active = false;
+
+	const auto host_ms = std::chrono::duration<double, std::milli>(
+	                             benchmark_clock::now() - benchmark.start_time)
+	                             .count();
+
+	printf("{\"cycles\": %lld, \"emulated_ms\": %lld, \"host_ms\": %.3f, "
+	       "\"mips\": %.3f, \"frames\": %lld, \"changed_frames\": %lld, "
+	       "\"cores\": {",
+	       static_cast<long long>(benchmark.cycles),
+	       static_cast<long long>(benchmark.emulated_ms),
+	       host_ms,
+	       get_mips(benchmark.cycles, host_ms),
+	       static_cast<long long>(benchmark.frames),
+	       static_cast<long long>(benchmark.changed_frames));
+
+	bool first = true;
+	for (size_t i = 0; i < benchmark.cores.size(); ++i) {
+		const auto& counters = benchmark.cores[i];
+		if (counters.cycles == 0) {
+			continue;
+		}
+		const auto core_ms = static_cast<double>(counters.host_ns) / 1e6;
+		printf("%s\"%s\": {\"cycles\": %lld, \"host_ms\": %.3f, \"mips\": %.3f}",
+		       first ? "" : ", ",
+		       core_names[i],
+		       static_cast<long long>(counters.cycles),
+		       core_ms,
+		       get_mips(counters.cycles, core_ms));
+		first = false;
+	}
+	printf("}}\n");
+	fflush(stdout);
+}
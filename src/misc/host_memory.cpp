@@ -0,0 +1,217 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "host_memory.h"
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "dosbox.h"
+#include "logging.h"
+
+constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+static size_t round_up(const size_t value, const size_t multiple)
+{
+	return (value + multiple - 1) / multiple * multiple;
+}
+
+const char* to_string(const HugePages huge_pages)
+{
+	switch (huge_pages) {
+	case HugePages::Off: return "off";
+	case HugePages::Transparent: return "transparent";
+	case HugePages::Explicit: return "explicit";
+	}
+	return "unknown";
+}
+
+HostMemory::HostMemory(const size_t num_bytes, const HugePages requested)
+        : size(num_bytes)
+{
+	assert(num_bytes > 0);
+	Map(requested);
+
+	if (!data) {
+		E_Exit("MEMORY: Failed to map %zu bytes of host memory", num_bytes);
+	}
+	if (huge_pages != requested) {
+		LOG_WARNING("MEMORY: Huge pages '%s' aren't available, using '%s'",
+		            to_string(requested),
+		            to_string(huge_pages));
+	}
+}
+
+HostMemory::~HostMemory()
+{
+	Unmap();
+}
+
+HostMemory::HostMemory(HostMemory&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+HostMemory& HostMemory::operator=(HostMemory&& other) noexcept
+{
+	if (this != &other) {
+		Unmap();
+		data         = std::exchange(other.data, nullptr);
+		size         = std::exchange(other.size, 0);
+		mapping      = std::exchange(other.mapping, nullptr);
+		mapping_size = std::exchange(other.mapping_size, 0);
+		huge_pages   = std::exchange(other.huge_pages, HugePages::Off);
+	}
+	return *this;
+}
+
+#if defined(WIN32)
+
+// Committed memory is demand-zero on Windows: the pages only take up
+// physical memory once they're touched. Large pages are the exception, as
+// they're locked in memory when they're allocated.
+void HostMemory::Map(const HugePages requested)
+{
+	const auto large_page_size = GetLargePageMinimum();
+	if (requested == HugePages::Explicit && large_page_size > 0) {
+		mapping_size = round_up(size, large_page_size);
+		mapping      = VirtualAlloc(nullptr,
+		                            mapping_size,
+		                            MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+		                            PAGE_READWRITE);
+		if (mapping) {
+			data       = static_cast<uint8_t*>(mapping);
+			huge_pages = HugePages::Explicit;
+			return;
+		}
+	}
+
+	mapping_size = size;
+	mapping      = VirtualAlloc(nullptr,
+	                            mapping_size,
+	                            MEM_RESERVE | MEM_COMMIT,
+	                            PAGE_READWRITE);
+	data         = static_cast<uint8_t*>(mapping);
+	huge_pages   = HugePages::Off;
+}
+
+void HostMemory::Unmap()
+{
+	if (mapping) {
+		VirtualFree(mapping, 0, MEM_RELEASE);
+	}
+	mapping = nullptr;
+	data    = nullptr;
+}
+
+std::optional<size_t> HostMemory::GetResidentBytes() const
+{
+	return {};
+}
+
+#else
+
+// Anonymous mappings are demand-zero: the pages only take up physical
+// memory once they're touched.
+void HostMemory::Map(const HugePages requested)
+{
+	constexpr auto protection = PROT_READ | PROT_WRITE;
+	constexpr auto flags      = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#if defined(MAP_HUGETLB)
+	if (requested == HugePages::Explicit) {
+		mapping_size = round_up(size, huge_page_size);
+		mapping = mmap(nullptr, mapping_size, protection, flags | MAP_HUGETLB, -1, 0);
+		if (mapping != MAP_FAILED) {
+			data       = static_cast<uint8_t*>(mapping);
+			huge_pages = HugePages::Explicit;
+			return;
+		}
+	}
+#endif
+
+#if defined(MADV_HUGEPAGE)
+	if (requested != HugePages::Off) {
+		// Over-map so the block can start on a huge page boundary
+		mapping_size = round_up(size, huge_page_size) + huge_page_size;
+		mapping = mmap(nullptr, mapping_size, protection, flags, -1, 0);
+		if (mapping != MAP_FAILED) {
+			const auto address = reinterpret_cast<uintptr_t>(mapping);
+			data = reinterpret_cast<uint8_t*>(round_up(address, huge_page_size));
+			if (madvise(data, round_up(size, huge_page_size), MADV_HUGEPAGE) == 0) {
+				huge_pages = HugePages::Transparent;
+				return;
+			}
+			munmap(mapping, mapping_size);
+		}
+	}
+#endif
+
+	mapping_size = size;
+	mapping      = mmap(nullptr, mapping_size, protection, flags, -1, 0);
+	if (mapping == MAP_FAILED) {
+		mapping = nullptr;
+	}
+	data       = static_cast<uint8_t*>(mapping);
+	huge_pages = HugePages::Off;
+}
+
+void HostMemory::Unmap()
+{
+	if (mapping) {
+		munmap(mapping, mapping_size);
+	}
+	mapping = nullptr;
+	data    = nullptr;
+}
+
+std::optional<size_t> HostMemory::GetResidentBytes() const
+{
+	if (!data) {
+		return {};
+	}
+	const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	const auto num_pages = round_up(size, page_size) / page_size;
+
+#if defined(__linux__)
+	std::vector<unsigned char> residency(num_pages);
+#else
+	std::vector<char> residency(num_pages);
+#endif
+	if (mincore(data, size, residency.data()) != 0) {
+		return {};
+	}
+
+	size_t num_resident = 0;
+	for (const auto page : residency) {
+		num_resident += (page & 1);
+	}
+	return num_resident * page_size;
+}
+
+#endif
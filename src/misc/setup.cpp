@@ -1887,6 +1887,7 @@ void Config::ParseArguments()
 	arguments.exit        = cmdline->FindRemoveBoolArgument("exit");
 	arguments.securemode = cmdline->FindRemoveBoolArgument("securemode");
 	arguments.noautoexec = cmdline->FindRemoveBoolArgument("noautoexec");
+	arguments.headless   = cmdline->FindRemoveBoolArgument("headless");
 
 	arguments.eraseconf = cmdline->FindRemoveBoolArgument("eraseconf") ||
 	                      cmdline->FindRemoveBoolArgument("resetconf");
@@ -1903,6 +1904,10 @@ void Config::ParseArguments()
 
 	arguments.socket = cmdline->FindRemoveIntArgument("socket");
 
+	arguments.benchmark_ms = cmdline->FindRemoveIntArgument("benchmark-ms");
+	arguments.benchmark_mcycles = cmdline->FindRemoveIntArgument(
+	        "benchmark-mcycles");
+
 	arguments.conf = cmdline->FindRemoveVectorArgument("conf");
 	arguments.set  = cmdline->FindRemoveVectorArgument("set");
 
@@ -0,0 +1,227 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "auto_cycles.h"
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr int64_t window_ms = 100;
+
+// One window of a simulated host: the host time an emulated millisecond
+// takes is the cost of the cycles plus a fixed overhead for devices, mixing,
+// and rendering. Noise scales the measured busy time.
+struct HostWindow {
+	double ns_per_cycle = 0.0;
+	double overhead     = 0.0; // share of each millisecond
+	double noise        = 0.0; // relative error of the busy time
+};
+
+using trace_t = std::vector<HostWindow>;
+
+AutoCycles::Settings make_settings()
+{
+	AutoCycles::Settings settings = {};
+	settings.target_usage = 1.0;
+	settings.min_cycles   = 200;
+	settings.max_cycles   = 2'000'000;
+	return settings;
+}
+
+// The cycles at which the host would be used exactly at the given usage
+double ideal_cycles(const HostWindow& host, const double usage)
+{
+	return (usage - host.overhead) * 1e6 / host.ns_per_cycle;
+}
+
+AutoCycles::Sample measure(const HostWindow& host, const int32_t cycles)
+{
+	const auto usage = (cycles * host.ns_per_cycle / 1e6 + host.overhead) *
+	                   (1.0 + host.noise);
+
+	const auto busy_us = static_cast<int64_t>(usage * window_ms * 1000);
+
+	AutoCycles::Sample sample = {};
+	sample.emulated_ms        = window_ms;
+	sample.elapsed_us         = std::max(busy_us, window_ms * 1000);
+	sample.idle_us            = sample.elapsed_us - busy_us;
+	return sample;
+}
+
+// Replays the trace and returns the cycles after each window
+std::vector<int32_t> replay(const trace_t& trace, int32_t cycles)
+{
+	AutoCycles controller = {};
+	std::vector<int32_t> history = {};
+
+	for (const auto& host : trace) {
+		const auto new_cycles = controller.Update(cycles,
+		                                          make_settings(),
+		                                          measure(host, cycles));
+		EXPECT_TRUE(new_cycles.has_value());
+		cycles = new_cycles.value_or(cycles);
+		history.push_back(cycles);
+	}
+	return history;
+}
+
+trace_t make_steady_trace(const HostWindow& host, const size_t windows)
+{
+	return trace_t(windows, host);
+}
+
+TEST(AutoCycles, WaitsForCompleteWindow)
+{
+	AutoCycles controller = {};
+
+	AutoCycles::Sample sample = {};
+	sample.emulated_ms        = 10;
+	sample.elapsed_us         = 10'000;
+	sample.idle_us            = 5'000;
+	EXPECT_FALSE(controller.Update(3000, make_settings(), sample));
+
+	sample.emulated_ms = window_ms;
+	sample.elapsed_us  = window_ms * 1000;
+	sample.idle_us     = sample.elapsed_us / 2;
+	EXPECT_TRUE(controller.Update(3000, make_settings(), sample));
+}
+
+TEST(AutoCycles, ReactsEarlyWhenFallingBehind)
+{
+	AutoCycles controller = {};
+
+	AutoCycles::Sample sample = {};
+	sample.emulated_ms        = 10;
+	sample.elapsed_us         = 40'000;
+
+	const auto cycles = controller.Update(100'000, make_settings(), sample);
+	ASSERT_TRUE(cycles);
+	EXPECT_LT(*cycles, 100'000);
+}
+
+TEST(AutoCycles, ConvergesFromBelowWithoutOvershoot)
+{
+	const HostWindow host = {10.0, 0.1, 0.0};
+	const auto history    = replay(make_steady_trace(host, 60), 3000);
+
+	const auto limit = ideal_cycles(host, 1.0);
+	for (size_t i = 1; i < history.size(); ++i) {
+		EXPECT_GE(history[i], history[i - 1]) << "window " << i;
+		EXPECT_LT(history[i], limit) << "window " << i;
+	}
+	EXPECT_GT(history.back(), ideal_cycles(host, 0.94));
+}
+
+TEST(AutoCycles, ConvergesFromAboveWithoutOvershoot)
+{
+	const HostWindow host = {10.0, 0.1, 0.0};
+	const auto history    = replay(make_steady_trace(host, 60), 500'000);
+
+	const auto floor = ideal_cycles(host, 0.94);
+	for (size_t i = 1; i < history.size(); ++i) {
+		EXPECT_LE(history[i], history[i - 1]) << "window " << i;
+		EXPECT_GT(history[i], floor) << "window " << i;
+	}
+	EXPECT_LT(history.back(), ideal_cycles(host, 1.0));
+}
+
+// A recorded load pattern: the host slows down to half its speed while
+// another application runs, then recovers
+TEST(AutoCycles, FollowsHostLoadSteps)
+{
+	const HostWindow idle_host = {5.0, 0.05, 0.0};
+	const HostWindow busy_host = {10.0, 0.1, 0.0};
+
+	trace_t trace = make_steady_trace(idle_host, 40);
+	const auto busy_from = trace.size();
+	trace.insert(trace.end(), 40, busy_host);
+	const auto idle_from = trace.size();
+	trace.insert(trace.end(), 40, idle_host);
+
+	const auto history = replay(trace, 3000);
+
+	// Every phase ends settled and approaches its target from one side
+	const auto check_phase = [&](const size_t begin, const size_t end,
+	                             const HostWindow& host, const bool rising) {
+		for (size_t i = begin + 1; i < end; ++i) {
+			if (rising) {
+				EXPECT_GE(history[i], history[i - 1]) << "window " << i;
+			} else {
+				EXPECT_LE(history[i], history[i - 1]) << "window " << i;
+			}
+		}
+		EXPECT_GT(history[end - 1], ideal_cycles(host, 0.94));
+		EXPECT_LT(history[end - 1], ideal_cycles(host, 1.0));
+	};
+	check_phase(0, busy_from, idle_host, true);
+	check_phase(busy_from, idle_from, busy_host, false);
+	check_phase(idle_from, trace.size(), idle_host, true);
+}
+
+// Once settled, measurement jitter within the hysteresis band doesn't move
+// the cycles
+TEST(AutoCycles, HoldsSteadyUnderJitter)
+{
+	const HostWindow host = {10.0, 0.1, 0.0};
+
+	trace_t trace = make_steady_trace(host, 40);
+	constexpr double jitter[] = {0.02, -0.015, 0.01, -0.02, 0.015, -0.01};
+	for (int i = 0; i < 60; ++i) {
+		auto noisy  = host;
+		noisy.noise = jitter[i % std::size(jitter)];
+		trace.push_back(noisy);
+	}
+
+	const auto history = replay(trace, 3000);
+
+	int changes = 0;
+	for (size_t i = 41; i < history.size(); ++i) {
+		changes += (history[i] != history[i - 1]) ? 1 : 0;
+	}
+	EXPECT_EQ(changes, 0);
+	EXPECT_LT(history.back(), ideal_cycles(host, 1.0));
+}
+
+TEST(AutoCycles, SkipsDisturbedWindows)
+{
+	AutoCycles controller = {};
+
+	// The process was suspended for seconds with barely anything emulated
+	AutoCycles::Sample sample = {};
+	sample.emulated_ms        = window_ms;
+	sample.elapsed_us         = 20'000'000;
+
+	EXPECT_EQ(controller.Update(50'000, make_settings(), sample), 50'000);
+}
+
+TEST(AutoCycles, RespectsLimits)
+{
+	const HostWindow fast_host = {0.01, 0.0, 0.0};
+	EXPECT_EQ(replay(make_steady_trace(fast_host, 40), 3000).back(), 2'000'000);
+
+	const HostWindow slow_host = {10'000.0, 0.0, 0.0};
+	EXPECT_EQ(replay(make_steady_trace(slow_host, 40), 500).back(), 200);
+}
+
+} // namespace
@@ -0,0 +1,552 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "cpu.h"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mem.h"
+#include "regs.h"
+
+#include "dosbox_test_fixture.h"
+
+#if C_DYNREC
+
+void CPU_Core_Dynrec_Cache_Init(bool enable_cache);
+
+namespace {
+
+constexpr uint16_t code_segment  = 0x8000;
+constexpr uint16_t stack_segment = 0x9000;
+
+// A loop mixing operations whose flags are overwritten unread with ones
+// whose flags are read: an inc between an add and an adc, sahf keeping the
+// previous OF, shifts by a count that is sometimes zero, rotates, and
+// pushf to capture the full flags. Ends in a jump to itself.
+std::vector<uint8_t> make_flags_mix()
+{
+	std::vector<uint8_t> code = {
+	        0xb9, 0x00, 0x04, // mov cx,0x400
+	};
+	const auto loop_top = code.size();
+
+	const std::vector<uint8_t> body = {
+	        0x01, 0xd8,       // add ax,bx
+	        0x46,             // inc si
+	        0x11, 0xc2,       // adc dx,ax
+	        0x04, 0x7f,       // add al,0x7f
+	        0x9e,             // sahf
+	        0x9c,             // pushf
+	        0x5f,             // pop di
+	        0x31, 0xfd,       // xor bp,di
+	        0x51,             // push cx
+	        0x88, 0xd9,       // mov cl,bl
+	        0x80, 0xe1, 0x03, // and cl,3
+	        0xd3, 0xe0,       // shl ax,cl
+	        0x59,             // pop cx
+	        0x4b,             // dec bx
+	        0xd1, 0xc2,       // rol dx,1
+	        0x19, 0xf5,       // sbb bp,si
+	        0xd1, 0xd3,       // rcl bx,1
+	        0x2d, 0x03, 0x00, // sub ax,3
+	        0x40,             // inc ax
+	        0x9c,             // pushf
+	        0x5f,             // pop di
+	        0x01, 0xfd,       // add bp,di
+	};
+	code.insert(code.end(), body.begin(), body.end());
+
+	// loop loop_top
+	code.push_back(0xe2);
+	code.push_back(static_cast<uint8_t>(loop_top - (code.size() + 1)));
+
+	const std::vector<uint8_t> tail = {
+	        0x39, 0xd8, // cmp ax,bx
+	        0x9c,       // pushf
+	        0x5f,       // pop di
+	        0xeb, 0xfe, // jmp $
+	};
+	code.insert(code.end(), tail.begin(), tail.end());
+	return code;
+}
+
+void reset_state(const std::vector<uint8_t> &code, const uint16_t segment = code_segment)
+{
+	const auto code_base = static_cast<PhysPt>(segment) << 4;
+	for (size_t i = 0; i < code.size(); ++i) {
+		mem_writeb(code_base + static_cast<PhysPt>(i), code[i]);
+	}
+
+	reg_eax   = 0x1234;
+	reg_ebx   = 0x9abc;
+	reg_ecx   = 0;
+	reg_edx   = 0x5678;
+	reg_esi   = 0;
+	reg_edi   = 0;
+	reg_ebp   = 0x55aa;
+	reg_esp   = 0x1000;
+	reg_flags = FLAG_IF | 0x2;
+
+	SegSet16(cs, segment);
+	SegSet16(ds, stack_segment);
+	SegSet16(es, stack_segment);
+	SegSet16(ss, stack_segment);
+	reg_eip = 0;
+}
+
+std::array<uint32_t, 9> run_to_end(CPU_Decoder *core, const std::vector<uint8_t> &code)
+{
+	reset_state(code);
+	CPU_Cycles = 1'000'000;
+	while (CPU_Cycles > 0) {
+		core();
+	}
+	return {reg_eax, reg_ebx, reg_ecx, reg_edx, reg_esi,
+	        reg_edi, reg_ebp, reg_esp, reg_eip};
+}
+
+// Superblocks are only formed and dissolved when the core's run loop
+// reaches a block, so the code runs in short slices as it does between
+// the emulator's timer ticks. Each test uses code in a page of its own.
+std::array<uint32_t, 9> run_sliced(CPU_Decoder *core, const std::vector<uint8_t> &code,
+                                   const uint16_t segment, const int num_slices)
+{
+	reset_state(code, segment);
+	for (int i = 0; i < num_slices; ++i) {
+		CPU_Cycles = 1'000;
+		while (CPU_Cycles > 0) {
+			core();
+		}
+	}
+	return {reg_eax, reg_ebx, reg_ecx, reg_edx, reg_esi,
+	        reg_edi, reg_ebp, reg_esp, reg_eip};
+}
+
+int8_t rel8(const size_t next_instruction, const size_t target)
+{
+	const auto rel = static_cast<int>(target) - static_cast<int>(next_instruction);
+	assert(rel >= INT8_MIN && rel <= INT8_MAX);
+	return static_cast<int8_t>(rel);
+}
+
+struct BranchyLoop {
+	std::vector<uint8_t> code = {};
+	size_t end_ip = 0;
+};
+
+// A loop whose conditional branch takes a rare path once in 16 iterations,
+// as long as the bit 'flip_bit' of the counter is clear; while it's set,
+// the rare path is taken 15 times out of 16 instead. With 'patch', the
+// loop runs a second time after rewriting an immediate on its hot path.
+BranchyLoop make_branchy_loop(const uint16_t iterations, const uint16_t flip_bit,
+                              const bool patch)
+{
+	const auto lo = [](const size_t value) { return static_cast<uint8_t>(value & 0xff); };
+	const auto hi = [](const size_t value) { return static_cast<uint8_t>(value >> 8); };
+
+	BranchyLoop loop = {};
+	auto &code       = loop.code;
+	const auto emit  = [&](const std::vector<uint8_t> &bytes) {
+		code.insert(code.end(), bytes.begin(), bytes.end());
+	};
+
+	emit({0xb9, lo(iterations), hi(iterations)}); // mov cx,iterations
+	const auto top = code.size();
+	emit({
+	        0x89, 0xca,                         // mov dx,cx
+	        0x83, 0xe2, 0x0f,                   // and dx,15
+	        0x83, 0xc2, 0xff,                   // add dx,-1
+	        0x19, 0xd2,                         // sbb dx,dx
+	        0x89, 0xce,                         // mov si,cx
+	        0x81, 0xe6, lo(flip_bit), hi(flip_bit), // and si,flip_bit
+	        0xf7, 0xde,                         // neg si
+	        0x19, 0xf6,                         // sbb si,si
+	        0x31, 0xf2,                         // xor dx,si
+	        0x74, 0x00,                         // jz rare
+	});
+	const auto jz_rare = code.size() - 1;
+
+	emit({0x43, 0x01, 0xc5, 0x05}); // inc bx, add bp,ax, add ax,imm16
+	const auto immediate = code.size();
+	emit({0x11, 0x01});
+	const auto back = code.size();
+	emit({0x01, 0xc8, 0x49, 0x75}); // add ax,cx, dec cx, jnz top
+	code.push_back(static_cast<uint8_t>(rel8(code.size() + 1, top)));
+
+	if (patch) {
+		emit({0x85, 0xff, 0x75, 0x00}); // test di,di, jnz done
+		const auto jnz_done = code.size() - 1;
+		emit({
+		        0x47, // inc di
+		        0x2e, 0xc7, 0x06, lo(immediate), hi(immediate), 0x33, 0x03, // mov [cs:imm],0x0333
+		        0xb9, lo(iterations), hi(iterations), // mov cx,iterations
+		        0xeb, // jmp top
+		});
+		code.push_back(static_cast<uint8_t>(rel8(code.size() + 1, top)));
+		code[jnz_done] = static_cast<uint8_t>(rel8(jnz_done + 1, code.size()));
+	}
+	loop.end_ip = code.size();
+	emit({0xeb, 0xfe}); // jmp $
+
+	code[jz_rare] = static_cast<uint8_t>(rel8(jz_rare + 1, code.size()));
+	emit({0x29, 0xdd, 0xd1, 0xc0, 0xeb}); // sub bp,bx, rol ax,1, jmp back
+	code.push_back(static_cast<uint8_t>(rel8(code.size() + 1, back)));
+	return loop;
+}
+
+// A loop of four runs of memory updates joined by short jumps, longer than
+// a superblock has room for. It clears the memory it works on first, so
+// each core starts from the same state.
+BranchyLoop make_long_path_loop(const uint16_t iterations)
+{
+	const auto lo = [](const size_t value) { return static_cast<uint8_t>(value & 0xff); };
+	const auto hi = [](const size_t value) { return static_cast<uint8_t>(value >> 8); };
+
+	BranchyLoop loop = {};
+	auto &code       = loop.code;
+	const auto emit  = [&](const std::vector<uint8_t> &bytes) {
+		code.insert(code.end(), bytes.begin(), bytes.end());
+	};
+
+	emit({
+	        0x31, 0xc0,       // xor ax,ax
+	        0xbf, 0x00, 0x02, // mov di,0x200
+	        0xb9, 0x20, 0x00, // mov cx,0x20
+	        0xf3, 0xab,       // rep stosw
+	        0xb8, 0x34, 0x12, // mov ax,0x1234
+	        0xbe, 0x00, 0x02, // mov si,0x200
+	});
+	emit({0xb9, lo(iterations), hi(iterations)}); // mov cx,iterations
+	const auto top = code.size();
+	for (int run = 0; run < 4; ++run) {
+		for (uint8_t i = 0; i < 12; ++i) {
+			const auto offset = static_cast<uint8_t>(2 * i);
+			emit({
+			        0x01, 0x44, offset,                              // add [si+offset],ax
+			        0x03, 0x54, static_cast<uint8_t>(offset + 1), // add dx,[si+offset+1]
+			});
+		}
+		emit({0x40, 0xeb, 0x00}); // inc ax, jmp short +0
+	}
+	emit({0x49, 0x75}); // dec cx, jnz top
+	code.push_back(static_cast<uint8_t>(rel8(code.size() + 1, top)));
+
+	loop.end_ip = code.size();
+	emit({0xeb, 0xfe}); // jmp $
+	return loop;
+}
+
+class CoreDynrecTest : public DOSBoxTestFixture {};
+
+// The flags the recompiled code leaves behind and pushes along the way
+// have to match the normal core's, with the computation of unread flags
+// left out
+TEST_F(CoreDynrecTest, FlagsMatchNormalCore)
+{
+	CPU_Core_Dynrec_Cache_Init(true);
+
+	const auto code     = make_flags_mix();
+	const auto expected = run_to_end(&CPU_Core_Normal_Run, code);
+	const auto actual   = run_to_end(&CPU_Core_Dynrec_Run, code);
+
+	// Both have to reach the final jump
+	ASSERT_EQ(expected[8], code.size() - 2);
+	EXPECT_EQ(actual, expected);
+}
+
+// A random mix of 16-bit register operations that set flags and ones that
+// read them (adc/sbb, rotates through carry, BCD adjusts, conditional
+// jumps and sets, lahf, pushf, cmc), repeated three times so the flags
+// also flow from one pass into the next. Ends with the flags in DI.
+std::vector<uint8_t> make_random_flags_mix(std::mt19937 &rng)
+{
+	// ax, dx, bx, bp, si; cx counts the passes and di collects the flags
+	constexpr uint8_t regs[] = {0, 2, 3, 5, 6};
+	constexpr uint8_t byte_regs[] = {0, 2, 3}; // al, dl, bl
+
+	const auto pick = [&](const auto &choices) {
+		return choices[rng() % std::size(choices)];
+	};
+	const auto modrm = [](const int ext, const uint8_t reg) {
+		return static_cast<uint8_t>(0xc0 | (ext << 3) | reg);
+	};
+
+	std::vector<uint8_t> code = {0xb9, 0x03, 0x00}; // mov cx,3
+	const auto loop_top = code.size();
+
+	while (code.size() < loop_top + 100) {
+		const auto reg = pick(regs);
+		std::vector<uint8_t> insn = {};
+		switch (rng() % 14) {
+		case 0:
+		case 1: // add, or, adc, sbb, and, sub, xor, cmp between registers
+			insn = {static_cast<uint8_t>(0x01 + 8 * (rng() % 8)),
+			        modrm(pick(regs), reg)};
+			break;
+		case 2: // the same with a sign-extended immediate
+			insn = {0x83, modrm(rng() % 8, reg), static_cast<uint8_t>(rng())};
+			break;
+		case 3: // test
+			insn = {0x85, modrm(pick(regs), reg)};
+			break;
+		case 4: // inc and dec keep CF
+			insn = {static_cast<uint8_t>((rng() % 2 ? 0x40 : 0x48) + reg)};
+			break;
+		case 5: // not, neg
+			insn = {0xf7, modrm(2 + rng() % 2, reg)};
+			break;
+		case 6: // rol, ror, rcl, rcr, shl, shr, sar by one
+		{
+			constexpr int shifts[] = {0, 1, 2, 3, 4, 5, 7};
+			insn = {0xd1, modrm(pick(shifts), reg)};
+			break;
+		}
+		case 7: // the same by a count that can be zero or over 16
+		{
+			constexpr int shifts[] = {0, 1, 2, 3, 4, 5, 7};
+			insn = {0xc1, modrm(pick(shifts), reg),
+			        static_cast<uint8_t>(rng() % 20)};
+			break;
+		}
+		case 8: // add al,imm8 then daa, das, aaa, or aas
+			insn = {0x04, static_cast<uint8_t>(rng()),
+			        static_cast<uint8_t>(0x27 + 8 * (rng() % 4))};
+			break;
+		case 9: // jcc over an inc di
+			insn = {static_cast<uint8_t>(0x70 + rng() % 16), 0x01, 0x47};
+			break;
+		case 10: // setcc into al, dl, or bl
+			insn = {0x0f, static_cast<uint8_t>(0x90 + rng() % 16),
+			        modrm(0, pick(byte_regs))};
+			break;
+		case 11: // pushf, pop di
+			insn = {0x9c, 0x5f};
+			break;
+		case 12: // lahf, sahf
+			insn = {static_cast<uint8_t>(rng() % 2 ? 0x9f : 0x9e)};
+			break;
+		case 13: // cmc, clc, stc
+		{
+			constexpr uint8_t carry_ops[] = {0xf5, 0xf8, 0xf9};
+			insn = {pick(carry_ops)};
+			break;
+		}
+		}
+		code.insert(code.end(), insn.begin(), insn.end());
+	}
+
+	// loop loop_top
+	code.push_back(0xe2);
+	code.push_back(static_cast<uint8_t>(rel8(code.size() + 1, loop_top)));
+
+	const std::vector<uint8_t> tail = {
+	        0x9c,       // pushf
+	        0x5f,       // pop di
+	        0xeb, 0xfe, // jmp $
+	};
+	code.insert(code.end(), tail.begin(), tail.end());
+	return code;
+}
+
+// Randomly generated sequences of flag producers and consumers, each in
+// its own page, have to leave the same registers and flags as the normal
+// core. The seed is reported with any mismatch.
+TEST_F(CoreDynrecTest, RandomFlagsMixesMatchNormalCore)
+{
+	CPU_Core_Dynrec_Cache_Init(true);
+
+	constexpr int num_mixes = 48;
+	for (int seed = 0; seed < num_mixes; ++seed) {
+		std::mt19937 rng(seed);
+		const auto code = make_random_flags_mix(rng);
+
+		std::array<uint32_t, 5> start_regs = {};
+		for (auto &value : start_regs) {
+			value = static_cast<uint32_t>(rng());
+		}
+		const auto start_flags = static_cast<uint32_t>(rng() & 0x8d5);
+
+		const auto segment = static_cast<uint16_t>(0x4000 + seed * 0x100);
+		const auto run = [&](CPU_Decoder *core) {
+			reset_state(code, segment);
+			reg_eax   = start_regs[0];
+			reg_ebx   = start_regs[1];
+			reg_edx   = start_regs[2];
+			reg_ebp   = start_regs[3];
+			reg_esi   = start_regs[4];
+			reg_flags = FLAG_IF | 0x2 | start_flags;
+
+			CPU_Cycles = 10'000;
+			while (CPU_Cycles > 0) {
+				core();
+			}
+			return std::array<uint32_t, 9>{reg_eax, reg_ebx, reg_ecx,
+			                               reg_edx, reg_esi, reg_edi,
+			                               reg_ebp, reg_esp, reg_eip};
+		};
+
+		const auto expected = run(&CPU_Core_Normal_Run);
+		const auto actual   = run(&CPU_Core_Dynrec_Run);
+
+		ASSERT_EQ(expected[8], code.size() - 2) << "seed " << seed;
+		EXPECT_EQ(actual, expected) << "seed " << seed;
+	}
+}
+
+TEST_F(CoreDynrecTest, SuperblockMatchesNormalCore)
+{
+	CPU_Core_Dynrec_Cache_Init(true);
+
+	const auto loop   = make_branchy_loop(0x2000, 0, false);
+	const auto before = CPU_Core_Dynrec_GetTraceStats();
+
+	const auto expected = run_sliced(&CPU_Core_Normal_Run, loop.code, 0x8100, 200);
+	const auto actual   = run_sliced(&CPU_Core_Dynrec_Run, loop.code, 0x8100, 200);
+
+	ASSERT_EQ(expected[8], loop.end_ip);
+	EXPECT_EQ(actual, expected);
+
+	const auto after = CPU_Core_Dynrec_GetTraceStats();
+	EXPECT_GT(after.formed, before.formed);
+	EXPECT_EQ(after.dissolved, before.dissolved);
+}
+
+// Once the branch flips, the superblock keeps leaving through its side
+// exit until it's translated as a regular block again
+TEST_F(CoreDynrecTest, SideExitsDissolveSuperblock)
+{
+	CPU_Core_Dynrec_Cache_Init(true);
+
+	const auto loop   = make_branchy_loop(0x8000, 0x4000, false);
+	const auto before = CPU_Core_Dynrec_GetTraceStats();
+
+	const auto expected = run_sliced(&CPU_Core_Normal_Run, loop.code, 0x8200, 1000);
+	const auto actual   = run_sliced(&CPU_Core_Dynrec_Run, loop.code, 0x8200, 1000);
+
+	ASSERT_EQ(expected[8], loop.end_ip);
+	EXPECT_EQ(actual, expected);
+
+	const auto after = CPU_Core_Dynrec_GetTraceStats();
+	EXPECT_GT(after.formed, before.formed);
+	EXPECT_GT(after.dissolved, before.dissolved);
+}
+
+// A branch flipping every 1024 iterations would otherwise have its
+// superblock formed and dissolved again in each of the 32 phases; only the
+// loop's head has side exits, and it's dissolved at most three times
+TEST_F(CoreDynrecTest, DissolvedSuperblocksCoolDown)
+{
+	CPU_Core_Dynrec_Cache_Init(true);
+
+	const auto loop   = make_branchy_loop(0x8000, 0x0400, false);
+	const auto before = CPU_Core_Dynrec_GetTraceStats();
+
+	const auto expected = run_sliced(&CPU_Core_Normal_Run, loop.code, 0x8300, 1000);
+	const auto actual   = run_sliced(&CPU_Core_Dynrec_Run, loop.code, 0x8300, 1000);
+
+	ASSERT_EQ(expected[8], loop.end_ip);
+	EXPECT_EQ(actual, expected);
+
+	const auto after = CPU_Core_Dynrec_GetTraceStats();
+	EXPECT_GT(after.dissolved, before.dissolved);
+	EXPECT_LE(after.dissolved - before.dissolved, 3);
+}
+
+// Rewriting an immediate on the hot path has to drop the superblock that
+// was translated with the old value
+TEST_F(CoreDynrecTest, SelfModifiedSuperblockIsRetranslated)
+{
+	CPU_Core_Dynrec_Cache_Init(true);
+
+	const auto loop   = make_branchy_loop(0x2000, 0, true);
+	const auto before = CPU_Core_Dynrec_GetTraceStats();
+
+	const auto expected = run_sliced(&CPU_Core_Normal_Run, loop.code, 0x8400, 400);
+	const auto actual   = run_sliced(&CPU_Core_Dynrec_Run, loop.code, 0x8400, 400);
+
+	ASSERT_EQ(expected[8], loop.end_ip);
+	EXPECT_EQ(actual, expected);
+
+	const auto after = CPU_Core_Dynrec_GetTraceStats();
+	EXPECT_GT(after.formed, before.formed);
+}
+
+// The hot path has more code than fits into one cache block, so the
+// superblock ends where its room runs out and links on to the rest
+TEST_F(CoreDynrecTest, LongSuperblockEndsWhereRoomRunsOut)
+{
+	CPU_Core_Dynrec_Cache_Init(true);
+
+	const auto loop   = make_long_path_loop(0x400);
+	const auto before = CPU_Core_Dynrec_GetTraceStats();
+
+	const auto expected = run_sliced(&CPU_Core_Normal_Run, loop.code, 0x8800, 200);
+	const auto actual   = run_sliced(&CPU_Core_Dynrec_Run, loop.code, 0x8800, 200);
+
+	ASSERT_EQ(expected[8], loop.end_ip);
+	EXPECT_EQ(actual, expected);
+
+	const auto after = CPU_Core_Dynrec_GetTraceStats();
+	EXPECT_GT(after.formed, before.formed);
+}
+
+TEST_F(CoreDynrecTest, BenchmarkSuperblocks)
+{
+	CPU_Core_Dynrec_Cache_Init(true);
+
+	constexpr int num_runs = 50;
+	const auto loop = make_branchy_loop(0xffff, 0, false);
+
+	auto run = [&](CPU_Decoder *core, const uint16_t segment) {
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < num_runs; ++i) {
+			const auto regs = run_sliced(core, loop.code, segment, 1200);
+			EXPECT_EQ(regs[8], loop.end_ip);
+		}
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		return std::chrono::duration<double>(elapsed).count();
+	};
+
+	const auto normal = run(&CPU_Core_Normal_Run, 0x8500);
+
+	CPU_Core_Dynrec_EnableTracing(false);
+	const auto blocks = run(&CPU_Core_Dynrec_Run, 0x8600);
+	CPU_Core_Dynrec_EnableTracing(true);
+	const auto superblocks = run(&CPU_Core_Dynrec_Run, 0x8700);
+
+	printf("[ BENCHMARK] Branchy loop, %d x 64K iterations: normal core %.1f ms, "
+	       "dynrec blocks %.1f ms, dynrec superblocks %.1f ms\n",
+	       num_runs,
+	       normal * 1e3,
+	       blocks * 1e3,
+	       superblocks * 1e3);
+}
+
+} // namespace
+
+#endif
@@ -0,0 +1,602 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "cpu.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mem.h"
+#include "paging.h"
+#include "regs.h"
+#include "vga.h"
+
+#include "dosbox_test_fixture.h"
+
+namespace {
+
+constexpr uint16_t code_segment = 0x8000;
+constexpr uint16_t data_segment = 0x9000;
+constexpr uint32_t data_size    = 0x1000;
+
+// Wraps the body in an endless loop that runs it 0xffff times per pass
+std::vector<uint8_t> make_loop(const std::vector<uint8_t> &body)
+{
+	std::vector<uint8_t> code = {
+	        0xb9, 0xff, 0xff, // mov cx,0xffff
+	};
+	const auto loop_top = code.size();
+
+	code.insert(code.end(), body.begin(), body.end());
+
+	// loop loop_top
+	code.push_back(0xe2);
+	code.push_back(static_cast<uint8_t>(loop_top - (code.size() + 1)));
+
+	// jmp 0
+	code.push_back(0xeb);
+	code.push_back(static_cast<uint8_t>(0 - (code.size() + 1)));
+	return code;
+}
+
+// A fixed real-mode instruction mix: ALU operations, memory accesses,
+// shifts, a two-byte opcode, operand size prefixes, the stack, a REP
+// string move, and taken and not-taken branches.
+std::vector<uint8_t> make_instruction_mix()
+{
+	return make_loop({
+	        0x01, 0xc8,             // add ax,cx
+	        0x11, 0xc3,             // adc bx,ax
+	        0x31, 0xda,             // xor dx,bx
+	        0x89, 0x04,             // mov [si],ax
+	        0x8b, 0x7c, 0x02,       // mov di,[si+2]
+	        0x46,                   // inc si
+	        0x81, 0xe6, 0xfe, 0x0f, // and si,0x0ffe
+	        0xd1, 0xe0,             // shl ax,1
+	        0xd1, 0xdb,             // rcr bx,1
+	        0x6b, 0xd3, 0x03,       // imul dx,bx,3
+	        0x0f, 0xb6, 0xc2,       // movzx ax,dl
+	        0x66, 0x01, 0xc8,       // add eax,ecx
+	        0x66, 0xc1, 0xc5, 0x07, // rol ebp,7
+	        0x50,                   // push ax
+	        0x5d,                   // pop bp
+	        0x51,                   // push cx
+	        0xb9, 0x08, 0x00,       // mov cx,8
+	        0xbf, 0x00, 0x08,       // mov di,0x800
+	        0x1e,                   // push ds
+	        0x07,                   // pop es
+	        0xf3, 0xa5,             // rep movsw
+	        0x59,                   // pop cx
+	        0x81, 0xe6, 0xfe, 0x0f, // and si,0x0ffe
+	        0x39, 0xd8,             // cmp ax,bx
+	        0x72, 0x01,             // jb +1
+	        0x42,                   // inc dx
+	});
+}
+
+// Offset of the operand size prefix of 'add eax,ecx' in the prefix mix
+constexpr size_t patched_offset = 3;
+
+// Instructions with one to four prefixes: segment overrides, operand and
+// address size, REP and REPNE string instructions, and two-byte opcodes.
+std::vector<uint8_t> make_prefix_mix()
+{
+	return make_loop({
+	        0x66, 0x01, 0xc8,             // add eax,ecx
+	        0x26, 0x89, 0x04,             // mov es:[si],ax
+	        0x36, 0x8b, 0x5c, 0x04,       // mov bx,ss:[si+4]
+	        0x2e, 0x8b, 0x14,             // mov dx,cs:[si]
+	        0x3e, 0x36, 0x01, 0x44, 0x06, // add ss:[si+6],ax
+	        0x66, 0x67, 0x8b, 0x3e,       // mov edi,[esi]
+	        0x66, 0x0f, 0xb6, 0xea,       // movzx ebp,dl
+	        0x66, 0x26, 0x01, 0x04,       // add es:[si],eax
+	        0x0f, 0xaf, 0xc3,             // imul ax,bx
+	        0x46,                         // inc si
+	        0x81, 0xe6, 0xfe, 0x07,       // and si,0x07fe
+	        0x51,                         // push cx
+	        0xb9, 0x05, 0x00,             // mov cx,5
+	        0xbf, 0x00, 0x08,             // mov di,0x800
+	        0xf3, 0x26, 0xa4,             // rep movsb from es:[si]
+	        0xb9, 0x09, 0x00,             // mov cx,9
+	        0xf2, 0xae,                   // repne scasb
+	        0x66, 0xf3, 0x2e, 0x26, 0xa5, // rep movsd with two overrides
+	        0x59,                         // pop cx
+	        0x81, 0xe6, 0xfe, 0x07,       // and si,0x07fe
+	        0x66, 0xc1, 0xc0, 0x03,       // rol eax,3
+	});
+}
+
+struct CpuState {
+	std::array<uint32_t, 8> regs = {};
+	uint32_t eip                 = 0;
+	uint32_t flags               = 0;
+	uint16_t es                  = 0;
+	std::vector<uint8_t> data    = {};
+
+	bool operator==(const CpuState &other) const
+	{
+		return regs == other.regs && eip == other.eip &&
+		       flags == other.flags && es == other.es && data == other.data;
+	}
+};
+
+void reset_state(const std::vector<uint8_t> &code)
+{
+	const auto code_base = static_cast<PhysPt>(code_segment) << 4;
+	for (size_t i = 0; i < code.size(); ++i) {
+		mem_writeb(code_base + static_cast<PhysPt>(i), code[i]);
+	}
+	const auto data_base = static_cast<PhysPt>(data_segment) << 4;
+	for (uint32_t i = 0; i < data_size; ++i) {
+		mem_writeb(data_base + i, 0);
+	}
+
+	reg_eax = 0x12345678;
+	reg_ebx = 0x9abcdef0;
+	reg_ecx = 0;
+	reg_edx = 0;
+	reg_esi = 0;
+	reg_edi = 0;
+	reg_ebp = 0x55aa55aa;
+	reg_esp = 0x2000; // above the compared data
+	reg_flags = FLAG_IF | 0x2;
+
+	SegSet16(cs, code_segment);
+	SegSet16(ds, data_segment);
+	SegSet16(es, data_segment);
+	SegSet16(ss, data_segment);
+	reg_eip = 0;
+}
+
+CpuState capture_state()
+{
+	CpuState state = {};
+	state.regs  = {reg_eax, reg_ebx, reg_ecx, reg_edx,
+	               reg_esi, reg_edi, reg_ebp, reg_esp};
+	state.eip   = reg_eip;
+	state.flags = reg_flags;
+	state.es    = SegValue(es);
+
+	const auto data_base = static_cast<PhysPt>(data_segment) << 4;
+	for (uint32_t i = 0; i < data_size; ++i) {
+		state.data.push_back(mem_readb(data_base + i));
+	}
+	return state;
+}
+
+void run_core(CPU_Decoder *core, const int32_t cycles)
+{
+	CPU_Cycles = cycles;
+	while (CPU_Cycles > 0) {
+		core();
+	}
+}
+
+class CoreNormalTest : public DOSBoxTestFixture {};
+
+TEST_F(CoreNormalTest, ThreadedDispatchMatchesSwitch)
+{
+	const auto code = make_instruction_mix();
+
+	// Stop at a few different points, also in the middle of a REP string
+	// instruction
+	for (const int32_t cycles : {1, 7, 1000, 12345, 250'000}) {
+		reset_state(code);
+		run_core(&CPU_Core_Normal_Switch_Run, cycles);
+		const auto expected = capture_state();
+
+		reset_state(code);
+		run_core(&CPU_Core_Normal_Run, cycles);
+		const auto actual = capture_state();
+
+		EXPECT_TRUE(actual == expected) << "after " << cycles << " cycles";
+		EXPECT_EQ(actual.eip, expected.eip);
+		EXPECT_EQ(actual.regs, expected.regs);
+		EXPECT_EQ(actual.flags, expected.flags);
+	}
+}
+
+// Prefixed instructions pass through the dispatch once per prefix byte
+TEST_F(CoreNormalTest, ThreadedDispatchMatchesSwitchWithPrefixes)
+{
+	const auto code = make_prefix_mix();
+
+	for (const int32_t cycles : {1, 2, 3, 1000, 12345, 250'000}) {
+		reset_state(code);
+		run_core(&CPU_Core_Normal_Switch_Run, cycles);
+		const auto expected = capture_state();
+
+		reset_state(code);
+		run_core(&CPU_Core_Normal_Run, cycles);
+		const auto actual = capture_state();
+
+		EXPECT_TRUE(actual == expected) << "after " << cycles << " cycles";
+		EXPECT_EQ(actual.eip, expected.eip);
+		EXPECT_EQ(actual.regs, expected.regs);
+		EXPECT_EQ(actual.flags, expected.flags);
+	}
+}
+
+TEST_F(CoreNormalTest, DecodeCacheMatchesReference)
+{
+	const auto code = make_prefix_mix();
+
+	CPU_Core_Normal_Cache_Init(true);
+	for (const int32_t cycles : {1, 2, 3, 1000, 12345, 250'000}) {
+		reset_state(code);
+		run_core(&CPU_Core_Normal_Switch_Run, cycles);
+		const auto expected = capture_state();
+
+		// Twice, the second time with the entries of the first
+		for (int pass = 0; pass < 2; ++pass) {
+			reset_state(code);
+			run_core(&CPU_Core_Normal_Run, cycles);
+			const auto actual = capture_state();
+
+			EXPECT_TRUE(actual == expected)
+			        << "after " << cycles << " cycles, pass " << pass;
+			EXPECT_EQ(actual.eip, expected.eip);
+			EXPECT_EQ(actual.regs, expected.regs);
+			EXPECT_EQ(actual.flags, expected.flags);
+		}
+	}
+	CPU_Core_Normal_Cache_Close();
+}
+
+// Rewrites the prefix, the opcode, and the ModRM byte of a cached
+// instruction between runs, as self-modifying code would
+TEST_F(CoreNormalTest, DecodeCacheSeesModifiedCode)
+{
+	const auto code = make_prefix_mix();
+	ASSERT_EQ(code[patched_offset + 0], 0x66);
+	ASSERT_EQ(code[patched_offset + 1], 0x01);
+	ASSERT_EQ(code[patched_offset + 2], 0xc8);
+	ASSERT_EQ(code[patched_offset + 3], 0x26);
+
+	const auto patched_address = (static_cast<PhysPt>(code_segment) << 4) +
+	                             static_cast<PhysPt>(patched_offset);
+
+	const auto run_patched = [&](CPU_Decoder *core) {
+		reset_state(code);
+		run_core(core, 5000);
+		// add eax,ecx becomes add ax,cx with an ES override
+		mem_writeb(patched_address, 0x26);
+		run_core(core, 5000);
+		// sub ax,cx
+		mem_writeb(patched_address + 1, 0x29);
+		run_core(core, 5000);
+		// sub ax,bx
+		mem_writeb(patched_address + 2, 0xd8);
+		run_core(core, 5000);
+		// and back to add eax,ecx, in one write with the next prefix
+		mem_writed(patched_address, 0x26c80166);
+		run_core(core, 5000);
+		return capture_state();
+	};
+
+	CPU_Core_Normal_Cache_Init(true);
+	const auto expected = run_patched(&CPU_Core_Normal_Switch_Run);
+	const auto actual   = run_patched(&CPU_Core_Normal_Run);
+	CPU_Core_Normal_Cache_Close();
+
+	EXPECT_TRUE(actual == expected);
+	EXPECT_EQ(actual.regs, expected.regs);
+	EXPECT_EQ(actual.flags, expected.flags);
+}
+
+// REP MOVS and STOS over page boundaries, in both directions, overlapping,
+// and wrapping the 16-bit index, compared against element by element copies
+// of the whole data segment. Run in one go and in slices that interrupt the
+// repetitions part way.
+TEST_F(CoreNormalTest, RepStringBlocksMatchElementLoop)
+{
+	const std::vector<uint8_t> code = {
+	        0xbe, 0x00, 0x01,                   // mov si,0x100
+	        0xbf, 0x01, 0x01,                   // mov di,0x101
+	        0xb9, 0x00, 0x12,                   // mov cx,0x1200
+	        0xf3, 0xa4,                         // rep movsb
+	        0xfd,                               // std
+	        0xbe, 0xfe, 0x3f,                   // mov si,0x3ffe
+	        0xbf, 0xfe, 0x6f,                   // mov di,0x6ffe
+	        0xb9, 0x00, 0x08,                   // mov cx,0x800
+	        0xf3, 0xa5,                         // rep movsw
+	        0xbe, 0x00, 0x80,                   // mov si,0x8000
+	        0xbf, 0x02, 0x80,                   // mov di,0x8002
+	        0xb9, 0x00, 0x03,                   // mov cx,0x300
+	        0x66, 0xf3, 0xa5,                   // rep movsd
+	        0xfc,                               // cld
+	        0xb8, 0xef, 0xbe,                   // mov ax,0xbeef
+	        0xbf, 0xf0, 0xff,                   // mov di,0xfff0
+	        0xb9, 0x20, 0x00,                   // mov cx,0x20
+	        0xf3, 0xab,                         // rep stosw
+	        0x66, 0xb8, 0x78, 0x56, 0x34, 0x12, // mov eax,0x12345678
+	        0xbf, 0x03, 0xa0,                   // mov di,0xa003
+	        0xb9, 0x00, 0x05,                   // mov cx,0x500
+	        0x66, 0xf3, 0xab,                   // rep stosd
+	        0xbe, 0x04, 0xc0,                   // mov si,0xc004
+	        0xbf, 0x00, 0xc0,                   // mov di,0xc000
+	        0xb9, 0x00, 0x06,                   // mov cx,0x600
+	        0x66, 0xf3, 0xa5,                   // rep movsd
+	        0xfd,                               // std
+	        0xb0, 0x77,                         // mov al,0x77
+	        0xbf, 0x10, 0x00,                   // mov di,0x10
+	        0xb9, 0x40, 0x00,                   // mov cx,0x40
+	        0xf3, 0xaa,                         // rep stosb
+	        0xbe, 0x06, 0x00,                   // mov si,0x6
+	        0xbf, 0x02, 0x50,                   // mov di,0x5002
+	        0xb9, 0x00, 0x01,                   // mov cx,0x100
+	        0xf3, 0xa5,                         // rep movsw
+	        0xfc,                               // cld
+	        0xbe, 0xf8, 0xff,                   // mov si,0xfff8
+	        0xbf, 0xf4, 0x2f,                   // mov di,0x2ff4
+	        0xb9, 0x10, 0x00,                   // mov cx,0x10
+	        0x66, 0xf3, 0xa5,                   // rep movsd
+	        0xeb, 0xfe,                         // jmp $
+	};
+
+	constexpr size_t segment_size = 0x10000;
+	const auto data_base = static_cast<PhysPt>(data_segment) << 4;
+
+	std::vector<uint8_t> initial(segment_size);
+	for (size_t i = 0; i < initial.size(); ++i) {
+		initial[i] = static_cast<uint8_t>(i ^ (i >> 8) ^ 0x5a);
+	}
+
+	// The same operations, one element at a time
+	auto expected = initial;
+	auto movs = [&](uint16_t si, uint16_t di, uint16_t cx, int size, int step) {
+		for (; cx; --cx) {
+			for (int b = 0; b < size; ++b) {
+				expected[static_cast<uint16_t>(di + b)] =
+				        expected[static_cast<uint16_t>(si + b)];
+			}
+			si = static_cast<uint16_t>(si + step * size);
+			di = static_cast<uint16_t>(di + step * size);
+		}
+	};
+	auto stos = [&](uint16_t di, uint16_t cx, uint32_t val, int size, int step) {
+		for (; cx; --cx) {
+			for (int b = 0; b < size; ++b) {
+				expected[static_cast<uint16_t>(di + b)] =
+				        static_cast<uint8_t>(val >> (b * 8));
+			}
+			di = static_cast<uint16_t>(di + step * size);
+		}
+	};
+	movs(0x100, 0x101, 0x1200, 1, 1);
+	movs(0x3ffe, 0x6ffe, 0x800, 2, -1);
+	movs(0x8000, 0x8002, 0x300, 4, -1);
+	stos(0xfff0, 0x20, 0xbeef, 2, 1);
+	stos(0xa003, 0x500, 0x12345678, 4, 1);
+	movs(0xc004, 0xc000, 0x600, 4, 1);
+	stos(0x10, 0x40, 0x77, 1, -1);
+	movs(0x6, 0x5002, 0x100, 2, -1);
+	movs(0xfff8, 0x2ff4, 0x10, 4, 1);
+
+	for (const int32_t slice : {1'000'000, 4099, 37, 1}) {
+		reset_state(code);
+		for (size_t i = 0; i < initial.size(); ++i) {
+			mem_writeb(data_base + static_cast<PhysPt>(i), initial[i]);
+		}
+		for (int32_t total = 0; total < 200'000; total += slice) {
+			run_core(&CPU_Core_Normal_Run, slice);
+		}
+
+		std::vector<uint8_t> actual(segment_size);
+		for (size_t i = 0; i < actual.size(); ++i) {
+			actual[i] = mem_readb(data_base + static_cast<PhysPt>(i));
+		}
+		EXPECT_TRUE(actual == expected) << "in slices of " << slice;
+		EXPECT_EQ(reg_cx, 0);
+		EXPECT_EQ(reg_si, 0x0038);
+		EXPECT_EQ(reg_di, 0x3034);
+		EXPECT_EQ(reg_eip, code.size() - 2);
+		EXPECT_FALSE(GETFLAG(DF));
+	}
+}
+
+// The same against the chained VGA window at A000, whose handler takes the
+// blocks in one call: copies from RAM and fills, in both directions, across
+// pages and wrapping the 16-bit index, in one go and in slices
+TEST_F(CoreNormalTest, RepStringBlocksMatchElementLoopOnVga)
+{
+	const std::vector<uint8_t> code = {
+	        0xb8, 0x00, 0xa0,                   // mov ax,0xa000
+	        0x8e, 0xc0,                         // mov es,ax
+	        0xbe, 0x00, 0x01,                   // mov si,0x100
+	        0xbf, 0xfe, 0x0f,                   // mov di,0xffe
+	        0xb9, 0x01, 0x08,                   // mov cx,0x801
+	        0xf3, 0xa5,                         // rep movsw
+	        0xfd,                               // std
+	        0x66, 0xb8, 0x78, 0x56, 0x34, 0x12, // mov eax,0x12345678
+	        0xbf, 0xfd, 0x3f,                   // mov di,0x3ffd
+	        0xb9, 0x00, 0x09,                   // mov cx,0x900
+	        0x66, 0xf3, 0xab,                   // rep stosd
+	        0xbe, 0x02, 0x90,                   // mov si,0x9002
+	        0xbf, 0x01, 0x70,                   // mov di,0x7001
+	        0xb9, 0x00, 0x06,                   // mov cx,0x600
+	        0x66, 0xf3, 0xa5,                   // rep movsd
+	        0xfc,                               // cld
+	        0xbf, 0xf0, 0xff,                   // mov di,0xfff0
+	        0xb9, 0x20, 0x00,                   // mov cx,0x20
+	        0xf3, 0xab,                         // rep stosw
+	        0xbe, 0x00, 0x20,                   // mov si,0x2000
+	        0xbf, 0x00, 0xc0,                   // mov di,0xc000
+	        0xb9, 0x01, 0x10,                   // mov cx,0x1001
+	        0xf3, 0xa4,                         // rep movsb
+	        0xeb, 0xfe,                         // jmp $
+	};
+
+	constexpr size_t segment_size = 0x10000;
+	constexpr PhysPt vga_base     = 0xa0000;
+	const auto data_base = static_cast<PhysPt>(data_segment) << 4;
+
+	// Mode 13h's chained memory, mapped at A000 only
+	const auto old_mode     = vga.mode;
+	const auto old_config   = vga.config;
+	const auto old_gfx_misc = vga.gfx.miscellaneous;
+	vga.mode                     = M_VGA;
+	vga.config.chained           = true;
+	vga.config.compatible_chain4 = true;
+	vga.gfx.miscellaneous        = 0x05;
+	VGA_SetupHandlers();
+	PAGING_ClearTLB();
+	ASSERT_TRUE(MEM_GetPageHandler(vga_base >> 12)->flags & PFLAG_BLOCKWRITE);
+
+	std::vector<uint8_t> source(segment_size);
+	std::vector<uint8_t> initial(segment_size);
+	for (size_t i = 0; i < segment_size; ++i) {
+		source[i]  = static_cast<uint8_t>(i ^ (i >> 8) ^ 0x5a);
+		initial[i] = static_cast<uint8_t>(i * 7 + (i >> 9));
+	}
+
+	// The same operations, one element at a time
+	auto expected = initial;
+	auto movs = [&](uint16_t si, uint16_t di, uint16_t cx, int size, int step) {
+		for (; cx; --cx) {
+			for (int b = 0; b < size; ++b) {
+				expected[static_cast<uint16_t>(di + b)] =
+				        source[static_cast<uint16_t>(si + b)];
+			}
+			si = static_cast<uint16_t>(si + step * size);
+			di = static_cast<uint16_t>(di + step * size);
+		}
+	};
+	auto stos = [&](uint16_t di, uint16_t cx, uint32_t val, int size, int step) {
+		for (; cx; --cx) {
+			for (int b = 0; b < size; ++b) {
+				expected[static_cast<uint16_t>(di + b)] =
+				        static_cast<uint8_t>(val >> (b * 8));
+			}
+			di = static_cast<uint16_t>(di + step * size);
+		}
+	};
+	movs(0x100, 0xffe, 0x801, 2, 1);
+	stos(0x3ffd, 0x900, 0x12345678, 4, -1);
+	movs(0x9002, 0x7001, 0x600, 4, -1);
+	stos(0xfff0, 0x20, 0x5678, 2, 1);
+	movs(0x2000, 0xc000, 0x1001, 1, 1);
+
+	for (const int32_t slice : {1'000'000, 4099, 37, 1}) {
+		reset_state(code);
+		for (size_t i = 0; i < segment_size; ++i) {
+			const auto offset = static_cast<PhysPt>(i);
+			mem_writeb(data_base + offset, source[i]);
+			mem_writeb(vga_base + offset, initial[i]);
+		}
+		for (int32_t total = 0; total < 200'000; total += slice) {
+			run_core(&CPU_Core_Normal_Run, slice);
+		}
+
+		std::vector<uint8_t> actual(segment_size);
+		for (size_t i = 0; i < actual.size(); ++i) {
+			actual[i] = mem_readb(vga_base + static_cast<PhysPt>(i));
+		}
+		EXPECT_TRUE(actual == expected) << "in slices of " << slice;
+		EXPECT_EQ(reg_cx, 0);
+		EXPECT_EQ(reg_si, 0x3001);
+		EXPECT_EQ(reg_di, 0xd001);
+		EXPECT_EQ(reg_eip, code.size() - 2);
+	}
+
+	vga.mode              = old_mode;
+	vga.config            = old_config;
+	vga.gfx.miscellaneous = old_gfx_misc;
+	VGA_SetupHandlers();
+	PAGING_ClearTLB();
+}
+
+// Runs the same instruction mix through the switch and the threaded dispatch
+// and prints the time each took. Without compiler support for computed goto
+// both entry points use the switch.
+TEST_F(CoreNormalTest, BenchmarkDispatch)
+{
+	constexpr int32_t cycles_per_run = 1'000'000;
+	constexpr int runs               = 20;
+
+	const auto code = make_instruction_mix();
+
+	using clock = std::chrono::steady_clock;
+
+	const auto time_core = [&](CPU_Decoder *core) {
+		reset_state(code);
+		const auto start = clock::now();
+		for (int i = 0; i < runs; ++i) {
+			run_core(core, cycles_per_run);
+		}
+		return clock::now() - start;
+	};
+
+	const auto switch_time   = time_core(&CPU_Core_Normal_Switch_Run);
+	const auto threaded_time = time_core(&CPU_Core_Normal_Run);
+
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+	printf("Normal core, %d instructions: switch %lld us, threaded %lld us%s\n",
+	       cycles_per_run * runs,
+	       static_cast<long long>(duration_cast<microseconds>(switch_time).count()),
+	       static_cast<long long>(duration_cast<microseconds>(threaded_time).count()),
+#if C_COMPUTED_GOTO
+	       ""
+#else
+	       " (threaded dispatch not available)"
+#endif
+	);
+}
+
+// Runs the prefix mix through the normal core with and without the decoded
+// instruction cache and prints the time each took
+TEST_F(CoreNormalTest, BenchmarkDecodeCache)
+{
+	constexpr int32_t cycles_per_run = 1'000'000;
+	constexpr int runs               = 20;
+
+	const auto code = make_prefix_mix();
+
+	using clock = std::chrono::steady_clock;
+
+	const auto time_core = [&](const bool enable_cache) {
+		CPU_Core_Normal_Cache_Init(enable_cache);
+		reset_state(code);
+		const auto start = clock::now();
+		for (int i = 0; i < runs; ++i) {
+			run_core(&CPU_Core_Normal_Run, cycles_per_run);
+		}
+		const auto elapsed = clock::now() - start;
+		CPU_Core_Normal_Cache_Close();
+		return elapsed;
+	};
+
+	const auto uncached_time = time_core(false);
+	const auto cached_time   = time_core(true);
+
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+	printf("Normal core, %d prefixed instructions: uncached %lld us, cached %lld us\n",
+	       cycles_per_run * runs,
+	       static_cast<long long>(duration_cast<microseconds>(uncached_time).count()),
+	       static_cast<long long>(duration_cast<microseconds>(cached_time).count()));
+}
+
+} // namespace
@@ -0,0 +1,138 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "dma.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mem.h"
+
+#include "dosbox_test_fixture.h"
+
+namespace {
+
+// An 8-bit channel, clear of the Sound Blaster's, with a buffer at 0x20f80
+// that straddles several 4 KB pages
+constexpr uint8_t channel_num = 3;
+constexpr uint8_t page_num    = 0x02;
+constexpr uint16_t address    = 0x0f80;
+constexpr uint16_t length     = 0x2100;
+
+constexpr PhysPt buffer_start = (page_num << 16) + address;
+
+class DmaTest : public DOSBoxTestFixture {
+protected:
+	void SetUp() override
+	{
+		DOSBoxTestFixture::SetUp();
+
+		for (PhysPt i = 0; i < length; ++i) {
+			phys_writeb(buffer_start + i, static_cast<uint8_t>(i * 13 + 1));
+		}
+	}
+
+	DmaChannel* Program(const bool is_autoiniting)
+	{
+		auto chan = DMA_GetChannel(channel_num);
+		EXPECT_NE(chan, nullptr);
+		chan->SetPage(page_num);
+		chan->base_addr      = address;
+		chan->curr_addr      = address;
+		chan->base_count     = length - 1;
+		chan->curr_count     = length - 1;
+		chan->is_autoiniting = is_autoiniting;
+		chan->is_masked      = false;
+		return chan;
+	}
+};
+
+std::vector<uint8_t> read_spans(DmaChannel* chan, const size_t words, size_t& done)
+{
+	std::vector<uint8_t> data;
+	done = chan->ReadSpans(words, [&](const uint8_t* span, const size_t num_bytes) {
+		data.insert(data.end(), span, span + num_bytes);
+	});
+	return data;
+}
+
+TEST_F(DmaTest, ReadCrossesPages)
+{
+	auto chan = Program(false);
+
+	std::vector<uint8_t> data(length);
+	EXPECT_EQ(chan->Read(length, data.data()), length);
+	for (PhysPt i = 0; i < length; ++i) {
+		ASSERT_EQ(data[i], phys_readb(buffer_start + i));
+	}
+	EXPECT_TRUE(chan->has_reached_terminal_count);
+	EXPECT_TRUE(chan->is_masked);
+}
+
+TEST_F(DmaTest, WriteCrossesPages)
+{
+	auto chan = Program(false);
+
+	std::vector<uint8_t> data(length);
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<uint8_t>(0xff - i);
+	}
+	EXPECT_EQ(chan->Write(length, data.data()), length);
+	for (PhysPt i = 0; i < length; ++i) {
+		ASSERT_EQ(phys_readb(buffer_start + i), data[i]);
+	}
+}
+
+TEST_F(DmaTest, SpansMatchRead)
+{
+	// Read in odd sizes so transfers start and end mid-page
+	constexpr size_t chunk = 0x777;
+
+	std::vector<uint8_t> expected(chunk);
+	Program(false)->Read(chunk, expected.data());
+
+	size_t done = 0;
+	const auto spans = read_spans(Program(false), chunk, done);
+	EXPECT_EQ(done, chunk);
+	EXPECT_EQ(spans, expected);
+}
+
+TEST_F(DmaTest, SpansWrapAroundWhenAutoIniting)
+{
+	// Read one and a half times around the buffer
+	constexpr size_t words = length + length / 2;
+
+	std::vector<uint8_t> expected(words);
+	Program(true)->Read(words, expected.data());
+	for (PhysPt i = 0; i < words; ++i) {
+		ASSERT_EQ(expected[i], phys_readb(buffer_start + i % length));
+	}
+
+	size_t done = 0;
+	auto chan = Program(true);
+	const auto spans = read_spans(chan, words, done);
+	EXPECT_EQ(done, words);
+	EXPECT_EQ(spans, expected);
+	EXPECT_EQ(chan->curr_addr, address + length / 2);
+	EXPECT_FALSE(chan->is_masked);
+}
+
+} // namespace
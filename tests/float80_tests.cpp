@@ -0,0 +1,330 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "float80.h"
+
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// x86 hosts have the 80-bit format as long double, which makes the host's
+// own conversions the reference
+constexpr bool has_x87_long_double = (LDBL_MANT_DIG == 64 && LDBL_MAX_EXP == 16384);
+
+Float80 make(const uint16_t sign_exponent, const uint64_t mantissa)
+{
+	Float80 value       = {};
+	value.sign_exponent = sign_exponent;
+	value.mantissa      = mantissa;
+	return value;
+}
+
+uint64_t bits(const double d)
+{
+	return float80::double_to_bits(d);
+}
+
+// The conversion the portable FPU used before, kept as the benchmark baseline
+double legacy_to_double(const Float80 in)
+{
+	const int64_t exp64      = ((in.sign_exponent & 0x7fff) - 16383);
+	const int64_t blah       = ((exp64 > 0) ? exp64 : -exp64) & 0x3ff;
+	const int64_t exp64final = ((exp64 > 0) ? blah : -blah) + 1023;
+
+	const int64_t mant64 = (in.mantissa >> 11) & 0xfffffffffffff;
+	const int64_t sign   = (in.sign_exponent & 0x8000) ? 1 : 0;
+
+	auto result = float80::bits_to_double(static_cast<uint64_t>(
+	        (sign << 63) | (exp64final << 52) | mant64));
+	if (in.mantissa == float80::integer_bit &&
+	    (in.sign_exponent & 0x7fff) == 0x7fff) {
+		result = sign ? -HUGE_VAL : HUGE_VAL;
+	}
+	return result;
+}
+
+// A corpus of 80-bit values: every exponent class, significands that need
+// rounding, and random patterns
+std::vector<Float80> make_corpus()
+{
+	std::vector<Float80> corpus = {};
+
+	const uint16_t exponents[] = {
+	        0x0000, 0x0001, 0x3bcc, 0x3bcd, 0x3bce, 0x3c00, 0x3c01,
+	        0x3fff, 0x4000, 0x43fe, 0x43ff, 0x4400, 0x7ffe, 0x7fff,
+	};
+	const uint64_t mantissas[] = {
+	        0x8000000000000000, 0x8000000000000400, 0x8000000000000401,
+	        0x8000000000000c00, 0xffffffffffffffff, 0xfffffffffffff800,
+	        0xfffffffffffffbff, 0xc000000000000000, 0x4000000000000000,
+	        0x0000000000000001, 0x0000000000000000, 0x8123456789abcdef,
+	};
+	for (const auto exponent : exponents) {
+		for (const auto mantissa : mantissas) {
+			corpus.push_back(make(exponent, mantissa));
+			corpus.push_back(make(exponent | 0x8000, mantissa));
+		}
+	}
+
+	std::mt19937_64 rng(80);
+	std::uniform_int_distribution<int> exponent_dist(0x3bc0 - 16, 0x4400 + 16);
+	for (int i = 0; i < 100'000; ++i) {
+		const auto sign = static_cast<uint16_t>((rng() & 1) << 15);
+		corpus.push_back(make(sign | static_cast<uint16_t>(exponent_dist(rng)),
+		                      rng() | float80::integer_bit));
+	}
+	return corpus;
+}
+
+bool is_nan(const Float80 value)
+{
+	return (value.sign_exponent & 0x7fff) == 0x7fff && (value.mantissa << 1) != 0;
+}
+
+TEST(Float80, RoundsToNearestEven)
+{
+	// 1.0 plus exactly half an ulp of a double rounds to the even 1.0
+	EXPECT_EQ(FLOAT80_ToDouble(make(0x3fff, 0x8000000000000400)), 1.0);
+	// ... and just above half an ulp rounds up
+	EXPECT_EQ(FLOAT80_ToDouble(make(0x3fff, 0x8000000000000401)),
+	          std::nextafter(1.0, 2.0));
+	// Half an ulp above an odd significand rounds up to even
+	EXPECT_EQ(FLOAT80_ToDouble(make(0x3fff, 0x8000000000000c00)),
+	          1.0 + 2 * DBL_EPSILON);
+	// Rounding up can carry into the exponent
+	EXPECT_EQ(FLOAT80_ToDouble(make(0x3fff, 0xffffffffffffffff)), 2.0);
+}
+
+TEST(Float80, SpecialValues)
+{
+	EXPECT_EQ(bits(FLOAT80_ToDouble(make(0x0000, 0))), bits(0.0));
+	EXPECT_EQ(bits(FLOAT80_ToDouble(make(0x8000, 0))), bits(-0.0));
+	EXPECT_EQ(FLOAT80_ToDouble(make(0x7fff, float80::integer_bit)), HUGE_VAL);
+	EXPECT_EQ(FLOAT80_ToDouble(make(0xffff, float80::integer_bit)), -HUGE_VAL);
+	EXPECT_TRUE(std::isnan(FLOAT80_ToDouble(make(0x7fff, 0xc000000000000000))));
+	// A signalling NaN whose payload doesn't fit must stay a NaN
+	EXPECT_TRUE(std::isnan(FLOAT80_ToDouble(make(0x7fff, 0x8000000000000001))));
+}
+
+TEST(Float80, OutOfRangeSaturates)
+{
+	// The old conversion wrapped these exponents around
+	EXPECT_EQ(FLOAT80_ToDouble(make(0x5000, float80::integer_bit)), HUGE_VAL);
+	EXPECT_EQ(FLOAT80_ToDouble(make(0xd000, float80::integer_bit)), -HUGE_VAL);
+	EXPECT_EQ(bits(FLOAT80_ToDouble(make(0x2000, float80::integer_bit))), bits(0.0));
+
+	// 2^-1074 is the smallest double denormal
+	EXPECT_EQ(FLOAT80_ToDouble(make(0x3fff - 1074, float80::integer_bit)),
+	          std::numeric_limits<double>::denorm_min());
+}
+
+TEST(Float80, DoublesRoundTrip)
+{
+	std::mt19937_64 rng(64);
+	std::vector<double> values = {0.0, -0.0, 1.0, -1.5, DBL_MIN, DBL_MAX,
+	                              std::numeric_limits<double>::denorm_min(),
+	                              DBL_MIN / 3, HUGE_VAL, -HUGE_VAL};
+	for (int i = 0; i < 100'000; ++i) {
+		values.push_back(float80::bits_to_double(rng()));
+	}
+	for (const auto value : values) {
+		const auto converted = FLOAT80_ToDouble(FLOAT80_FromDouble(value));
+		if (std::isnan(value)) {
+			EXPECT_TRUE(std::isnan(converted));
+		} else {
+			EXPECT_EQ(bits(converted), bits(value)) << value;
+		}
+	}
+}
+
+TEST(Float80, MatchesHostLoads)
+{
+	if (!has_x87_long_double) {
+		GTEST_SKIP() << "The host has no 80-bit long double";
+	}
+	for (const auto& value : make_corpus()) {
+		// The host FPU rejects unnormals; they're invalid since the 387
+		if ((value.sign_exponent & 0x7fff) != 0 &&
+		    (value.mantissa & float80::integer_bit) == 0) {
+			continue;
+		}
+		long double host = 0.0L;
+		std::memcpy(&host, &value.mantissa, sizeof(value.mantissa));
+		std::memcpy(reinterpret_cast<char*>(&host) + sizeof(value.mantissa),
+		            &value.sign_exponent,
+		            sizeof(value.sign_exponent));
+
+		const auto expected = static_cast<double>(host);
+		const auto actual   = FLOAT80_ToDouble(value);
+		if (is_nan(value)) {
+			EXPECT_TRUE(std::isnan(actual));
+			continue;
+		}
+		EXPECT_EQ(bits(actual), bits(expected))
+		        << std::hex << value.sign_exponent << ":" << value.mantissa;
+	}
+}
+
+TEST(Float80, MatchesHostStores)
+{
+	if (!has_x87_long_double) {
+		GTEST_SKIP() << "The host has no 80-bit long double";
+	}
+	std::mt19937_64 rng(32);
+	for (int i = 0; i < 100'000; ++i) {
+		const auto value = float80::bits_to_double(rng());
+		if (std::isnan(value)) {
+			continue;
+		}
+		const long double host = value;
+
+		Float80 expected = {};
+		std::memcpy(&expected.mantissa, &host, sizeof(expected.mantissa));
+		std::memcpy(&expected.sign_exponent,
+		            reinterpret_cast<const char*>(&host) + sizeof(expected.mantissa),
+		            sizeof(expected.sign_exponent));
+
+		const auto actual = FLOAT80_FromDouble(value);
+		EXPECT_EQ(actual.mantissa, expected.mantissa) << value;
+		EXPECT_EQ(actual.sign_exponent, expected.sign_exponent) << value;
+	}
+}
+
+// Rounding control values, as in the FPU's control word
+constexpr uint8_t to_nearest = 0;
+constexpr uint8_t round_down = 1;
+constexpr uint8_t round_up   = 2;
+constexpr uint8_t round_chop = 3;
+
+TEST(Float80, SinglePrecisionRoundsToNearestEven)
+{
+	const auto ulp = std::ldexp(1.0, -23); // of a 24-bit significand
+
+	// Exactly half an ulp above an even significand stays
+	EXPECT_EQ(FLOAT80_RoundSignificand(1.0 + ulp / 2, 24, to_nearest), 1.0);
+	// ... above an odd one rounds up to even
+	EXPECT_EQ(FLOAT80_RoundSignificand(1.0 + 1.5 * ulp, 24, to_nearest),
+	          1.0 + 2 * ulp);
+	// More than half an ulp rounds up
+	EXPECT_EQ(FLOAT80_RoundSignificand(1.0 + 0.75 * ulp, 24, to_nearest),
+	          1.0 + ulp);
+	EXPECT_EQ(FLOAT80_RoundSignificand(-1.0 - 0.75 * ulp, 24, to_nearest),
+	          -1.0 - ulp);
+	// Rounding up can carry into the exponent
+	EXPECT_EQ(FLOAT80_RoundSignificand(2.0 - ulp / 4, 24, to_nearest), 2.0);
+}
+
+TEST(Float80, SinglePrecisionFollowsRoundingControl)
+{
+	const auto ulp   = std::ldexp(1.0, -23);
+	const auto above = 1.0 + ulp / 4;
+
+	EXPECT_EQ(FLOAT80_RoundSignificand(above, 24, round_down), 1.0);
+	EXPECT_EQ(FLOAT80_RoundSignificand(above, 24, round_up), 1.0 + ulp);
+	EXPECT_EQ(FLOAT80_RoundSignificand(above, 24, round_chop), 1.0);
+
+	EXPECT_EQ(FLOAT80_RoundSignificand(-above, 24, round_down), -1.0 - ulp);
+	EXPECT_EQ(FLOAT80_RoundSignificand(-above, 24, round_up), -1.0);
+	EXPECT_EQ(FLOAT80_RoundSignificand(-above, 24, round_chop), -1.0);
+
+	// Values that fit are never changed
+	for (const auto rounding : {to_nearest, round_down, round_up, round_chop}) {
+		EXPECT_EQ(FLOAT80_RoundSignificand(1.0 + ulp, 24, rounding), 1.0 + ulp);
+	}
+}
+
+// Converting to float would overflow or flush these to zero
+TEST(Float80, SinglePrecisionKeepsTheExponentRange)
+{
+	const auto fraction = 1.0 + std::ldexp(1.0, -30);
+
+	EXPECT_EQ(FLOAT80_RoundSignificand(std::ldexp(fraction, 1000), 24, to_nearest),
+	          std::ldexp(1.0, 1000));
+	EXPECT_EQ(FLOAT80_RoundSignificand(std::ldexp(fraction, -1000), 24, to_nearest),
+	          std::ldexp(1.0, -1000));
+	EXPECT_EQ(FLOAT80_RoundSignificand(std::ldexp(fraction, -1000), 24, round_up),
+	          std::ldexp(1.0 + std::ldexp(1.0, -23), -1000));
+	EXPECT_EQ(FLOAT80_RoundSignificand(DBL_MAX, 53, to_nearest), DBL_MAX);
+}
+
+TEST(Float80, PrecisionControlSpecialValues)
+{
+	EXPECT_EQ(bits(FLOAT80_RoundSignificand(-0.0, 24, to_nearest)), bits(-0.0));
+	EXPECT_EQ(FLOAT80_RoundSignificand(HUGE_VAL, 24, round_down), HUGE_VAL);
+	EXPECT_TRUE(std::isnan(FLOAT80_RoundSignificand(std::nan(""), 24, to_nearest)));
+}
+
+// Within the range of floats, rounding to nearest gives what converting
+// to float does with the host's default rounding
+TEST(Float80, SinglePrecisionMatchesFloatConversion)
+{
+	std::mt19937_64 rng(24);
+	std::uniform_real_distribution<double> fraction(-2.0, 2.0);
+	// Clear of float denormals, which have fewer significant bits
+	std::uniform_int_distribution<int> exponent(-100, 100);
+	for (int i = 0; i < 100'000; ++i) {
+		const auto value    = std::ldexp(fraction(rng), exponent(rng));
+		const auto as_float = static_cast<double>(static_cast<float>(value));
+		EXPECT_EQ(FLOAT80_RoundSignificand(value, 24, to_nearest), as_float)
+		        << value;
+	}
+}
+
+TEST(Float80, BenchmarkLoads)
+{
+	const auto corpus = make_corpus();
+	constexpr int passes = 20;
+
+	using clock = std::chrono::steady_clock;
+
+	const auto time_loads = [&](auto convert) {
+		double sum       = 0.0;
+		const auto start = clock::now();
+		for (int pass = 0; pass < passes; ++pass) {
+			for (const auto& value : corpus) {
+				sum += convert(value);
+			}
+		}
+		const auto elapsed = clock::now() - start;
+		// Keep the loop from being optimized away
+		EXPECT_FALSE(sum == 1.0);
+		return elapsed;
+	};
+
+	const auto legacy_time = time_loads(legacy_to_double);
+	const auto new_time    = time_loads(FLOAT80_ToDouble);
+
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+	printf("80-bit loads, %zu values: legacy %lld us, rounded %lld us\n",
+	       corpus.size() * passes,
+	       static_cast<long long>(duration_cast<microseconds>(legacy_time).count()),
+	       static_cast<long long>(duration_cast<microseconds>(new_time).count()));
+}
+
+} // namespace
@@ -0,0 +1,247 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "frame_skip.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr int host_60hz_us = 16667;
+constexpr int host_30hz_us = 33333;
+constexpr int64_t dos_70hz_us = 14286;
+
+// A 70 Hz DOS rate while fast-forwarding
+constexpr int64_t dos_turbo_us = dos_70hz_us / 2;
+
+struct Run {
+	int frames           = 0;
+	int skips            = 0;
+	int mismatches       = 0;
+	int presents         = 0;
+	int dropped_presents = 0;
+};
+
+// Runs DOS frames of the given host durations back to back, as the renderer
+// and the throttled presenter see them. Every frame is drawn and presented
+// as without skipping, and the verifier compares the skipping against that.
+Run run_frames(const std::vector<int64_t>& durations_us, const int period_us,
+               const std::vector<bool>& new_frames = {})
+{
+	FrameThrottle throttle       = {};
+	FrameSkipPredictor predictor = {};
+	FrameSkipVerifier check      = {};
+	Run run                      = {};
+
+	int64_t now_us = 1'000'000;
+	for (size_t i = 0; i < durations_us.size(); ++i) {
+		const auto skip = predictor.IsSkipPredicted(now_us,
+		                                            check.LastPresentUs(),
+		                                            period_us);
+		predictor.FrameEnded(durations_us[i]);
+		now_us += durations_us[i];
+
+		const auto is_new = new_frames.empty() || new_frames[i % new_frames.size()];
+		const auto presented = throttle.Present(now_us, period_us, is_new);
+		run.presents += presented;
+		if (check.Check(now_us, period_us, is_new, skip, presented)) {
+			run.dropped_presents += presented;
+		}
+	}
+	run.frames     = check.frames;
+	run.skips      = check.skips;
+	run.mismatches = check.mismatches;
+	return run;
+}
+
+std::vector<int64_t> steady_frames(const int64_t frame_us, const int count)
+{
+	return std::vector<int64_t>(static_cast<size_t>(count), frame_us);
+}
+
+std::vector<int64_t> jittery_frames(const int64_t frame_us, const int jitter_percent,
+                                    const int count, const uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	const auto jitter_us = frame_us * jitter_percent / 100;
+	std::uniform_int_distribution<int64_t> jitter(-jitter_us, jitter_us);
+
+	std::vector<int64_t> durations(static_cast<size_t>(count));
+	for (auto& duration : durations) {
+		duration = frame_us + jitter(rng);
+	}
+	return durations;
+}
+
+TEST(FrameSkip, PredictsFramesEndingWithinThePeriod)
+{
+	FrameSkipPredictor predictor = {};
+	for (int i = 0; i < 100; ++i) {
+		predictor.FrameEnded(10'000);
+	}
+	// Steady 10 ms frames leave only the timer's margin
+	const auto margin = predictor.MarginUs();
+	EXPECT_LT(margin, 1'000);
+
+	constexpr int64_t now = 100'000;
+	const auto last_present = now + 10'000 + margin - host_60hz_us;
+	EXPECT_TRUE(predictor.IsSkipPredicted(now, last_present + 1, host_60hz_us));
+	EXPECT_FALSE(predictor.IsSkipPredicted(now, last_present, host_60hz_us));
+}
+
+TEST(FrameSkip, JitterWidensTheMargin)
+{
+	FrameSkipPredictor steady = {};
+	FrameSkipPredictor jittery = {};
+	for (int i = 0; i < 100; ++i) {
+		steady.FrameEnded(10'000);
+		jittery.FrameEnded(i % 2 ? 8'000 : 12'000);
+	}
+	EXPECT_GT(jittery.MarginUs(), steady.MarginUs() + 4'000);
+
+	// A frame predicted to end 3 ms short of the period is only skipped
+	// when the frames are steady
+	constexpr int64_t now = 100'000;
+	const auto last_present = now + 10'000 + 3'000 - host_60hz_us;
+	EXPECT_TRUE(steady.IsSkipPredicted(now, last_present, host_60hz_us));
+	EXPECT_FALSE(jittery.IsSkipPredicted(now, last_present, host_60hz_us));
+}
+
+TEST(FrameSkip, FirstFramesAreDrawn)
+{
+	// No frame has been presented or timed yet
+	FrameSkipPredictor predictor = {};
+	EXPECT_FALSE(predictor.IsSkipPredicted(1'000'000, 0, host_60hz_us));
+
+	// One frame doesn't tell the jitter yet
+	predictor.FrameEnded(1'000);
+	EXPECT_FALSE(predictor.IsSkipPredicted(1'000'000, 1'000'000, host_60hz_us));
+
+	predictor.FrameEnded(1'000);
+	EXPECT_TRUE(predictor.IsSkipPredicted(1'000'000, 1'000'000, host_60hz_us));
+}
+
+TEST(FrameSkip, NoSkipsWhenTheHostKeepsUp)
+{
+	const auto run = run_frames(steady_frames(dos_70hz_us, 1000), 1000000 / 144);
+	EXPECT_EQ(run.skips, 0);
+	EXPECT_EQ(run.mismatches, 0);
+	EXPECT_EQ(run.presents, run.frames);
+}
+
+TEST(FrameSkip, SteadyRatesMatchDrawingEveryFrame)
+{
+	for (const auto frame_us : {dos_70hz_us, dos_turbo_us}) {
+		for (const auto period_us : {host_60hz_us, host_30hz_us}) {
+			const auto run = run_frames(steady_frames(frame_us, 1000),
+			                            period_us);
+			EXPECT_EQ(run.mismatches, 0)
+			        << "frame " << frame_us << ", period " << period_us;
+			EXPECT_EQ(run.dropped_presents, 0)
+			        << "frame " << frame_us << ", period " << period_us;
+		}
+	}
+}
+
+TEST(FrameSkip, SteadyRatesSkipMostDroppedFrames)
+{
+	// 70 Hz frames on a 60 Hz host end up to a few hundred microseconds
+	// short of the period when the presenter drops them
+	for (const auto period_us : {host_60hz_us, host_30hz_us}) {
+		const auto run = run_frames(steady_frames(dos_70hz_us, 1000),
+		                            period_us);
+		const auto dropped = run.frames - run.presents;
+		EXPECT_GT(dropped, 0) << "period " << period_us;
+		EXPECT_LE(run.skips, dropped) << "period " << period_us;
+		EXPECT_GE(run.skips * 10, dropped * 9) << "period " << period_us;
+		EXPECT_EQ(run.mismatches, 0) << "period " << period_us;
+	}
+}
+
+TEST(FrameSkip, JitterRarelyChangesThePresentation)
+{
+	for (const auto period_us : {host_60hz_us, host_30hz_us}) {
+		for (uint32_t seed = 1; seed <= 8; ++seed) {
+			const auto run = run_frames(jittery_frames(dos_70hz_us, 10, 1000, seed),
+			                            period_us);
+			EXPECT_GT(run.skips, 0);
+			EXPECT_LE(run.mismatches * 100, run.frames)
+			        << "period " << period_us << ", seed " << seed;
+		}
+	}
+}
+
+TEST(FrameSkip, UnchangedFramesAreStillPresentedLater)
+{
+	// Only every third DOS frame changes the screen; a skipped frame's
+	// changes are carried to the next drawn one
+	const auto run = run_frames(steady_frames(dos_turbo_us, 1000),
+	                            host_60hz_us,
+	                            {true, false, false});
+	EXPECT_GT(run.skips, 0);
+	EXPECT_EQ(run.dropped_presents, 0);
+
+	// Drawing every frame, a throttled unchanged frame makes the presenter
+	// forget a throttled change before it. Skipping presents the change
+	// sooner, and the verifier reports it.
+	EXPECT_GT(run.mismatches, 0);
+}
+
+TEST(FrameSkip, VerifierCatchesAWrongSkip)
+{
+	// Steady frames predict that the next one ends too soon, but it
+	// stalls past the period. Only some of the frames are predicted to be
+	// dropped, so stall each in turn.
+	auto dropped_presents = 0;
+	auto mismatches       = 0;
+	for (size_t stalled = 100; stalled < 110; ++stalled) {
+		auto durations      = steady_frames(dos_70hz_us, 120);
+		durations[stalled] = 40'000;
+
+		const auto run = run_frames(durations, host_60hz_us);
+		dropped_presents += run.dropped_presents;
+		mismatches += run.mismatches;
+	}
+	EXPECT_GT(dropped_presents, 0);
+	EXPECT_GT(mismatches, 0);
+}
+
+TEST(FrameSkip, BenchmarkSkippedFrames)
+{
+	// The share of DOS frames the presenter drops, of those the skipping
+	// doesn't draw, and of those presented differently, for a 70 Hz DOS
+	// rate on common host rates
+	for (const auto host_hz : {30, 50, 60}) {
+		const auto period_us = 1'000'000 / host_hz;
+		const auto run = run_frames(jittery_frames(dos_70hz_us, 5, 7000, 1),
+		                            period_us);
+		printf("[ BENCHMARK] 70 Hz on %d Hz: %.1f%% dropped, %.1f%% skipped, %.2f%% presented differently\n",
+		       host_hz,
+		       100.0 * (run.frames - run.presents) / run.frames,
+		       100.0 * run.skips / run.frames,
+		       100.0 * run.mismatches / run.frames);
+	}
+}
+
+} // namespace
@@ -0,0 +1,243 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "free_page_runs.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr size_t first_page = 0x110;
+
+// The page scans the memory module used before the free runs, kept as the
+// reference the guest-visible results must match
+class LinearPages {
+public:
+	LinearPages(const size_t num_pages) : used(num_pages, false) {}
+
+	size_t BestMatch(const size_t size) const
+	{
+		size_t index      = first_page;
+		size_t first      = 0;
+		size_t best       = 0xfffffff;
+		size_t best_first = 0;
+		while (index < used.size()) {
+			if (!first) {
+				if (!used[index]) {
+					first = index;
+				}
+			} else if (used[index]) {
+				const auto pages = index - first;
+				if (pages == size) {
+					return first;
+				} else if (pages > size && pages < best) {
+					best       = pages;
+					best_first = first;
+				}
+				first = 0;
+			}
+			index++;
+		}
+		if (first && (index - first >= size) && (index - first < best)) {
+			return first;
+		}
+		return best_first;
+	}
+
+	size_t FreeTotal() const
+	{
+		return static_cast<size_t>(
+		        std::count(used.begin() + first_page, used.end(), false));
+	}
+
+	size_t FreeLargest() const
+	{
+		size_t size    = 0;
+		size_t largest = 0;
+		for (auto index = first_page; index < used.size(); ++index) {
+			if (!used[index]) {
+				++size;
+			} else {
+				largest = std::max(size, largest);
+				size    = 0;
+			}
+		}
+		return std::max(size, largest);
+	}
+
+	size_t RunLength(size_t page) const
+	{
+		if (page > first_page && page < used.size() && !used[page - 1]) {
+			return 0;
+		}
+		size_t length = 0;
+		while (page < used.size() && !used[page]) {
+			++page;
+			++length;
+		}
+		return length;
+	}
+
+	void Set(const size_t page, const size_t num_pages, const bool is_used)
+	{
+		std::fill_n(used.begin() + page, num_pages, is_used);
+	}
+
+	bool IsUsed(const size_t page) const
+	{
+		return used[page];
+	}
+
+	size_t Size() const
+	{
+		return used.size();
+	}
+
+private:
+	std::vector<bool> used;
+};
+
+void expect_same(const LinearPages& linear, const FreePageRuns& runs)
+{
+	EXPECT_EQ(runs.GetFreeTotal(), linear.FreeTotal());
+	EXPECT_EQ(runs.GetFreeLargest(), linear.FreeLargest());
+	for (const size_t size : {1, 2, 3, 4, 7, 16, 33, 100, 256, 1000}) {
+		EXPECT_EQ(runs.FindBestFit(size), linear.BestMatch(size))
+		        << "size " << size;
+	}
+}
+
+TEST(FreePageRuns, EmptyRange)
+{
+	FreePageRuns runs;
+	runs.Reset(first_page, first_page);
+	EXPECT_EQ(runs.GetFreeTotal(), 0);
+	EXPECT_EQ(runs.GetFreeLargest(), 0);
+	EXPECT_EQ(runs.FindBestFit(1), 0);
+}
+
+TEST(FreePageRuns, SplitsAndMerges)
+{
+	FreePageRuns runs;
+	runs.Reset(first_page, first_page + 100);
+	EXPECT_EQ(runs.FindBestFit(100), first_page);
+	EXPECT_EQ(runs.FindBestFit(101), 0);
+
+	runs.Allocate(first_page + 10, 20);
+	EXPECT_EQ(runs.GetFreeTotal(), 80);
+	EXPECT_EQ(runs.GetFreeLargest(), 70);
+	EXPECT_EQ(runs.GetRunLength(first_page), 10);
+	EXPECT_EQ(runs.GetRunLength(first_page + 30), 70);
+	EXPECT_EQ(runs.GetRunLength(first_page + 31), 0);
+	EXPECT_TRUE(runs.IsFree(first_page + 31, 69));
+	EXPECT_FALSE(runs.IsFree(first_page + 31, 70));
+	EXPECT_FALSE(runs.IsFree(first_page + 5, 6));
+	EXPECT_FALSE(runs.IsFree(first_page + 10, 1));
+	EXPECT_FALSE(runs.IsFree(first_page - 1, 1));
+
+	// The smaller run fits first
+	EXPECT_EQ(runs.FindBestFit(5), first_page);
+	EXPECT_EQ(runs.FindBestFit(11), first_page + 30);
+
+	runs.Release(first_page + 15, 5);
+	EXPECT_EQ(runs.GetRunLength(first_page + 15), 5);
+
+	// Bridging the gaps merges all three runs back into one
+	runs.Release(first_page + 10, 5);
+	runs.Release(first_page + 20, 10);
+	EXPECT_EQ(runs.GetRunLength(first_page), 100);
+	EXPECT_EQ(runs.GetFreeLargest(), 100);
+	EXPECT_EQ(runs.GetFreeTotal(), 100);
+}
+
+TEST(FreePageRuns, TiesGoToTheLowestRun)
+{
+	FreePageRuns runs;
+	runs.Reset(first_page, first_page + 30);
+	runs.Allocate(first_page + 5, 5);
+	runs.Allocate(first_page + 15, 5);
+	runs.Allocate(first_page + 25, 5);
+
+	EXPECT_EQ(runs.FindBestFit(1), first_page);
+	EXPECT_EQ(runs.FindBestFit(5), first_page);
+	EXPECT_EQ(runs.FindBestFit(6), 0);
+}
+
+TEST(FreePageRuns, MatchesLinearScan)
+{
+	constexpr size_t num_pages = 4096;
+
+	LinearPages linear(num_pages);
+	FreePageRuns runs;
+	runs.Reset(first_page, num_pages);
+	expect_same(linear, runs);
+
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<size_t> size_dist(1, 64);
+	std::uniform_int_distribution<size_t> page_dist(first_page, num_pages - 1);
+
+	for (int step = 0; step < 2000; ++step) {
+		if (rng() % 2) {
+			// Allocate as the memory module does: the best fitting
+			// run for a sequence, or as much of the best single page
+			// run as needed otherwise
+			const auto size  = size_dist(rng);
+			const bool whole = rng() % 2;
+			const auto page  = linear.BestMatch(whole ? size : 1);
+			ASSERT_EQ(runs.FindBestFit(whole ? size : 1), page);
+			if (!page) {
+				continue;
+			}
+			const auto length = whole ? size
+			                          : std::min(size, linear.RunLength(page));
+			ASSERT_EQ(runs.GetRunLength(page), linear.RunLength(page));
+			ASSERT_TRUE(runs.IsFree(page, length));
+			runs.Allocate(page, length);
+			linear.Set(page, length, true);
+		} else {
+			// Release a random stretch of used pages
+			auto page = page_dist(rng);
+			while (page < num_pages && !linear.IsUsed(page)) {
+				++page;
+			}
+			size_t length = 0;
+			const auto max_length = size_dist(rng);
+			while (page + length < num_pages && length < max_length &&
+			       linear.IsUsed(page + length)) {
+				++length;
+			}
+			if (!length) {
+				continue;
+			}
+			runs.Release(page, length);
+			linear.Set(page, length, false);
+		}
+		expect_same(linear, runs);
+		if (HasFailure()) {
+			FAIL() << "Diverged at step " << step;
+		}
+	}
+}
+
+} // namespace
@@ -0,0 +1,92 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "host_memory.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr size_t one_mb     = 1024 * 1024;
+constexpr size_t block_size = 64 * one_mb;
+
+TEST(HostMemory, IsZeroed)
+{
+	HostMemory ram(block_size, HugePages::Off);
+	ASSERT_NE(ram.Data(), nullptr);
+	EXPECT_EQ(ram.Size(), block_size);
+	EXPECT_EQ(ram.GetHugePages(), HugePages::Off);
+
+	const auto begin = ram.Data();
+	const auto end   = ram.Data() + ram.Size();
+	EXPECT_TRUE(std::all_of(begin, end, [](const uint8_t b) { return b == 0; }));
+}
+
+TEST(HostMemory, CommitsOnlyTouchedPages)
+{
+	HostMemory ram(block_size, HugePages::Off);
+
+	const auto before = ram.GetResidentBytes();
+	if (!before) {
+		GTEST_SKIP() << "The host can't report resident memory";
+	}
+	EXPECT_LT(*before, block_size / 2);
+
+	// Touch the first 8 MB
+	std::fill_n(ram.Data(), 8 * one_mb, uint8_t(0xaa));
+
+	const auto after = ram.GetResidentBytes();
+	ASSERT_TRUE(after);
+	EXPECT_GE(*after, 8 * one_mb);
+	EXPECT_LT(*after, block_size / 2);
+}
+
+TEST(HostMemory, HugePagesFallBack)
+{
+	for (const auto mode : {HugePages::Transparent, HugePages::Explicit}) {
+		HostMemory ram(block_size, mode);
+		ASSERT_NE(ram.Data(), nullptr);
+		EXPECT_LE(static_cast<int>(ram.GetHugePages()),
+		          static_cast<int>(mode));
+
+		ram.Data()[0]              = 1;
+		ram.Data()[block_size - 1] = 2;
+		EXPECT_EQ(ram.Data()[0], 1);
+		EXPECT_EQ(ram.Data()[block_size - 1], 2);
+	}
+}
+
+TEST(HostMemory, MoveTransfersOwnership)
+{
+	HostMemory a(one_mb, HugePages::Off);
+	const auto data = a.Data();
+	data[123]       = 45;
+
+	HostMemory b = std::move(a);
+	EXPECT_EQ(a.Data(), nullptr);
+	EXPECT_EQ(b.Data(), data);
+	EXPECT_EQ(b.Size(), one_mb);
+	EXPECT_EQ(b.Data()[123], 45);
+}
+
+} // namespace
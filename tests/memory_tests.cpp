@@ -0,0 +1,213 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "mem.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "paging.h"
+
+#include "dosbox_test_fixture.h"
+
+namespace {
+
+// 2 MB up is free RAM in the test machine
+constexpr PhysPt ram_addr = 0x200000;
+
+// The BIOS ROM, where writes are dropped
+constexpr PhysPt rom_addr = 0xf0000;
+
+class MemoryTest : public DOSBoxTestFixture {};
+
+std::vector<uint8_t> make_pattern(const size_t size)
+{
+	std::vector<uint8_t> pattern(size);
+	for (size_t i = 0; i < size; ++i) {
+		pattern[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+	}
+	return pattern;
+}
+
+TEST_F(MemoryTest, BlockWriteAndReadCrossPages)
+{
+	// Start and end mid-page to cover partial first and last pages
+	constexpr PhysPt addr = ram_addr + 0x123;
+	const auto pattern    = make_pattern(3 * dos_pagesize + 0x456);
+
+	MEM_BlockWrite(addr, pattern.data(), pattern.size());
+	for (size_t i = 0; i < pattern.size(); ++i) {
+		ASSERT_EQ(mem_readb(addr + static_cast<PhysPt>(i)), pattern[i]);
+	}
+
+	std::vector<uint8_t> read_back(pattern.size());
+	MEM_BlockRead(addr, read_back.data(), read_back.size());
+	EXPECT_EQ(read_back, pattern);
+
+	// The bytes either side are untouched
+	EXPECT_EQ(mem_readb(addr - 1), 0);
+	EXPECT_EQ(mem_readb(addr + static_cast<PhysPt>(pattern.size())), 0);
+}
+
+TEST_F(MemoryTest, BlockCopyCrossPages)
+{
+	const auto pattern = make_pattern(2 * dos_pagesize + 100);
+	MEM_BlockWrite(ram_addr + 10, pattern.data(), pattern.size());
+
+	// Misaligned source and destination page offsets
+	constexpr PhysPt dest = ram_addr + 0x10000 + 0x777;
+	MEM_BlockCopy(dest, ram_addr + 10, pattern.size());
+
+	std::vector<uint8_t> copied(pattern.size());
+	MEM_BlockRead(dest, copied.data(), copied.size());
+	EXPECT_EQ(copied, pattern);
+}
+
+TEST_F(MemoryTest, OverlappingCopyRepeatsLikeTheGuest)
+{
+	// Copying a block one byte up onto itself smears the first byte
+	// over it, as a forward byte copy in the guest does
+	mem_writeb(ram_addr, 0xab);
+	mem_writeb(ram_addr + 1, 0xcd);
+	mem_memcpy(ram_addr + 1, ram_addr, 100);
+	for (PhysPt i = 0; i <= 100; ++i) {
+		ASSERT_EQ(mem_readb(ram_addr + i), 0xab);
+	}
+
+	// Copying down is an ordinary move
+	const auto pattern = make_pattern(64);
+	MEM_BlockWrite(ram_addr + 0x1000, pattern.data(), pattern.size());
+	mem_memcpy(ram_addr + 0x1000 - 8, ram_addr + 0x1000, pattern.size());
+	std::vector<uint8_t> moved(pattern.size());
+	MEM_BlockRead(ram_addr + 0x1000 - 8, moved.data(), moved.size());
+	EXPECT_EQ(moved, pattern);
+}
+
+TEST_F(MemoryTest, BlockWriteToRomGoesThroughHandler)
+{
+	std::vector<uint8_t> before(dos_pagesize);
+	MEM_BlockRead(rom_addr, before.data(), before.size());
+
+	const std::vector<uint8_t> junk(dos_pagesize, 0x5a);
+	MEM_BlockWrite(rom_addr, junk.data(), junk.size());
+
+	std::vector<uint8_t> after(dos_pagesize);
+	MEM_BlockRead(rom_addr, after.data(), after.size());
+	EXPECT_EQ(after, before);
+}
+
+// XMS hands out the next free page, without allocating it, as the handle of
+// a zero-size block, which Windows 3.1 requests often
+TEST_F(MemoryTest, ZeroSizeAllocationFrees)
+{
+	const auto free_total   = MEM_FreeTotal();
+	const auto free_largest = MEM_FreeLargest();
+
+	const auto handle = MEM_GetNextFreePage();
+	ASSERT_GT(handle, 0);
+	EXPECT_EQ(MEM_FreeTotal(), free_total);
+
+	MEM_ReleasePages(handle);
+	EXPECT_EQ(MEM_FreeTotal(), free_total);
+	EXPECT_EQ(MEM_FreeLargest(), free_largest);
+
+	// The page is still free to allocate
+	const auto pages = MEM_AllocatePages(1, true);
+	EXPECT_EQ(pages, handle);
+	MEM_ReleasePages(pages);
+	EXPECT_EQ(MEM_FreeTotal(), free_total);
+}
+
+TEST_F(MemoryTest, ZeroSizeAllocationResizes)
+{
+	const auto free_total = MEM_FreeTotal();
+
+	const auto first_page = MEM_GetNextFreePage();
+	ASSERT_GT(first_page, 0);
+
+	// Growing takes the pages from the handle on, as nothing else was
+	// allocated since
+	auto handle = first_page;
+	ASSERT_TRUE(MEM_ReAllocatePages(handle, 4, true));
+	EXPECT_EQ(handle, first_page);
+	EXPECT_EQ(MEM_AllocatedPages(handle), 4);
+	EXPECT_EQ(MEM_FreeTotal(), free_total - 4);
+
+	ASSERT_TRUE(MEM_ReAllocatePages(handle, 2, true));
+	EXPECT_EQ(MEM_FreeTotal(), free_total - 2);
+
+	MEM_ReleasePages(handle);
+	EXPECT_EQ(MEM_FreeTotal(), free_total);
+
+	// Growing without a sequence allocates wherever pages are free
+	handle = MEM_GetNextFreePage();
+	ASSERT_TRUE(MEM_ReAllocatePages(handle, 3, false));
+	EXPECT_EQ(MEM_AllocatedPages(handle), 3);
+	EXPECT_EQ(MEM_FreeTotal(), free_total - 3);
+
+	// Shrinking to zero pages frees them and leaves an invalid handle
+	ASSERT_TRUE(MEM_ReAllocatePages(handle, 0, false));
+	EXPECT_EQ(handle, -1);
+	EXPECT_EQ(MEM_FreeTotal(), free_total);
+}
+
+TEST_F(MemoryTest, BenchmarkBlockRead)
+{
+	// A large DOS file read into guest memory
+	constexpr size_t size       = 8 * 1024 * 1024;
+	constexpr int num_passes    = 8;
+	const std::vector<uint8_t> data = make_pattern(size);
+	std::vector<uint8_t> read_back(size);
+
+	auto run = [&](const auto& transfer) {
+		const auto start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < num_passes; ++pass) {
+			transfer();
+		}
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		return std::chrono::duration<double>(elapsed).count();
+	};
+
+	// The byte-wise transfers the block functions used to make
+	const auto bytewise = run([&] {
+		for (size_t i = 0; i < size; ++i) {
+			mem_writeb(ram_addr + static_cast<PhysPt>(i), data[i]);
+		}
+		for (size_t i = 0; i < size; ++i) {
+			read_back[i] = mem_readb(ram_addr + static_cast<PhysPt>(i));
+		}
+	});
+	const auto paged = run([&] {
+		MEM_BlockWrite(ram_addr, data.data(), size);
+		MEM_BlockRead(ram_addr, read_back.data(), size);
+	});
+
+	constexpr auto megabytes = 2.0 * size * num_passes / (1024 * 1024);
+	printf("[ BENCHMARK] Block transfers bytewise %.0f MB/s, paged %.0f MB/s\n",
+	       megabytes / bytewise,
+	       megabytes / paged);
+
+	EXPECT_EQ(read_back, data);
+}
+
+} // namespace
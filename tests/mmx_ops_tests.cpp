@@ -0,0 +1,420 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "mmx_ops.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// Scalar reference implementations, evaluated lane by lane
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+template <typename T>
+T get_lane(const uint64_t value, const int lane)
+{
+	constexpr int bits = sizeof(T) * 8;
+	using U = std::make_unsigned_t<T>;
+	return static_cast<T>(static_cast<U>(value >> (lane * bits)));
+}
+
+template <typename T>
+uint64_t set_lane(const uint64_t value, const int lane, const T lane_value)
+{
+	constexpr int bits = sizeof(T) * 8;
+	using U            = std::make_unsigned_t<T>;
+	const uint64_t mask = static_cast<uint64_t>(static_cast<U>(~U(0)))
+	                   << (lane * bits);
+	const auto bits_in = static_cast<uint64_t>(static_cast<U>(lane_value))
+	                  << (lane * bits);
+	return (value & ~mask) | bits_in;
+}
+
+template <typename T, typename Op>
+uint64_t for_each_lane(const uint64_t dest, const uint64_t src, Op op)
+{
+	constexpr int lanes = 8 / sizeof(T);
+	uint64_t result     = 0;
+	for (int lane = 0; lane < lanes; ++lane) {
+		const auto d = get_lane<T>(dest, lane);
+		const auto s = get_lane<T>(src, lane);
+		result = set_lane<T>(result, lane, static_cast<T>(op(d, s)));
+	}
+	return result;
+}
+
+template <typename T>
+T saturate(const int64_t value)
+{
+	return static_cast<T>(std::clamp<int64_t>(value,
+	                                          std::numeric_limits<T>::min(),
+	                                          std::numeric_limits<T>::max()));
+}
+
+template <typename T>
+uint64_t shift_left(const uint64_t dest, const uint64_t count)
+{
+	return for_each_lane<T>(dest, 0, [count](const T d, T) {
+		return count >= sizeof(T) * 8 ? T(0) : static_cast<T>(d << count);
+	});
+}
+
+template <typename T>
+uint64_t shift_right_logical(const uint64_t dest, const uint64_t count)
+{
+	return for_each_lane<T>(dest, 0, [count](const T d, T) {
+		return count >= sizeof(T) * 8 ? T(0) : static_cast<T>(d >> count);
+	});
+}
+
+template <typename T>
+uint64_t shift_right_arithmetic(const uint64_t dest, const uint64_t count)
+{
+	const auto shift = std::min<uint64_t>(count, sizeof(T) * 8 - 1);
+	return for_each_lane<T>(dest, 0, [shift](const T d, T) {
+		return static_cast<T>(d >> shift);
+	});
+}
+
+uint64_t ref_psllq(const uint64_t dest, const uint64_t count)
+{
+	return count > 63 ? 0 : dest << count;
+}
+
+uint64_t ref_psrlq(const uint64_t dest, const uint64_t count)
+{
+	return count > 63 ? 0 : dest >> count;
+}
+
+uint64_t ref_pmaddwd(const uint64_t dest, const uint64_t src)
+{
+	uint64_t result = 0;
+	for (int lane = 0; lane < 2; ++lane) {
+		const auto lo = int32_t(get_lane<int16_t>(dest, lane * 2)) *
+		                get_lane<int16_t>(src, lane * 2);
+		const auto hi = int32_t(get_lane<int16_t>(dest, lane * 2 + 1)) *
+		                get_lane<int16_t>(src, lane * 2 + 1);
+		// 0x8000 * 0x8000 twice wraps to 0x80000000, as on the hardware
+		const auto sum = static_cast<uint32_t>(lo) + static_cast<uint32_t>(hi);
+		result = set_lane<uint32_t>(result, lane, sum);
+	}
+	return result;
+}
+
+template <typename From, typename To>
+uint64_t pack(const uint64_t dest, const uint64_t src)
+{
+	constexpr int lanes = 8 / sizeof(From);
+	uint64_t result     = 0;
+	for (int lane = 0; lane < lanes; ++lane) {
+		result = set_lane<To>(result, lane,
+		                      saturate<To>(get_lane<From>(dest, lane)));
+		result = set_lane<To>(result, lane + lanes,
+		                      saturate<To>(get_lane<From>(src, lane)));
+	}
+	return result;
+}
+
+template <typename T>
+uint64_t unpack(const uint64_t dest, const uint64_t src, const bool high)
+{
+	constexpr int lanes = 8 / sizeof(T);
+	const int first     = high ? lanes / 2 : 0;
+	uint64_t result     = 0;
+	for (int i = 0; i < lanes / 2; ++i) {
+		result = set_lane<T>(result, i * 2, get_lane<T>(dest, first + i));
+		result = set_lane<T>(result, i * 2 + 1, get_lane<T>(src, first + i));
+	}
+	return result;
+}
+
+using BinaryOp = uint64_t (*)(uint64_t, uint64_t);
+
+struct OpPair {
+	const char* name;
+	BinaryOp simd;
+	BinaryOp scalar;
+	int lane_bytes;
+};
+
+#define LANE_OP(T, EXPR) \
+	[](const uint64_t dest, const uint64_t src) { \
+		return for_each_lane<T>(dest, src, [](const T d, const T s) { \
+			return EXPR; \
+		}); \
+	}
+
+const std::vector<OpPair> arithmetic_ops = {
+        {"PADDB", MMX_PADDB, LANE_OP(uint8_t, d + s), 1},
+        {"PADDW", MMX_PADDW, LANE_OP(uint16_t, d + s), 2},
+        {"PADDD", MMX_PADDD, LANE_OP(uint32_t, d + s), 4},
+        {"PADDSB", MMX_PADDSB, LANE_OP(int8_t, saturate<int8_t>(d + s)), 1},
+        {"PADDSW", MMX_PADDSW, LANE_OP(int16_t, saturate<int16_t>(d + s)), 2},
+        {"PADDUSB", MMX_PADDUSB, LANE_OP(uint8_t, saturate<uint8_t>(d + s)), 1},
+        {"PADDUSW", MMX_PADDUSW, LANE_OP(uint16_t, saturate<uint16_t>(d + s)), 2},
+        {"PSUBB", MMX_PSUBB, LANE_OP(uint8_t, d - s), 1},
+        {"PSUBW", MMX_PSUBW, LANE_OP(uint16_t, d - s), 2},
+        {"PSUBD", MMX_PSUBD, LANE_OP(uint32_t, d - s), 4},
+        {"PSUBSB", MMX_PSUBSB, LANE_OP(int8_t, saturate<int8_t>(d - s)), 1},
+        {"PSUBSW", MMX_PSUBSW, LANE_OP(int16_t, saturate<int16_t>(d - s)), 2},
+        {"PSUBUSB", MMX_PSUBUSB, LANE_OP(uint8_t, saturate<uint8_t>(d - s)), 1},
+        {"PSUBUSW", MMX_PSUBUSW, LANE_OP(uint16_t, saturate<uint16_t>(d - s)), 2},
+        {"PMULHW", MMX_PMULHW, LANE_OP(int16_t, (int32_t(d) * s) >> 16), 2},
+        {"PMULLW", MMX_PMULLW, LANE_OP(int16_t, int32_t(d) * s), 2},
+        {"PMADDWD", MMX_PMADDWD, ref_pmaddwd, 2},
+        {"PCMPEQB", MMX_PCMPEQB, LANE_OP(uint8_t, d == s ? 0xff : 0), 1},
+        {"PCMPEQW", MMX_PCMPEQW, LANE_OP(uint16_t, d == s ? 0xffff : 0), 2},
+        {"PCMPEQD", MMX_PCMPEQD, LANE_OP(uint32_t, d == s ? ~0u : 0u), 4},
+        {"PCMPGTB", MMX_PCMPGTB, LANE_OP(int8_t, d > s ? -1 : 0), 1},
+        {"PCMPGTW", MMX_PCMPGTW, LANE_OP(int16_t, d > s ? -1 : 0), 2},
+        {"PCMPGTD", MMX_PCMPGTD, LANE_OP(int32_t, d > s ? -1 : 0), 4},
+        {"PACKSSWB", MMX_PACKSSWB, pack<int16_t, int8_t>, 2},
+        {"PACKSSDW", MMX_PACKSSDW, pack<int32_t, int16_t>, 4},
+        {"PACKUSWB", MMX_PACKUSWB, pack<int16_t, uint8_t>, 2},
+        {"PUNPCKHBW",
+         MMX_PUNPCKHBW,
+         [](uint64_t d, uint64_t s) { return unpack<uint8_t>(d, s, true); },
+         1},
+        {"PUNPCKHWD",
+         MMX_PUNPCKHWD,
+         [](uint64_t d, uint64_t s) { return unpack<uint16_t>(d, s, true); },
+         2},
+        {"PUNPCKHDQ",
+         MMX_PUNPCKHDQ,
+         [](uint64_t d, uint64_t s) { return unpack<uint32_t>(d, s, true); },
+         4},
+        {"PUNPCKLBW",
+         MMX_PUNPCKLBW,
+         [](uint64_t d, uint64_t s) { return unpack<uint8_t>(d, s, false); },
+         1},
+        {"PUNPCKLWD",
+         MMX_PUNPCKLWD,
+         [](uint64_t d, uint64_t s) { return unpack<uint16_t>(d, s, false); },
+         2},
+        {"PUNPCKLDQ",
+         MMX_PUNPCKLDQ,
+         [](uint64_t d, uint64_t s) { return unpack<uint32_t>(d, s, false); },
+         4},
+};
+
+#undef LANE_OP
+
+const std::vector<OpPair> shift_ops = {
+        {"PSLLW", MMX_PSLLW, shift_left<uint16_t>, 2},
+        {"PSRLW", MMX_PSRLW, shift_right_logical<uint16_t>, 2},
+        {"PSRAW", MMX_PSRAW, shift_right_arithmetic<int16_t>, 2},
+        {"PSLLD", MMX_PSLLD, shift_left<uint32_t>, 4},
+        {"PSRLD", MMX_PSRLD, shift_right_logical<uint32_t>, 4},
+        {"PSRAD", MMX_PSRAD, shift_right_arithmetic<int32_t>, 4},
+        {"PSLLQ", MMX_PSLLQ, ref_psllq, 8},
+        {"PSRLQ", MMX_PSRLQ, ref_psrlq, 8},
+};
+
+// Spreads a lane value across all lanes, varying it per lane so that
+// carries, saturation, and lane crossings show up in every position
+uint64_t spread(const uint64_t value, const int lane_bytes)
+{
+	const int bits  = lane_bytes * 8;
+	const int lanes = 8 / lane_bytes;
+	if (lanes == 1) {
+		return value;
+	}
+	const uint64_t mask = (uint64_t(1) << bits) - 1;
+	uint64_t result     = 0;
+	for (int lane = 0; lane < lanes; ++lane) {
+		const auto lane_value = (value + lane * 0x9e3779b97f4a7c15ull) & mask;
+		result |= (lane == 0 ? value & mask : lane_value) << (lane * bits);
+	}
+	return result;
+}
+
+// Lane values near every boundary the operations care about
+std::vector<uint64_t> edge_values(const int lane_bytes)
+{
+	const int bits = lane_bytes * 8;
+	const auto max = bits == 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+	const auto sign = uint64_t(1) << (bits - 1);
+
+	std::vector<uint64_t> values = {};
+	for (const auto base : {uint64_t(0), sign, max, sign - 1, max / 3}) {
+		for (int delta = -2; delta <= 2; ++delta) {
+			values.push_back((base + delta) & max);
+		}
+	}
+	// The byte boundaries within wider lanes
+	for (int b = 8; b < bits; b += 8) {
+		values.push_back((uint64_t(1) << b) - 1);
+		values.push_back(uint64_t(1) << b);
+	}
+	return values;
+}
+
+} // namespace
+
+TEST(MmxOps, ByteLanesExhaustive)
+{
+	for (const auto& op : arithmetic_ops) {
+		if (op.lane_bytes != 1) {
+			continue;
+		}
+		for (uint32_t d = 0; d < 256; ++d) {
+			for (uint32_t s = 0; s < 256; ++s) {
+				const auto dest = spread(d, 1);
+				const auto src  = spread(s, 1);
+				ASSERT_EQ(op.simd(dest, src), op.scalar(dest, src))
+				        << op.name << " " << std::hex << dest
+				        << ", " << src;
+			}
+		}
+	}
+}
+
+TEST(MmxOps, WordLanesSweep)
+{
+	// Every word pair is 2^32 cases per operation, so this walks every
+	// destination against a strided set of sources instead
+	for (const auto& op : arithmetic_ops) {
+		if (op.lane_bytes != 2) {
+			continue;
+		}
+		for (uint32_t d = 0; d < 0x10000; ++d) {
+			for (uint32_t s = d & 0xff; s < 0x10000; s += 0x400 - 3) {
+				const auto dest = spread(d, 2);
+				const auto src  = spread(s, 2);
+				ASSERT_EQ(op.simd(dest, src), op.scalar(dest, src))
+				        << op.name << " " << std::hex << dest
+				        << ", " << src;
+			}
+		}
+	}
+}
+
+TEST(MmxOps, EdgeValues)
+{
+	for (const auto& op : arithmetic_ops) {
+		const auto values = edge_values(op.lane_bytes);
+		for (const auto d : values) {
+			for (const auto s : values) {
+				const auto dest = spread(d, op.lane_bytes);
+				const auto src  = spread(s, op.lane_bytes);
+				ASSERT_EQ(op.simd(dest, src), op.scalar(dest, src))
+				        << op.name << " " << std::hex << dest
+				        << ", " << src;
+			}
+		}
+	}
+}
+
+TEST(MmxOps, RandomOperands)
+{
+	std::mt19937_64 rng(0x4d4d58);
+	for (int i = 0; i < 1'000'000; ++i) {
+		const auto dest = rng();
+		const auto src  = rng();
+		for (const auto& op : arithmetic_ops) {
+			ASSERT_EQ(op.simd(dest, src), op.scalar(dest, src))
+			        << op.name << " " << std::hex << dest << ", " << src;
+		}
+	}
+}
+
+TEST(MmxOps, ShiftCounts)
+{
+	// Every immediate count
+	std::vector<uint64_t> counts = {};
+	for (uint64_t count = 0; count <= 0xff; ++count) {
+		counts.push_back(count);
+	}
+	// Counts from a register are out of range unless all 64 bits fit
+	for (const auto count : {uint64_t(0x100),
+	                         uint64_t(0x10000),
+	                         uint64_t(1) << 32,
+	                         (uint64_t(1) << 32) | 1,
+	                         uint64_t(1) << 63,
+	                         ~uint64_t(0)}) {
+		counts.push_back(count);
+	}
+
+	std::mt19937_64 rng(0x5348);
+	for (int i = 0; i < 1000; ++i) {
+		const auto dest = i < 4 ? spread(0x8000'0000'8000'8001ull >> i, 8)
+		                        : rng();
+		for (const auto count : counts) {
+			for (const auto& op : shift_ops) {
+				ASSERT_EQ(op.simd(dest, count), op.scalar(dest, count))
+				        << op.name << " " << std::hex << dest
+				        << " by " << count;
+			}
+		}
+	}
+}
+
+// Not a test as such, but a throughput measurement of the vector
+// implementations against the scalar lane-by-lane ones, for a stream of
+// operands as a pixel blending loop would produce
+TEST(MmxOps, BenchmarkThroughput)
+{
+	constexpr int num_operands = 1 << 16;
+	constexpr int num_passes   = 32;
+
+	std::mt19937_64 rng(0x4250);
+	std::vector<uint64_t> operands(num_operands);
+	for (auto& operand : operands) {
+		operand = rng();
+	}
+
+	auto run = [&](const auto& get_op) {
+		const auto start = std::chrono::steady_clock::now();
+		uint64_t acc     = 0;
+		for (int pass = 0; pass < num_passes; ++pass) {
+			for (const auto& op : arithmetic_ops) {
+				const auto fn = get_op(op);
+				for (const auto operand : operands) {
+					acc = fn(acc, operand);
+				}
+			}
+		}
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		                        elapsed)
+		                        .count();
+		return std::make_pair(acc, ns);
+	};
+
+	const auto scalar = run([](const OpPair& op) { return op.scalar; });
+	const auto simd   = run([](const OpPair& op) { return op.simd; });
+
+	const auto num_ops = static_cast<double>(num_operands) * num_passes *
+	                     arithmetic_ops.size();
+	printf("[ BENCHMARK] MMX ops scalar %.2f ns/op, vector %.2f ns/op\n",
+	       static_cast<double>(scalar.second) / num_ops,
+	       static_cast<double>(simd.second) / num_ops);
+
+	EXPECT_EQ(scalar.first, simd.first);
+}
@@ -0,0 +1,167 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "paging.h"
+
+#include <gtest/gtest.h>
+
+#include "cpu.h"
+#include "mem.h"
+
+#include "dosbox_test_fixture.h"
+
+namespace {
+
+// Two page directories that each map the 4 MB at linear 0x400000 through
+// their own page table. All structures live at 3 MB and up.
+constexpr PhysPt dir_a   = 0x300000;
+constexpr PhysPt table_a = 0x301000;
+constexpr PhysPt dir_b   = 0x302000;
+constexpr PhysPt table_b = 0x303000;
+
+constexpr uint32_t data_page_a = 0x310; // physical page numbers
+constexpr uint32_t data_page_b = 0x311;
+constexpr uint32_t data_page_c = 0x312;
+
+constexpr PhysPt lin_addr = 0x400000;
+
+// Present, writable, user, accessed, and dirty
+constexpr uint32_t page_flags = 0x67;
+
+void set_pte(const PhysPt table, const PhysPt lin, const uint32_t phys_page,
+             const uint32_t flags = page_flags)
+{
+	phys_writed(table + ((lin >> 12) & 0x3ff) * 4, (phys_page << 12) | flags);
+}
+
+class PagingTest : public DOSBoxTestFixture {
+protected:
+	void SetUp() override
+	{
+		DOSBoxTestFixture::SetUp();
+
+		for (PhysPt addr = dir_a; addr < table_b + 4096; addr += 4) {
+			phys_writed(addr, 0);
+		}
+		phys_writed(dir_a + (lin_addr >> 22) * 4, table_a | page_flags);
+		phys_writed(dir_b + (lin_addr >> 22) * 4, table_b | page_flags);
+		set_pte(table_a, lin_addr, data_page_a);
+		set_pte(table_b, lin_addr, data_page_b);
+
+		phys_writeb(data_page_a << 12, 0xaa);
+		phys_writeb(data_page_b << 12, 0xbb);
+		phys_writeb(data_page_c << 12, 0xcc);
+
+		cpu.cpl = 0;
+		PAGING_SetDirBase(dir_a);
+		PAGING_Enable(true);
+	}
+
+	void TearDown() override
+	{
+		PAGING_Enable(false);
+		DOSBoxTestFixture::TearDown();
+	}
+};
+
+TEST_F(PagingTest, RelinksPagesWhenDirectoryReturns)
+{
+	EXPECT_EQ(get_tlb_read(lin_addr), nullptr);
+	EXPECT_EQ(mem_readb(lin_addr), 0xaa);
+	EXPECT_NE(get_tlb_read(lin_addr), nullptr);
+
+	PAGING_SetDirBase(dir_b);
+	EXPECT_EQ(get_tlb_read(lin_addr), nullptr);
+	EXPECT_EQ(mem_readb(lin_addr), 0xbb);
+
+	// Linked again without an access through the init handler
+	PAGING_SetDirBase(dir_a);
+	EXPECT_NE(get_tlb_read(lin_addr), nullptr);
+	EXPECT_EQ(PAGING_GetPhysicalAddress(lin_addr), data_page_a << 12);
+	EXPECT_EQ(mem_readb(lin_addr), 0xaa);
+
+	PAGING_SetDirBase(dir_b);
+	EXPECT_EQ(PAGING_GetPhysicalAddress(lin_addr), data_page_b << 12);
+	EXPECT_EQ(mem_readb(lin_addr), 0xbb);
+}
+
+TEST_F(PagingTest, FollowsEntriesChangedWhileUnloaded)
+{
+	EXPECT_EQ(mem_readb(lin_addr), 0xaa);
+
+	PAGING_SetDirBase(dir_b);
+	set_pte(table_a, lin_addr, data_page_c);
+	PAGING_SetDirBase(dir_a);
+
+	EXPECT_EQ(mem_readb(lin_addr), 0xcc);
+}
+
+TEST_F(PagingTest, ReloadingTheSameDirectoryFlushes)
+{
+	EXPECT_EQ(mem_readb(lin_addr), 0xaa);
+
+	// The 386 way of flushing after changing an entry in use
+	set_pte(table_a, lin_addr, data_page_c);
+	PAGING_SetDirBase(dir_a);
+
+	EXPECT_EQ(mem_readb(lin_addr), 0xcc);
+}
+
+TEST_F(PagingTest, LeavesDirtyTrackingToTheInitHandler)
+{
+	EXPECT_EQ(mem_readb(lin_addr), 0xaa);
+
+	// The OS clears the dirty bit to find out about later writes
+	constexpr uint32_t not_dirty = page_flags & ~0x40u;
+	set_pte(table_a, lin_addr, data_page_a, not_dirty);
+	PAGING_SetDirBase(dir_b);
+	PAGING_SetDirBase(dir_a);
+	EXPECT_EQ(get_tlb_read(lin_addr), nullptr);
+
+	mem_writeb(lin_addr, 0x11);
+	EXPECT_EQ(phys_readd(table_a + ((lin_addr >> 12) & 0x3ff) * 4) & 0x40, 0x40u);
+	EXPECT_EQ(phys_readb(data_page_a << 12), 0x11);
+}
+
+// Accesses through a relinked page can't be seen, so a page restored on
+// eight loads in a row without a miss is dropped until it faults in again
+TEST_F(PagingTest, DropsPagesRestoredWithoutAMiss)
+{
+	EXPECT_EQ(mem_readb(lin_addr), 0xaa);
+
+	for (int i = 0; i < 8; ++i) {
+		PAGING_SetDirBase(dir_b);
+		PAGING_SetDirBase(dir_a);
+		EXPECT_NE(get_tlb_read(lin_addr), nullptr) << "load " << i;
+		EXPECT_EQ(mem_readb(lin_addr), 0xaa);
+	}
+
+	PAGING_SetDirBase(dir_b);
+	PAGING_SetDirBase(dir_a);
+	EXPECT_EQ(get_tlb_read(lin_addr), nullptr);
+
+	// The miss makes it count as used again
+	EXPECT_EQ(mem_readb(lin_addr), 0xaa);
+	PAGING_SetDirBase(dir_b);
+	PAGING_SetDirBase(dir_a);
+	EXPECT_NE(get_tlb_read(lin_addr), nullptr);
+}
+
+} // namespace
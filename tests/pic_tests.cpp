@@ -0,0 +1,343 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "pic.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+void TIMER_AddTick();
+
+namespace {
+
+// Each fired event is recorded as (handler number, value)
+using fired_t = std::pair<int, uint32_t>;
+std::vector<fired_t> fired = {};
+
+template <int N>
+void record_event(const uint32_t val)
+{
+	fired.emplace_back(N, val);
+}
+
+constexpr std::array<PIC_EventHandler, 4> handlers = {record_event<0>,
+                                                      record_event<1>,
+                                                      record_event<2>,
+                                                      record_event<3>};
+
+template <size_t N>
+void nop_event(uint32_t) {}
+
+template <size_t... Ns>
+constexpr std::array<PIC_EventHandler, sizeof...(Ns)> make_devices(std::index_sequence<Ns...>)
+{
+	return {nop_event<Ns>...};
+}
+
+// Starts a fresh millisecond tick with nothing executed yet
+void reset_tick(const int32_t cycle_max = 1000)
+{
+	CPU_CycleMax  = cycle_max;
+	CPU_CycleLeft = cycle_max;
+	CPU_Cycles    = 0;
+}
+
+// Runs the rest of the current tick as if the CPU executed every cycle the
+// PIC handed out, then starts the next one
+void run_tick()
+{
+	while (PIC_RunQueue()) {
+		CPU_Cycles = 0;
+	}
+	TIMER_AddTick();
+}
+
+// Drains the queue so tests don't leak events into each other
+void drain_queue(const int max_ticks = 64)
+{
+	for (int i = 0; i < max_ticks; ++i) {
+		run_tick();
+	}
+	fired.clear();
+}
+
+// The sorted singly linked list the PIC used before the binary heap, kept
+// here as the reference for ordering and as the benchmark baseline.
+namespace legacy {
+
+constexpr int queue_size = 512;
+
+struct Entry {
+	double index;
+	uint32_t value;
+	PIC_EventHandler pic_event;
+	Entry *next;
+};
+
+struct Queue {
+	std::array<Entry, queue_size> entries = {};
+	Entry *free_entry                     = nullptr;
+	Entry *next_entry                     = nullptr;
+
+	Queue()
+	{
+		for (int i = 0; i < queue_size - 1; ++i) {
+			entries[i].next = &entries[i + 1];
+		}
+		entries[queue_size - 1].next = nullptr;
+		free_entry = &entries[0];
+	}
+
+	bool Add(const PIC_EventHandler handler, const double index, const uint32_t val)
+	{
+		if (!free_entry) {
+			return false;
+		}
+		Entry *entry     = free_entry;
+		free_entry       = free_entry->next;
+		entry->index     = index;
+		entry->pic_event = handler;
+		entry->value     = val;
+
+		Entry *find_entry = next_entry;
+		if (!find_entry || find_entry->index > entry->index) {
+			entry->next = find_entry;
+			next_entry  = entry;
+			return true;
+		}
+		while (find_entry->next && find_entry->next->index <= entry->index) {
+			find_entry = find_entry->next;
+		}
+		entry->next      = find_entry->next;
+		find_entry->next = entry;
+		return true;
+	}
+
+	void RemoveEvents(const PIC_EventHandler handler)
+	{
+		Entry **where = &next_entry;
+		while (*where) {
+			Entry *entry = *where;
+			if (entry->pic_event == handler) {
+				*where      = entry->next;
+				entry->next = free_entry;
+				free_entry  = entry;
+			} else {
+				where = &entry->next;
+			}
+		}
+	}
+
+	Entry PopNext()
+	{
+		Entry *entry = next_entry;
+		next_entry   = entry->next;
+		entry->next  = free_entry;
+		free_entry   = entry;
+		return *entry;
+	}
+};
+
+} // namespace legacy
+
+TEST(PicEventQueue, RunsInIndexOrder)
+{
+	reset_tick();
+	drain_queue();
+
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int> eighths(0, 31);
+	std::uniform_int_distribution<int> handler_dist(0, 3);
+
+	// Build the expected firing order with the legacy list, using coarse
+	// delays so plenty of events share the same index
+	legacy::Queue reference = {};
+	reset_tick();
+	for (uint32_t i = 0; i < 300; ++i) {
+		const auto delay   = eighths(rng) / 8.0;
+		const auto handler = handlers[handler_dist(rng)];
+		PIC_AddEvent(handler, delay, i);
+		ASSERT_TRUE(reference.Add(handler, delay, i));
+	}
+
+	std::vector<fired_t> expected = {};
+	while (reference.next_entry) {
+		const auto entry = reference.PopNext();
+		for (size_t h = 0; h < handlers.size(); ++h) {
+			if (handlers[h] == entry.pic_event) {
+				expected.emplace_back(static_cast<int>(h), entry.value);
+			}
+		}
+	}
+
+	for (int i = 0; i < 8; ++i) {
+		run_tick();
+	}
+	EXPECT_EQ(fired, expected);
+	fired.clear();
+}
+
+TEST(PicEventQueue, GrowsPastLegacyCapacity)
+{
+	reset_tick();
+	drain_queue();
+
+	constexpr uint32_t num_events = 4 * legacy::queue_size;
+	for (uint32_t i = 0; i < num_events; ++i) {
+		PIC_AddEvent(handlers[0], 0.5, i);
+	}
+	run_tick();
+
+	ASSERT_EQ(fired.size(), num_events);
+	for (uint32_t i = 0; i < num_events; ++i) {
+		EXPECT_EQ(fired[i].second, i);
+	}
+	fired.clear();
+}
+
+TEST(PicEventQueue, RemoveEvents)
+{
+	reset_tick();
+	drain_queue();
+
+	for (uint32_t i = 0; i < 16; ++i) {
+		PIC_AddEvent(handlers[i % 2], 0.1 * i, i);
+	}
+	PIC_RemoveEvents(handlers[1]);
+	run_tick();
+	run_tick();
+
+	ASSERT_EQ(fired.size(), 8u);
+	for (const auto &[handler, value] : fired) {
+		EXPECT_EQ(handler, 0);
+		EXPECT_EQ(value % 2, 0u);
+	}
+	fired.clear();
+}
+
+TEST(PicEventQueue, RemoveSpecificEvents)
+{
+	reset_tick();
+	drain_queue();
+
+	for (uint32_t i = 0; i < 12; ++i) {
+		PIC_AddEvent(handlers[2], 0.05 * i, i % 3);
+	}
+	PIC_RemoveSpecificEvents(handlers[2], 1);
+	run_tick();
+
+	ASSERT_EQ(fired.size(), 8u);
+	for (const auto &[handler, value] : fired) {
+		EXPECT_EQ(handler, 2);
+		EXPECT_NE(value, 1u);
+	}
+	fired.clear();
+}
+
+TEST(PicEventQueue, EventsCarryAcrossTicks)
+{
+	reset_tick();
+	drain_queue();
+
+	PIC_AddEvent(handlers[3], 2.5, 7);
+	run_tick();
+	run_tick();
+	EXPECT_TRUE(fired.empty());
+	run_tick();
+	ASSERT_EQ(fired.size(), 1u);
+	EXPECT_EQ(fired.front(), fired_t(3, 7));
+	fired.clear();
+}
+
+// Microbenchmark comparing the heap against the legacy sorted list. A set of
+// devices keep scheduling events while one of them periodically cancels all
+// of its pending events. Cancelling less often holds more events in the
+// queue, so the shallow run resembles a quiet setup and the deep run a busy
+// mix of sound, timer, and video devices.
+template <size_t NumDevices>
+void benchmark_queue(const int cancel_every)
+{
+	constexpr int iterations = 200'000;
+
+	const auto devices = make_devices(std::make_index_sequence<NumDevices>{});
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<double> delay_dist(0.0, 8.0);
+	std::vector<double> delays(iterations);
+	for (auto &delay : delays) {
+		delay = delay_dist(rng);
+	}
+
+	using clock = std::chrono::steady_clock;
+
+	legacy::Queue list = {};
+
+	const auto list_start = clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		list.Add(devices[i % NumDevices], delays[i], 0);
+		if (i % cancel_every == 0) {
+			list.RemoveEvents(devices[(i / cancel_every) % NumDevices]);
+		}
+	}
+	const auto list_time = clock::now() - list_start;
+
+	reset_tick();
+	drain_queue();
+
+	const auto heap_start = clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		PIC_AddEvent(devices[i % NumDevices], delays[i], 0);
+		if (i % cancel_every == 0) {
+			PIC_RemoveEvents(devices[(i / cancel_every) % NumDevices]);
+		}
+	}
+	const auto heap_time = clock::now() - heap_start;
+
+	for (const auto device : devices) {
+		PIC_RemoveEvents(device);
+	}
+
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+	printf("PIC event queue, %zu devices: legacy list %lld us, heap %lld us (%d events)\n",
+	       NumDevices,
+	       static_cast<long long>(duration_cast<microseconds>(list_time).count()),
+	       static_cast<long long>(duration_cast<microseconds>(heap_time).count()),
+	       iterations);
+}
+
+TEST(PicEventQueue, BenchmarkShallow)
+{
+	benchmark_queue<8>(8);
+}
+
+TEST(PicEventQueue, BenchmarkDeep)
+{
+	// The legacy list holds at most 512 entries, so stay a little below
+	benchmark_queue<24>(16);
+}
+
+} // namespace
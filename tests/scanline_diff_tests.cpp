@@ -0,0 +1,157 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "scanline_diff.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+ScanlineSpan reference_span(const std::vector<uint8_t>& line,
+                            const std::vector<uint8_t>& cache, const size_t num_bytes)
+{
+	size_t first = 0;
+	while (first < num_bytes && line[first] == cache[first]) {
+		++first;
+	}
+	size_t last = num_bytes;
+	while (last > first && line[last - 1] == cache[last - 1]) {
+		--last;
+	}
+	return {first, last};
+}
+
+std::vector<uint8_t> make_line(const size_t num_bytes)
+{
+	std::vector<uint8_t> line(num_bytes);
+	for (size_t i = 0; i < num_bytes; ++i) {
+		line[i] = static_cast<uint8_t>(i * 31 + 7);
+	}
+	return line;
+}
+
+TEST(ScanlineDiff, UnchangedLineIsEmpty)
+{
+	for (const size_t num_bytes : {0, 1, 15, 16, 17, 320, 2560, 4096}) {
+		const auto line  = make_line(num_bytes);
+		const auto cache = line;
+		const auto span  = find_changed_span(line.data(), cache.data(), num_bytes);
+		EXPECT_TRUE(span.IsEmpty());
+		EXPECT_EQ(find_first_change(line.data(), cache.data(), num_bytes),
+		          num_bytes);
+		EXPECT_EQ(find_last_change(line.data(), cache.data(), num_bytes), 0);
+	}
+}
+
+TEST(ScanlineDiff, FindsEveryChangePosition)
+{
+	// Lengths around the chunk size and odd line widths, with one and two
+	// changed bytes placed everywhere
+	for (const size_t num_bytes : {1, 2, 15, 16, 17, 31, 33, 63, 64, 65, 130}) {
+		const auto line = make_line(num_bytes);
+		for (size_t a = 0; a < num_bytes; ++a) {
+			for (size_t b = a; b < num_bytes; ++b) {
+				auto cache = line;
+				cache[a] ^= 0x80;
+				cache[b] ^= 0x01;
+
+				const auto expected = reference_span(line, cache, num_bytes);
+				const auto span = find_changed_span(line.data(),
+				                                    cache.data(),
+				                                    num_bytes);
+				ASSERT_EQ(span.first, expected.first)
+				        << num_bytes << " bytes, changes at " << a << ", " << b;
+				ASSERT_EQ(span.last, expected.last)
+				        << num_bytes << " bytes, changes at " << a << ", " << b;
+			}
+		}
+	}
+}
+
+TEST(ScanlineDiff, InvertedCopyDiffersEverywhere)
+{
+	for (const size_t num_bytes : {1, 15, 16, 17, 1280}) {
+		const auto line = make_line(num_bytes);
+		std::vector<uint8_t> cache(num_bytes);
+		copy_inverted(cache.data(), line.data(), num_bytes);
+		for (size_t i = 0; i < num_bytes; ++i) {
+			ASSERT_EQ(cache[i], static_cast<uint8_t>(~line[i]));
+		}
+		const auto span = find_changed_span(line.data(), cache.data(), num_bytes);
+		EXPECT_EQ(span.first, 0);
+		EXPECT_EQ(span.last, num_bytes);
+	}
+}
+
+TEST(ScanlineDiff, BenchmarkUnchangedFrame)
+{
+	// A 1024x768 frame of 32-bit pixels where nothing changed, the common
+	// case the renderer skips
+	constexpr size_t pitch      = 1024 * 4;
+	constexpr size_t height     = 768;
+	constexpr int num_frames    = 200;
+	const auto frame            = make_line(pitch * height);
+	const std::vector<uint8_t> cache = frame;
+
+	auto run = [&](const auto& find_change) {
+		size_t changed_lines = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < num_frames; ++i) {
+			for (size_t y = 0; y < height; ++y) {
+				const auto offset = y * pitch;
+				if (find_change(frame.data() + offset, cache.data() + offset) <
+				    pitch) {
+					++changed_lines;
+				}
+			}
+		}
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		EXPECT_EQ(changed_lines, 0);
+		return std::chrono::duration<double>(elapsed).count();
+	};
+
+	// The word at a time loop the renderer used before
+	const auto by_word = run([](const uint8_t* line, const uint8_t* cached) {
+		size_t i = 0;
+		while (i < pitch) {
+			uintptr_t a, b;
+			memcpy(&a, line + i, sizeof(a));
+			memcpy(&b, cached + i, sizeof(b));
+			if (a != b) {
+				break;
+			}
+			i += sizeof(uintptr_t);
+		}
+		return i;
+	});
+	const auto by_chunk = run([](const uint8_t* line, const uint8_t* cached) {
+		return find_first_change(line, cached, pitch);
+	});
+
+	printf("[ BENCHMARK] Unchanged 1024x768x32 frame: word loop %.1f us, chunked %.1f us\n",
+	       by_word * 1e6 / num_frames,
+	       by_chunk * 1e6 / num_frames);
+}
+
+} // namespace
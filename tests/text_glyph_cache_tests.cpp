@@ -0,0 +1,195 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "text_glyph_cache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+TextGlyphCache::Colours make_colours(const uint32_t seed)
+{
+	TextGlyphCache::Colours colours = {};
+	for (size_t i = 0; i < colours.size(); ++i) {
+		colours[i] = static_cast<uint32_t>((i + 1) * 0x010203 + seed);
+	}
+	return colours;
+}
+
+// Pixel by pixel, as the text line drawing did before
+void draw_cell(uint32_t* pixels, uint16_t pattern, const uint8_t width,
+               const uint32_t fg, const uint32_t bg)
+{
+	const uint16_t leftmost = static_cast<uint16_t>(1 << (width - 1));
+	for (uint8_t n = 0; n < width; ++n) {
+		pixels[n] = (pattern & leftmost) ? fg : bg;
+		pattern <<= 1;
+	}
+}
+
+TEST(TextGlyphCache, RowsMatchPixelByPixel)
+{
+	TextGlyphCache cache = {};
+	const auto colours   = make_colours(0);
+	cache.SetColours(colours);
+
+	for (const uint8_t width : {8, 9}) {
+		for (uint16_t pattern = 0; pattern < (1 << width); ++pattern) {
+			const uint8_t fg = pattern % 16;
+			const uint8_t bg = (pattern / 16) % 16;
+
+			uint32_t expected[TextGlyphCache::max_glyph_width] = {};
+			draw_cell(expected, pattern, width, colours[fg], colours[bg]);
+
+			// The second lookup is a hit
+			for (int i = 0; i < 2; ++i) {
+				const auto row = cache.GetRow(pattern, width, fg, bg);
+				ASSERT_EQ(memcmp(row, expected, width * sizeof(uint32_t)), 0)
+				        << "pattern " << pattern << ", width "
+				        << static_cast<int>(width);
+			}
+		}
+	}
+	EXPECT_GT(cache.hits, 0);
+}
+
+TEST(TextGlyphCache, EightAndNineDotRowsAreDistinct)
+{
+	TextGlyphCache cache = {};
+	cache.SetColours(make_colours(0));
+
+	// The same bits are a different row in each width
+	const auto eight = cache.GetRow(0x81, 8, 15, 1);
+	EXPECT_EQ(eight[0], make_colours(0)[15]);
+	const auto nine = cache.GetRow(0x81, 9, 15, 1);
+	EXPECT_EQ(nine[0], make_colours(0)[1]);
+	EXPECT_EQ(nine[1], make_colours(0)[15]);
+	EXPECT_EQ(cache.misses, 2);
+}
+
+TEST(TextGlyphCache, ColourChangeFlushes)
+{
+	TextGlyphCache cache = {};
+	cache.SetColours(make_colours(0));
+	cache.GetRow(0xf0, 8, 7, 0);
+	EXPECT_EQ(cache.GetRow(0xf0, 8, 7, 0)[0], make_colours(0)[7]);
+
+	// Setting the same colours keeps the rows
+	const auto flushes = cache.flushes;
+	cache.SetColours(make_colours(0));
+	EXPECT_EQ(cache.flushes, flushes);
+
+	auto faded = make_colours(0);
+	faded[7]   = 0x123456;
+	cache.SetColours(faded);
+	EXPECT_EQ(cache.flushes, flushes + 1);
+	EXPECT_EQ(cache.GetRow(0xf0, 8, 7, 0)[0], 0x123456u);
+	EXPECT_EQ(cache.GetRow(0xf0, 8, 7, 0)[7], faded[0]);
+}
+
+TEST(TextGlyphCache, BenchmarkScreen)
+{
+	// An 80x25 screen of 9-dot, 16-line cells with a handful of attributes,
+	// as business applications and BBS software typically show
+	constexpr int columns      = 80;
+	constexpr int rows         = 25;
+	constexpr int cell_lines   = 16;
+	constexpr uint8_t width    = 9;
+	constexpr int num_frames   = 500;
+
+	// The printable characters of the 8x16 VGA font use under 50 distinct
+	// rows, and about half of their rows are blank
+	std::mt19937 rng(1);
+	std::vector<uint16_t> font_rows(48);
+	for (auto& row : font_rows) {
+		row = static_cast<uint16_t>(rng() & 0x1fe);
+	}
+	std::vector<uint16_t> font(256 * cell_lines);
+	for (auto& row : font) {
+		row = (rng() % 2) ? font_rows[rng() % font_rows.size()] : 0;
+	}
+	const uint8_t attributes[] = {0x07, 0x1f, 0x70, 0x4e, 0x0f};
+	std::vector<uint8_t> chars(columns * rows);
+	std::vector<uint8_t> attrs(columns * rows);
+	for (size_t i = 0; i < chars.size(); ++i) {
+		chars[i] = static_cast<uint8_t>(32 + rng() % 96);
+		attrs[i] = attributes[(i / 23) % std::size(attributes)];
+	}
+
+	const auto colours = make_colours(0);
+	TextGlyphCache cache = {};
+	std::vector<uint32_t> line(columns * width);
+
+	// Reading a pixel back after each line keeps the drawing from being
+	// optimised away
+	volatile uint32_t sink = 0;
+
+	auto run = [&](const auto& draw) {
+		const auto start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < num_frames; ++frame) {
+			cache.SetColours(colours);
+			for (int y = 0; y < rows * cell_lines; ++y) {
+				const auto cells = (y / cell_lines) * columns;
+				for (int x = 0; x < columns; ++x) {
+					const auto chr  = chars[cells + x];
+					const auto attr = attrs[cells + x];
+					const auto pattern = font[chr * cell_lines +
+					                          y % cell_lines];
+					draw(&line[x * width],
+					     pattern,
+					     static_cast<uint8_t>(attr & 0xf),
+					     static_cast<uint8_t>(attr >> 4));
+				}
+				sink = line[static_cast<size_t>(y) % line.size()];
+			}
+		}
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		return std::chrono::duration<double>(elapsed).count();
+	};
+
+	const auto by_pixel = run([&](uint32_t* pixels, const uint16_t pattern,
+	                              const uint8_t fg, const uint8_t bg) {
+		draw_cell(pixels, pattern, width, colours[fg], colours[bg]);
+	});
+	const auto expected = line;
+
+	const auto by_row = run([&](uint32_t* pixels, const uint16_t pattern,
+	                            const uint8_t fg, const uint8_t bg) {
+		memcpy(pixels,
+		       cache.GetRow(pattern, width, fg, bg),
+		       width * sizeof(uint32_t));
+	});
+	EXPECT_EQ(line, expected);
+
+	const auto hit_ratio = static_cast<double>(cache.hits) /
+	                       static_cast<double>(cache.hits + cache.misses);
+	printf("[ BENCHMARK] 80x25 9-dot text frame: per pixel %.1f us, cached rows %.1f us (%.2f%% hits)\n",
+	       by_pixel * 1e6 / num_frames,
+	       by_row * 1e6 / num_frames,
+	       hit_ratio * 100);
+}
+
+} // namespace
@@ -0,0 +1,197 @@
+/*
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ *  Copyright (C) 2024-2024  The DOSBox Staging Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "thread_handoff.h"
+
+#include <array>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// A frame whose pixels all hold its number, so a torn frame shows
+using Frame = std::array<int, 1024>;
+
+void fill(Frame& frame, const int number)
+{
+	frame.fill(number);
+}
+
+bool is_whole(const Frame& frame)
+{
+	for (const auto pixel : frame) {
+		if (pixel != frame[0]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST(TripleBuffer, NothingToAcquireAtFirst)
+{
+	TripleBuffer<Frame> frames = {};
+	EXPECT_FALSE(frames.Acquire());
+}
+
+TEST(TripleBuffer, AcquiresEachPublishedFrameOnce)
+{
+	TripleBuffer<Frame> frames = {};
+
+	fill(frames.Back(), 1);
+	frames.Publish();
+	ASSERT_TRUE(frames.Acquire());
+	EXPECT_EQ(frames.Front()[0], 1);
+	EXPECT_FALSE(frames.Acquire());
+	EXPECT_EQ(frames.Front()[0], 1);
+
+	fill(frames.Back(), 2);
+	frames.Publish();
+	ASSERT_TRUE(frames.Acquire());
+	EXPECT_EQ(frames.Front()[0], 2);
+}
+
+TEST(TripleBuffer, AcquiresTheLatestFrame)
+{
+	TripleBuffer<Frame> frames = {};
+	for (int number = 1; number <= 5; ++number) {
+		fill(frames.Back(), number);
+		frames.Publish();
+	}
+	ASSERT_TRUE(frames.Acquire());
+	EXPECT_EQ(frames.Front()[0], 5);
+	EXPECT_FALSE(frames.Acquire());
+}
+
+TEST(TripleBuffer, ProducerNeverDrawsIntoTheFrontFrame)
+{
+	TripleBuffer<Frame> frames = {};
+	fill(frames.Back(), 1);
+	frames.Publish();
+	ASSERT_TRUE(frames.Acquire());
+
+	for (int number = 2; number <= 5; ++number) {
+		EXPECT_NE(&frames.Back(), &frames.Front());
+		fill(frames.Back(), number);
+		frames.Publish();
+	}
+	EXPECT_EQ(frames.Front()[0], 1);
+}
+
+TEST(TripleBuffer, ConsumerSeesWholeFramesInOrder)
+{
+	constexpr int num_frames   = 20000;
+	TripleBuffer<Frame> frames = {};
+
+	std::thread producer([&] {
+		for (int number = 1; number <= num_frames; ++number) {
+			fill(frames.Back(), number);
+			frames.Publish();
+		}
+	});
+
+	int last_number = 0;
+	int torn_frames = 0;
+	int backwards   = 0;
+	while (last_number < num_frames) {
+		if (!frames.Acquire()) {
+			std::this_thread::yield();
+			continue;
+		}
+		const auto& frame = frames.Front();
+		torn_frames += !is_whole(frame);
+		backwards += frame[0] <= last_number;
+		last_number = frame[0];
+	}
+	producer.join();
+
+	EXPECT_EQ(torn_frames, 0);
+	EXPECT_EQ(backwards, 0);
+}
+
+TEST(SpscQueue, PopsInOrder)
+{
+	SpscQueue<int, 4> queue = {};
+	int item                = 0;
+	EXPECT_FALSE(queue.Pop(item));
+
+	EXPECT_TRUE(queue.Push(1));
+	EXPECT_TRUE(queue.Push(2));
+	ASSERT_TRUE(queue.Pop(item));
+	EXPECT_EQ(item, 1);
+	ASSERT_TRUE(queue.Pop(item));
+	EXPECT_EQ(item, 2);
+	EXPECT_FALSE(queue.Pop(item));
+}
+
+TEST(SpscQueue, RefusesItemsWhenFull)
+{
+	SpscQueue<int, 4> queue = {};
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_FALSE(queue.IsFull());
+		EXPECT_TRUE(queue.Push(i));
+	}
+	EXPECT_TRUE(queue.IsFull());
+	EXPECT_FALSE(queue.Push(4));
+
+	// Taking an item makes room again, also across the wrap
+	int item = 0;
+	ASSERT_TRUE(queue.Pop(item));
+	EXPECT_EQ(item, 0);
+	EXPECT_TRUE(queue.Push(4));
+	for (int i = 1; i <= 4; ++i) {
+		ASSERT_TRUE(queue.Pop(item));
+		EXPECT_EQ(item, i);
+	}
+	EXPECT_FALSE(queue.Pop(item));
+}
+
+TEST(SpscQueue, PassesEveryItemAcrossThreads)
+{
+	constexpr int num_items    = 200000;
+	SpscQueue<int, 64> queue = {};
+
+	std::thread producer([&] {
+		for (int i = 0; i < num_items;) {
+			if (queue.Push(i)) {
+				++i;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	int expected   = 0;
+	int out_of_order = 0;
+	while (expected < num_items) {
+		int item = 0;
+		if (!queue.Pop(item)) {
+			std::this_thread::yield();
+			continue;
+		}
+		out_of_order += item != expected;
+		expected = item + 1;
+	}
+	producer.join();
+
+	EXPECT_EQ(out_of_order, 0);
+}
+
+} // namespace